@@ -0,0 +1,454 @@
+// Timing of the backend kernels over a grid of sizes and densities
+//
+//   bench_backend [--sizes 256,1024,2048] [--densities 0.05,0.5] [--repeat 5]
+//                 [--kernels union,ring] [--threads N] [--json file|-]
+//   bench_backend --baseline bench/baseline.json [--tolerance 0.3]
+//
+// Every case builds its inputs with fixed seeds, runs the kernel --repeat times and keeps the
+// fastest run; inputs are rebuilt outside the timed region for kernels that edit them in place.
+// With --baseline the cases, repeat count and threads come from a stored --json result, and the
+// exit code is 1 when any case got slower than its tolerance band.
+
+#include "backend/matrix_gen.h"
+#include "backend/parallel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    struct Options {
+        std::vector<int> sizes{256, 1024, 2048};
+        std::vector<double> densities{0.05, 0.5};
+        std::vector<std::string> kernels;
+        int repeat = 5;
+        int threads = 0;
+        std::string json;
+        std::string baseline;
+        double tolerance = 0.3;
+    };
+
+    struct Result {
+        std::string kernel;
+        int n = 0;
+        double density = 0;
+        long long cells = 0;
+        double best_ns = 0;
+        double median_ns = 0;
+        long long peak_kb = 0;
+        // Allowed slowdown against a baseline, 0 means the --tolerance value
+        double tolerance = 0;
+
+        double ns_per_cell() const { return best_ns / static_cast<double>(cells); }
+        double mcells_per_s() const { return static_cast<double>(cells) * 1e3 / best_ns; }
+    };
+
+    /**
+     * One kernel; prepare builds the inputs, run is timed
+     * Result vertex count of a case is n, so ns per cell compares across kernels
+     */
+    struct Kernel {
+        std::string name;
+        std::function<void(int n, double density)> prepare;
+        std::function<void()> run;
+        std::function<void()> release;
+    };
+
+    // Peak resident set of the process; Linux lets it be reset between cases
+    void reset_peak_memory() {
+#ifdef __linux__
+        if (std::ofstream refs("/proc/self/clear_refs"); refs) refs << "5";
+#endif
+    }
+
+    long long peak_memory_kb() {
+#ifdef __linux__
+        std::ifstream status("/proc/self/status");
+        std::string line;
+        while (std::getline(status, line)) {
+            if (line.rfind("VmHWM:", 0) == 0) return std::atoll(line.c_str() + 6);
+        }
+#endif
+#ifdef _WIN32
+        PROCESS_MEMORY_COUNTERS counters{};
+        GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+        return static_cast<long long>(counters.PeakWorkingSetSize >> 10);
+#else
+        rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+        return usage.ru_maxrss >> 10;
+#else
+        return usage.ru_maxrss;
+#endif
+#endif
+    }
+
+    template <typename T>
+    std::vector<T> parse_list(const std::string& text) {
+        std::vector<T> values;
+        std::stringstream stream(text);
+        std::string item;
+        while (std::getline(stream, item, ',')) {
+            if (item.empty()) continue;
+            if constexpr (std::is_same_v<T, std::string>) values.push_back(item);
+            else if constexpr (std::is_same_v<T, int>) values.push_back(std::stoi(item));
+            else values.push_back(std::stod(item));
+        }
+        return values;
+    }
+
+    void free_graph(Graph& graph) {
+        if (graph.adj_matrix != nullptr) delete_graph(graph, graph.n);
+    }
+
+    std::vector<Kernel> make_kernels() {
+        // Shared by the kernels, only one case is alive at a time
+        static Graph a;
+        static Graph b;
+        static Graph result;
+        static Graph scratch;
+
+        const auto release = [] {
+            free_graph(a);
+            free_graph(b);
+            free_graph(result);
+            free_graph(scratch);
+        };
+        const auto pair = [](const int n, const double density) {
+            a = create_graph(n, density, density / 2, 1);
+            b = create_graph(n, density, density / 2, 2);
+        };
+        const auto binary = [&](const std::string& name, Graph (*operation)(const Graph&, const Graph&)) {
+            return Kernel{name, pair, [operation] {
+                free_graph(result);
+                result = operation(a, b);
+            }, release};
+        };
+
+        std::vector<Kernel> kernels;
+        kernels.push_back({"create", [](int, double) {}, [] {}, release});
+        kernels.push_back(binary("union", graph_union));
+        kernels.push_back(binary("intersection", graph_intersection));
+        kernels.push_back(binary("ring_sum", ring_sum));
+
+        // Factors of about sqrt(n) vertices give a product of about n vertices
+        kernels.push_back({"product", [](const int n, const double density) {
+            const int factor = std::max(2, static_cast<int>(std::lround(std::sqrt(n))));
+            a = create_graph(factor, density, density / 2, 1);
+            b = create_graph(factor, density, density / 2, 2);
+        }, [] {
+            free_graph(result);
+            result = graph_cartesian_product(a, b);
+        }, release});
+
+        // In-place edits work on a fresh copy each run, made by prepare outside the timed region
+        const auto fresh_copy = [](const int n, const double density) {
+            if (a.n != n) {
+                free_graph(a);
+                a = create_graph(n, density, density / 2, 1);
+            }
+            free_graph(scratch);
+            scratch = copy_graph(a);
+        };
+        kernels.push_back({"identify", fresh_copy, [] {
+            identify_vertices(scratch, 0, scratch.n - 1);
+        }, release});
+        kernels.push_back({"split", fresh_copy, [] {
+            split_vertex(scratch, 0, get_neighbors(scratch, 0));
+        }, release});
+        return kernels;
+    }
+
+    Result measure(Kernel& kernel, const int n, const double density, const int repeat) {
+        Result result;
+        result.kernel = kernel.name;
+        result.n = n;
+        result.density = density;
+
+        // create_graph is timed directly, its product is the graph itself
+        const bool generator = kernel.name == "create";
+        const bool edits = kernel.name == "identify" || kernel.name == "split";
+
+        reset_peak_memory();
+        std::vector<double> samples;
+        samples.reserve(repeat);
+        int vertices = n;
+        if (!edits) kernel.prepare(n, density);
+        for (int r = 0; r < repeat; r++) {
+            if (edits) kernel.prepare(n, density);
+            const auto start = Clock::now();
+            if (generator) {
+                Graph graph = create_graph(n, density, density / 2, static_cast<unsigned>(r + 1));
+                samples.push_back(std::chrono::duration<double, std::nano>(Clock::now() - start).count());
+                delete_graph(graph, graph.n);
+                continue;
+            }
+            kernel.run();
+            samples.push_back(std::chrono::duration<double, std::nano>(Clock::now() - start).count());
+        }
+        if (kernel.name == "product") {
+            // Factor rounding makes the product only roughly n vertices, cells use the real size
+            const int factor = std::max(2, static_cast<int>(std::lround(std::sqrt(n))));
+            vertices = factor * factor;
+        }
+        result.peak_kb = peak_memory_kb();
+        kernel.release();
+
+        std::sort(samples.begin(), samples.end());
+        result.cells = static_cast<long long>(vertices) * vertices;
+        result.best_ns = samples.front();
+        result.median_ns = samples[samples.size() / 2];
+        return result;
+    }
+
+    void print_table(const std::vector<Result>& results) {
+        std::cout << std::left << std::setw(14) << "kernel" << std::right << std::setw(7) << "n"
+                  << std::setw(9) << "density" << std::setw(13) << "best ms" << std::setw(13) << "median ms"
+                  << std::setw(11) << "ns/cell" << std::setw(12) << "Mcells/s" << std::setw(12) << "peak MB" << '\n';
+        for (const auto& r : results) {
+            std::cout << std::left << std::setw(14) << r.kernel << std::right << std::setw(7) << r.n
+                      << std::setw(9) << std::setprecision(3) << r.density
+                      << std::fixed << std::setprecision(3)
+                      << std::setw(13) << r.best_ns / 1e6 << std::setw(13) << r.median_ns / 1e6
+                      << std::setw(11) << r.ns_per_cell() << std::setprecision(1)
+                      << std::setw(12) << r.mcells_per_s() << std::setw(12) << static_cast<double>(r.peak_kb) / 1024
+                      << std::defaultfloat << '\n';
+        }
+    }
+
+    void write_json(std::ostream& out, const std::vector<Result>& results, const Options& options) {
+        out << "{\n  \"threads\": " << hardware_threads() << ",\n  \"repeat\": " << options.repeat
+            << ",\n  \"results\": [\n";
+        for (size_t i = 0; i < results.size(); i++) {
+            const auto& r = results[i];
+            out << "    {\"kernel\": \"" << r.kernel << "\", \"n\": " << r.n << ", \"density\": " << r.density
+                << ", \"cells\": " << r.cells << ", \"best_ns\": " << std::llround(r.best_ns)
+                << ", \"median_ns\": " << std::llround(r.median_ns) << ", \"ns_per_cell\": " << r.ns_per_cell()
+                << ", \"mcells_per_s\": " << r.mcells_per_s() << ", \"peak_kb\": " << r.peak_kb << "}"
+                << (i + 1 < results.size() ? "," : "") << '\n';
+        }
+        out << "  ]\n}\n";
+    }
+
+    // Value of "key" inside a flat JSON object written by write_json, quotes stripped
+    std::string json_field(const std::string& object, const std::string& key) {
+        const size_t at = object.find("\"" + key + "\":");
+        if (at == std::string::npos) return {};
+        size_t begin = object.find_first_not_of(" \"", at + key.size() + 3);
+        const size_t end = object.find_first_of(",}\"", begin);
+        if (begin == std::string::npos || end == std::string::npos) return {};
+        return object.substr(begin, end - begin);
+    }
+
+    /**
+     * Reads a --json result back; only the format written by write_json is understood
+     * @param path Baseline file
+     * @param options Receives the repeat count and thread count of the baseline run
+     * @param cases Receives one entry per case, best_ns is the reference time
+     * @return false when the file is missing or has no cases
+     */
+    bool read_baseline(const std::string& path, Options& options, std::vector<Result>& cases) {
+        std::ifstream file(path);
+        if (!file.is_open()) return false;
+        std::ostringstream contents;
+        contents << file.rdbuf();
+        const std::string text = contents.str();
+
+        const size_t list = text.find("\"results\"");
+        if (list == std::string::npos) return false;
+        const std::string head = text.substr(0, list) + "}";
+        if (const auto repeat = json_field(head, "repeat"); !repeat.empty()) options.repeat = std::stoi(repeat);
+        if (const auto threads = json_field(head, "threads"); !threads.empty()) options.threads = std::stoi(threads);
+
+        for (size_t begin = text.find('{', list); begin != std::string::npos; begin = text.find('{', begin + 1)) {
+            const size_t end = text.find('}', begin);
+            if (end == std::string::npos) break;
+            const std::string object = text.substr(begin, end - begin + 1);
+            Result entry;
+            entry.kernel = json_field(object, "kernel");
+            entry.n = std::stoi(json_field(object, "n"));
+            entry.density = std::stod(json_field(object, "density"));
+            entry.best_ns = std::stod(json_field(object, "best_ns"));
+            if (const auto tolerance = json_field(object, "tolerance"); !tolerance.empty()) {
+                entry.tolerance = std::stod(tolerance);
+            }
+            cases.push_back(entry);
+        }
+        return !cases.empty();
+    }
+
+    // Timer and scheduler noise on sub-millisecond cases is not a regression
+    constexpr double NOISE_FLOOR_NS = 50'000;
+    // Extra measurements of a case that came out slower than its band
+    constexpr int CONFIRM_RUNS = 2;
+
+    double band_of(const Result& base, const double tolerance) {
+        return base.tolerance > 0 ? base.tolerance : tolerance;
+    }
+
+    bool slower_than_band(const Result& base, const Result& now, const double tolerance) {
+        return now.best_ns > base.best_ns * (1 + band_of(base, tolerance)) + NOISE_FLOOR_NS;
+    }
+
+    /**
+     * Prints current against baseline per case
+     * @return Number of cases slower than baseline * (1 + tolerance) plus the noise floor
+     */
+    int compare_with_baseline(std::ostream& out, const std::vector<Result>& baseline,
+                              const std::vector<Result>& results, const double tolerance) {
+        int regressions = 0;
+        out << std::left << std::setw(14) << "kernel" << std::right << std::setw(7) << "n"
+                  << std::setw(9) << "density" << std::setw(13) << "baseline ms" << std::setw(13) << "current ms"
+                  << std::setw(10) << "change" << std::setw(9) << "band" << "  status\n";
+        for (size_t i = 0; i < baseline.size(); i++) {
+            const auto& base = baseline[i];
+            const auto& now = results[i];
+            const double band = band_of(base, tolerance);
+            const double change = (now.best_ns - base.best_ns) / base.best_ns;
+            const bool slower = slower_than_band(base, now, tolerance);
+            if (slower) regressions++;
+
+            out << std::left << std::setw(14) << base.kernel << std::right << std::setw(7) << base.n
+                      << std::setw(9) << std::setprecision(3) << base.density
+                      << std::fixed << std::setprecision(3)
+                      << std::setw(13) << base.best_ns / 1e6 << std::setw(13) << now.best_ns / 1e6
+                      << std::showpos << std::setprecision(1) << std::setw(9) << change * 100 << '%'
+                      << std::noshowpos << std::setw(8) << band * 100 << '%'
+                      << (slower ? "  REGRESSION" : change < -band ? "  faster" : "  ok")
+                      << std::defaultfloat << '\n';
+        }
+        return regressions;
+    }
+
+    void print_usage(const char* program) {
+        std::cerr << "Usage: " << program << " [--sizes 256,1024,2048] [--densities 0.05,0.5] [--repeat 5]\n"
+                  << "       [--kernels create,union,intersection,ring_sum,product,identify,split]\n"
+                  << "       [--threads N] [--json file|-]\n"
+                  << "       " << program << " --baseline file.json [--tolerance 0.3] [--json file|-]\n";
+    }
+}
+
+int main(const int argc, char* argv[]) {
+    Options options;
+    try {
+        for (int i = 1; i < argc; i++) {
+            const std::string arg = argv[i];
+            const bool has_value = i + 1 < argc;
+            if (arg == "--sizes" && has_value) options.sizes = parse_list<int>(argv[++i]);
+            else if (arg == "--densities" && has_value) options.densities = parse_list<double>(argv[++i]);
+            else if (arg == "--kernels" && has_value) options.kernels = parse_list<std::string>(argv[++i]);
+            else if (arg == "--repeat" && has_value) options.repeat = std::max(1, std::stoi(argv[++i]));
+            else if (arg == "--threads" && has_value) options.threads = std::stoi(argv[++i]);
+            else if (arg == "--json" && has_value) options.json = argv[++i];
+            else if (arg == "--baseline" && has_value) options.baseline = argv[++i];
+            else if (arg == "--tolerance" && has_value) options.tolerance = std::stod(argv[++i]);
+            else {
+                print_usage(argv[0]);
+                return 2;
+            }
+        }
+    } catch (const std::exception&) {
+        print_usage(argv[0]);
+        return 2;
+    }
+
+    std::vector<Result> baseline;
+    if (!options.baseline.empty()) {
+        try {
+            if (!read_baseline(options.baseline, options, baseline)) {
+                std::cerr << "Error: no benchmark results in " << options.baseline << std::endl;
+                return EXIT_FAILURE;
+            }
+        } catch (const std::exception&) {
+            std::cerr << "Error: malformed baseline " << options.baseline << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    set_thread_count(options.threads);
+    auto kernels = make_kernels();
+    const auto find_kernel = [&](const std::string& name) -> Kernel* {
+        for (auto& kernel : kernels) {
+            if (kernel.name == name) return &kernel;
+        }
+        return nullptr;
+    };
+
+    std::vector<Result> results;
+    if (!baseline.empty()) {
+        for (const auto& entry : baseline) {
+            Kernel* kernel = find_kernel(entry.kernel);
+            if (kernel == nullptr) {
+                std::cerr << "Error: unknown kernel " << entry.kernel << " in " << options.baseline << std::endl;
+                return EXIT_FAILURE;
+            }
+            // A slow case is measured again before it counts, one busy moment is not a regression
+            Result result = measure(*kernel, entry.n, entry.density, options.repeat);
+            for (int retry = 0; retry < CONFIRM_RUNS && slower_than_band(entry, result, options.tolerance); retry++) {
+                if (Result again = measure(*kernel, entry.n, entry.density, options.repeat); again.best_ns < result.best_ns) {
+                    result = again;
+                }
+            }
+            results.push_back(result);
+        }
+    } else {
+        for (auto& kernel : kernels) {
+            if (!options.kernels.empty()
+                && std::find(options.kernels.begin(), options.kernels.end(), kernel.name) == options.kernels.end()) {
+                continue;
+            }
+            for (const int n : options.sizes) {
+                for (const double density : options.densities) {
+                    results.push_back(measure(kernel, n, density, options.repeat));
+                }
+            }
+        }
+    }
+
+    // With --json - the table is left out so stdout stays parseable
+    int regressions = 0;
+    if (options.json != "-") {
+        std::cout << "Backend kernels, " << hardware_threads() << " threads, best of " << options.repeat << '\n';
+        if (baseline.empty()) {
+            print_table(results);
+        } else {
+            regressions = compare_with_baseline(std::cout, baseline, results, options.tolerance);
+            std::cout << regressions << " of " << baseline.size() << " cases slower than their band" << '\n';
+        }
+    } else if (!baseline.empty()) {
+        // stdout carries the JSON, the report goes to stderr
+        regressions = compare_with_baseline(std::cerr, baseline, results, options.tolerance);
+    }
+    if (options.json == "-") {
+        write_json(std::cout, results, options);
+    } else if (!options.json.empty()) {
+        std::ofstream file(options.json);
+        if (!file.is_open()) {
+            std::cerr << "Error: cannot write " << options.json << std::endl;
+            return EXIT_FAILURE;
+        }
+        write_json(file, results, options);
+    }
+    return regressions == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -50,6 +50,14 @@ if(CMAKE_BUILD_TYPE STREQUAL "Release")
     endif()
 endif()
 
+if(ENABLE_NATIVE_ARCH)
+    if(CMAKE_CXX_COMPILER_ID MATCHES "GNU|Clang")
+        list(APPEND PROJECT_COMPILE_OPTIONS -march=native)
+    elseif(CMAKE_CXX_COMPILER_ID STREQUAL "MSVC")
+        list(APPEND PROJECT_COMPILE_OPTIONS /arch:AVX2)
+    endif()
+endif()
+
 if(CMAKE_CXX_COMPILER_ID MATCHES "Clang" AND NOT WIN32 AND CMAKE_BUILD_TYPE STREQUAL "Debug")
     message(STATUS "Enabling sanitizers for Clang")
     list(APPEND PROJECT_COMPILE_OPTIONS
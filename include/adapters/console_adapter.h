@@ -5,10 +5,17 @@
 #ifndef CONSOLE_ADAPTER_H
 #define CONSOLE_ADAPTER_H
 
+#include <atomic>
+#include <functional>
 #include <memory>
 
+#include "../core/access_locks.h"
 #include "../core/console.h"
+#include "../core/script_scheduler.h"
+#include "backend/jobs.h"
 #include "backend/matrix_gen.h"
+#include "backend/result_cache.h"
+#include "backend/workspace.h"
 
 class GraphConsoleAdapter {
     public:
@@ -17,22 +24,82 @@ class GraphConsoleAdapter {
 
     void run();
 
+    /**
+     * Run commands non-interactively (script file or piped stdin)
+     * @param in Command lines
+     * @param stop_on_error Stop at the first failing line
+     * @param parallel Run lines on different graphs at the same time, output keeps the script order
+     * @return Process exit status, nonzero if any command failed
+     */
+    int run_script(std::istream& in, bool stop_on_error = false, bool parallel = false);
+
+    /**
+     * Serve commands to clients over a Unix-domain socket until SIGINT/SIGTERM
+     * @param socket_path Socket file to create
+     * @return Process exit status
+     */
+    int serve(const std::string& socket_path);
+
     private:
     Console console;
 
-    bool graphs_created;
-    std::unique_ptr<Graph> graph1;
-    std::unique_ptr<Graph> graph2;
-    std::unique_ptr<Graph> graph;
-    int n;
+    Workspace workspace;
+    ResultCache results;
+    bool lazy_mode;
+    // Limit for slots, cache-only results and running jobs together, 0 = none
+    std::atomic<std::size_t> memory_budget{0};
+    // Processes for dense union, ring and product (run_in_processes), 0 = threads only
+    std::atomic<int> worker_processes{0};
+    // Predicted footprint of background jobs that have not finished yet
+    std::atomic<std::size_t> reserved_bytes{0};
+    // Slot locks of server requests running at the same time
+    AccessLocks slot_locks;
+    // Declared last so running jobs are cancelled and joined first
+    JobTable jobs;
 
     void cleanup();
+    // Output of the current command, buffered per line when a script runs in parallel
+    static std::ostream& out();
+    // Marks the current command as failed, the message goes to the returned stream
+    std::ostream& fail();
+    // Graphs a command line reads and writes, for scheduling script lines in parallel
+    CommandAccess command_access(const std::vector<std::string>& tokens) const;
+    bool serve_request(const std::string& line, std::string& output);
+    Graph* require_graph(const std::string& name);
+    static std::string split_destination(std::vector<std::string>& args, const std::string& fallback);
+    static bool split_background(std::vector<std::string>& args);
+    // Slot an attached graph goes to without "-> name": the object name without its '/'
+    static std::string default_attach_slot(const std::string& name);
+    void start_job(const std::string& command, std::function<SharedGraph()> work,
+                   std::function<void(const SharedGraph&)> commit, std::size_t reserve = 0);
+    // Budget in bytes for memory_budget_mb: 0 picks three quarters of physical memory, negative means none
+    static std::size_t budget_from_megabytes(int megabytes);
+    // Bytes counted against the budget: slots, results only the cache holds, reservations of jobs
+    std::size_t memory_in_use() const;
+    // Bytes an operation may still allocate, SIZE_MAX without a budget
+    std::size_t memory_headroom() const;
+    // Counts below 2 and platforms without fork turn worker processes off
+    void set_worker_processes(int processes);
+    // Free bytes in the spill directory, 0 if out-of-core results are off or it cannot be read
+    std::size_t spill_space() const;
+    /**
+     * Check an allocation against the memory budget
+     * @param bytes Predicted footprint
+     * @param released Bytes the operation frees before allocating, e.g. create dropping the old graphs
+     */
+    bool fits_budget(std::size_t bytes, std::size_t released = 0) const;
+    std::string over_budget(std::size_t bytes) const;
+    void report_finished_jobs();
+    // Plans the operation (strategy, memory) and runs it, in the background or kept lazy as asked
+    void run_binary(std::vector<std::string> args, GraphOp op);
+    // Binary command name (union, intersect, ring, product) to its operation
+    static bool parse_operation(const std::string& name, GraphOp& op);
     void register_graph_commands();
     std::string find_config_file(const std::string& filename, const std::vector<std::string>& search_paths);
     std::string get_default_config_path();
 
     void cmd_create(const std::vector<std::string>& args);
-    void cmd_print() const;
+    void cmd_print(const std::vector<std::string>& args);
     void cmd_clear();
     void cmd_cleanup();
     void cmd_exit();
@@ -40,13 +107,40 @@ class GraphConsoleAdapter {
     // void cmd_save(const std::vector<std::string>& args);
     // void cmd_load(const std::vector<std::string>& args);
     void cmd_history();
-    void cmd_identify(const std::vector<std::string>& args) const;
-    void cmd_contract(const std::vector<std::string>& args) const;
-    void cmd_split(const std::vector<std::string>& args) const;
-    void cmd_union();
-    void cmd_intersection();
-    void cmd_ring();
-    void cmd_cartesian();
+    void cmd_graphs();
+    void cmd_drop(const std::vector<std::string>& args);
+    void cmd_copy(const std::vector<std::string>& args);
+    void cmd_identify(const std::vector<std::string>& args);
+    void cmd_contract(const std::vector<std::string>& args);
+    void cmd_split(const std::vector<std::string>& args);
+    void cmd_union(const std::vector<std::string>& args);
+    void cmd_intersection(const std::vector<std::string>& args);
+    void cmd_ring(const std::vector<std::string>& args);
+    void cmd_cartesian(const std::vector<std::string>& args);
+    void cmd_bfs(const std::vector<std::string>& args);
+    void cmd_components(const std::vector<std::string>& args);
+    void cmd_distance(const std::vector<std::string>& args);
+    void cmd_reorder(const std::vector<std::string>& args);
+    void cmd_triangles(const std::vector<std::string>& args);
+    void cmd_closure(const std::vector<std::string>& args);
+    void cmd_apsp(const std::vector<std::string>& args);
+    void cmd_spectrum(const std::vector<std::string>& args);
+    void cmd_pagerank(const std::vector<std::string>& args);
+    void cmd_hash(const std::vector<std::string>& args);
+    void cmd_publish(const std::vector<std::string>& args);
+    void cmd_attach(const std::vector<std::string>& args);
+    void cmd_unpublish(const std::vector<std::string>& args);
+    void cmd_cache(const std::vector<std::string>& args);
+    void cmd_mem(const std::vector<std::string>& args);
+    void cmd_explain(const std::vector<std::string>& args);
+    void cmd_processes(const std::vector<std::string>& args);
+    void cmd_neighbors(const std::vector<std::string>& args);
+    void cmd_lazy(const std::vector<std::string>& args);
+    void cmd_profile(const std::vector<std::string>& args);
+    void cmd_trace(const std::vector<std::string>& args);
+    void cmd_jobs();
+    void cmd_wait(const std::vector<std::string>& args);
+    void cmd_cancel(const std::vector<std::string>& args);
 };
 
 #endif //CONSOLE_ADAPTER_H
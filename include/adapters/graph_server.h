@@ -0,0 +1,46 @@
+#ifndef GRAPH_SERVER_H
+#define GRAPH_SERVER_H
+
+#include <functional>
+#include <istream>
+#include <string>
+
+/**
+ * Protocol over a Unix-domain stream socket, one connection can carry any number of requests:
+ *   request:  one command line ending with '\n'
+ *   response: "ok <bytes>\n" or "error <bytes>\n", then exactly <bytes> bytes of command output
+ * "exit" or "quit" closes the connection, the server keeps running until SIGINT or SIGTERM
+ */
+class GraphServer {
+public:
+    // Runs one command line, fills output and returns true if the command failed
+    using Handler = std::function<bool(const std::string& line, std::string& output)>;
+
+    /**
+     * @param socket_path Filesystem path of the socket, created on start and removed on stop
+     * @param handler Called from pool threads at the same time, must do its own locking
+     * @param threads Connections served at the same time, later ones wait for a free thread
+     */
+    GraphServer(std::string socket_path, Handler handler, int threads);
+
+    // Serve until SIGINT/SIGTERM; returns process exit status
+    int run();
+
+private:
+    std::string socket_path;
+    Handler handler;
+    int threads;
+
+    void serve_client(int client) const;
+};
+
+/**
+ * Send command lines to a running server and print the responses
+ * @param socket_path Socket of the server
+ * @param in Command lines, '#' comments and empty lines are skipped
+ * @param stop_on_error Stop after the first failed response
+ * @return Process exit status, nonzero if any command failed
+ */
+extern int run_client(const std::string& socket_path, std::istream& in, bool stop_on_error = false);
+
+#endif //GRAPH_SERVER_H
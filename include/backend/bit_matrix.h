@@ -0,0 +1,50 @@
+#ifndef BIT_MATRIX_H
+#define BIT_MATRIX_H
+
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+#include "matrix_gen.h"
+
+// Adjacency matrix packed into 64-bit words, one contiguous run of words per row
+struct BitMatrix {
+    int n = 0;
+    int words = 0;
+    std::vector<std::uint64_t> bits;
+
+    std::uint64_t* row(const int i) { return bits.data() + static_cast<size_t>(i) * words; }
+    const std::uint64_t* row(const int i) const { return bits.data() + static_cast<size_t>(i) * words; }
+
+    bool test(const int i, const int j) const { return (row(i)[j >> 6] >> (j & 63)) & 1u; }
+    void set(const int i, const int j) { row(i)[j >> 6] |= std::uint64_t{1} << (j & 63); }
+};
+
+// Number of 64-bit words needed for n bits
+inline int bit_words(const int n) { return (n + 63) / 64; }
+
+// popcount(a & b) over a row, written as a flat loop so the compiler can vectorize it
+inline long long and_popcount(const std::uint64_t* a, const std::uint64_t* b, const int words) {
+    long long total = 0;
+    for (int k = 0; k < words; k++) {
+        total += std::popcount(a[k] & b[k]);
+    }
+    return total;
+}
+
+// Allocate an all-zero n x n bit matrix
+extern BitMatrix make_bit_matrix(int n);
+
+// Pack graph.adj_matrix into a bit matrix (rows are packed in parallel)
+extern BitMatrix pack_matrix(const Graph &graph);
+
+// Build a graph (matrix and sorted adjacency list) from a bit matrix
+extern Graph unpack_matrix(const BitMatrix &m);
+
+// Number of edges stored in the adjacency list (each undirected edge counted from both ends)
+extern long long count_list_entries(const Graph &graph);
+
+// True when the graph is dense enough for the bitset kernels to beat list traversal
+extern bool is_dense(const Graph &graph);
+
+#endif //BIT_MATRIX_H
@@ -0,0 +1,68 @@
+#ifndef DISK_GRAPH_H
+#define DISK_GRAPH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+
+#include "matrix_gen.h"
+
+/**
+ * Graph kept in a file as sorted adjacency lists (CSR) and read through a read-only mapping,
+ * for results bigger than RAM; there is no matrix, pages are loaded by the kernel on access
+ * File: a header, n + 1 uint64 list offsets, then the neighbors as ints
+ */
+struct DiskGraph {
+    int n = 0;
+    std::uint64_t entries = 0;
+    std::string path;
+    std::size_t file_bytes = 0;
+    bool temporary = false;             // spill file, removed with the last owner
+
+    const std::uint64_t *offsets = nullptr;
+    const int *neighbors = nullptr;
+    void *mapping = nullptr;
+
+    std::span<const int> row(const int v) const {
+        return {neighbors + offsets[v], static_cast<std::size_t>(offsets[v + 1] - offsets[v])};
+    }
+
+    DiskGraph() = default;
+    ~DiskGraph();
+    DiskGraph(const DiskGraph&) = delete;
+    DiskGraph& operator=(const DiskGraph&) = delete;
+};
+
+using SharedDiskGraph = std::shared_ptr<const DiskGraph>;
+
+/**
+ * Map a file written by graph_cartesian_product_to_file
+ * @param path File
+ * @param temporary Remove the file when the last owner lets go
+ * @throws std::runtime_error if the file is missing, unfinished or not a graph file
+ */
+extern SharedDiskGraph open_disk_graph(const std::string &path, bool temporary = false);
+
+/**
+ * Out-of-core Cartesian product: rows are produced in blocks that fit memory_limit and their sorted
+ * adjacency lists are appended to path, so RAM stays bounded whatever the size of the result
+ * The lists equal those of graph_cartesian_product; the file is removed again if writing fails
+ * @param g1 First graph
+ * @param g2 Second graph
+ * @param path File to create, an existing one is replaced
+ * @param memory_limit Bytes for one block of adjacency lists, at least one row is always taken
+ * @return Size of the file in bytes
+ * @throws std::runtime_error if the file cannot be written
+ */
+extern std::size_t graph_cartesian_product_to_file(const Graph &g1, const Graph &g2, const std::string &path,
+                                                   std::size_t memory_limit);
+
+// Bytes of the file graph_cartesian_product_to_file writes for a result with these sizes
+extern std::size_t disk_graph_bytes(std::uint64_t n, std::uint64_t entries);
+
+// New file name for a spill result in dir (the system temp directory if empty)
+extern std::string spill_path(const std::string &dir);
+
+#endif //DISK_GRAPH_H
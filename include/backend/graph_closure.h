@@ -0,0 +1,31 @@
+#ifndef GRAPH_CLOSURE_H
+#define GRAPH_CLOSURE_H
+
+#include <vector>
+
+#include "bit_matrix.h"
+#include "matrix_gen.h"
+
+/**
+ * Boolean matrix product C = A * B over packed rows (Four Russians, 8-bit tables)
+ * @param a Left operand
+ * @param b Right operand, same size as a
+ * @return c[i][j] = OR_k a[i][k] AND b[k][j]
+ */
+extern BitMatrix bool_multiply(const BitMatrix &a, const BitMatrix &b);
+
+/**
+ * Transitive closure by repeated squaring of the packed adjacency matrix
+ * @param graph Source graph
+ * @return new Graph with an edge i -> j whenever j is reachable from i by a non-empty path
+ */
+extern Graph transitive_closure(const Graph &graph);
+
+/**
+ * Unweighted all-pairs shortest paths, one Boolean product per distance layer
+ * @param graph Source graph
+ * @return n*n row-major distances, -1 for unreachable pairs, 0 on the diagonal
+ */
+extern std::vector<int> all_pairs_distances(const Graph &graph);
+
+#endif //GRAPH_CLOSURE_H
@@ -0,0 +1,72 @@
+#ifndef GRAPH_EXPR_H
+#define GRAPH_EXPR_H
+
+#include <memory>
+#include <string>
+
+#include "matrix_gen.h"
+#include "result_cache.h"
+
+struct GraphExpr;
+using ExprPtr = std::shared_ptr<const GraphExpr>;
+
+// Node of a lazy operation DAG, nothing is computed until evaluate()
+struct GraphExpr {
+    const Graph* leaf = nullptr;    // operand graph, nullptr for operation nodes
+    GraphOp op = GraphOp::Union;
+    SharedGraph owned;              // keeps leaf alive when it is a shared result
+    std::string name;               // label used by describe()
+    ExprPtr lhs;
+    ExprPtr rhs;
+    int n = 0;                      // vertex count of the result
+};
+
+/**
+ * Wrap an existing graph as an expression operand
+ * @param graph Operand, must outlive the expression unless owned is set
+ * @param name Label for describe()
+ * @param owned Optional shared owner of graph
+ */
+extern ExprPtr expr_leaf(const Graph *graph, const std::string &name, SharedGraph owned = nullptr);
+
+/**
+ * Build a binary operation node, vertex count follows the eager operation
+ * @throws std::runtime_error if a product has more vertices than an int can number
+ */
+extern ExprPtr expr_binary(GraphOp op, const ExprPtr &lhs, const ExprPtr &rhs);
+
+// Human-readable form, e.g. ((G1 | G2) & G1)
+extern std::string describe(const ExprPtr &expr);
+
+/**
+ * Materialize an expression
+ * Chains of union/intersection (and a ring sum on top) are fused into one pass over the rows,
+ * ring sums deeper in the tree and Cartesian products are evaluated into temporaries first
+ * @param expr Expression root
+ * @return new Graph, equal to running the eager operations one by one
+ */
+extern Graph evaluate(const ExprPtr &expr);
+
+/**
+ * Whole graph for an operand of a binary node: a leaf is used in place, a pending expression
+ * is evaluated into a temporary that is freed with this object (or by release())
+ */
+class EvaluatedOperand {
+public:
+    explicit EvaluatedOperand(const ExprPtr &operand);
+    ~EvaluatedOperand() { release(); }
+
+    const Graph &graph() const { return source != nullptr ? *source : temporary; }
+
+    // Frees the temporary early, graph() must not be used afterwards
+    void release();
+
+    EvaluatedOperand(const EvaluatedOperand&) = delete;
+    EvaluatedOperand& operator=(const EvaluatedOperand&) = delete;
+
+private:
+    const Graph *source;
+    Graph temporary;
+};
+
+#endif //GRAPH_EXPR_H
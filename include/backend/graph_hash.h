@@ -0,0 +1,22 @@
+#ifndef GRAPH_HASH_H
+#define GRAPH_HASH_H
+
+#include <cstdint>
+
+#include "matrix_gen.h"
+
+/**
+ * Weisfeiler-Lehman refinement hash, invariant under vertex renumbering
+ * Isomorphic graphs always get equal hashes; equal hashes mean "probably isomorphic"
+ * @param graph Source graph
+ * @param max_rounds Upper bound on refinement rounds, stops earlier once the partition is stable
+ */
+extern std::uint64_t wl_hash(const Graph &graph, int max_rounds = 32);
+
+/**
+ * Fingerprint of the exact matrix bits (vertex numbering matters)
+ * @param graph Source graph
+ */
+extern std::uint64_t matrix_fingerprint(const Graph &graph);
+
+#endif //GRAPH_HASH_H
@@ -0,0 +1,55 @@
+#ifndef GRAPH_REORDER_H
+#define GRAPH_REORDER_H
+
+#include <string>
+#include <vector>
+
+#include "matrix_gen.h"
+
+// Vertex orders that put neighbors close to each other
+enum class VertexOrder {
+    ReverseCuthillMcKee,    // BFS per component from a low-degree vertex, neighbors by degree, reversed
+    Degree,                 // highest degree first, hub rows end up together
+    Bfs                     // plain BFS order from a source, remaining components from their lowest vertex
+};
+
+// Order name as the reorder command takes it (rcm, degree, bfs), false if unknown
+extern bool parse_vertex_order(const std::string &name, VertexOrder &order);
+extern const char *vertex_order_name(VertexOrder order);
+
+/**
+ * New numbering of the vertices; edges count in both directions, self-loops are ignored
+ * @param graph Source graph
+ * @param order Ordering method
+ * @param source Start vertex for Bfs, ignored by the other orders
+ * @return order[k] is the old number of new vertex k, a permutation of 0 - n-1
+ */
+extern std::vector<int> vertex_order(const Graph &graph, VertexOrder order, int source = 0);
+
+/**
+ * Largest |i - j| over the edges: how far from the diagonal the matrix spreads
+ * @param graph Source graph
+ */
+extern int graph_bandwidth(const Graph &graph);
+
+/**
+ * Original numbers after a reorder, given those of the reordered graph's source
+ * @param labels Original number of each vertex of the source, empty if it was never reordered
+ * @param order Permutation applied to it
+ * @return Original number of each new vertex
+ */
+extern std::vector<int> compose_labels(const std::vector<int> &labels, const std::vector<int> &order);
+
+/**
+ * Order that undoes every reorder recorded in labels; vertices added later (label -1) go last
+ * @param labels Original number of each vertex
+ */
+extern std::vector<int> restore_order(const std::vector<int> &labels);
+
+// Keep labels in step with identify_vertices/contract_edge, which drop vertex remove
+extern void labels_after_merge(std::vector<int> &labels, int remove);
+
+// Keep labels in step with split_vertex, which appends a vertex that has no original number
+extern void labels_after_split(std::vector<int> &labels);
+
+#endif //GRAPH_REORDER_H
@@ -0,0 +1,51 @@
+#ifndef GRAPH_SPECTRAL_H
+#define GRAPH_SPECTRAL_H
+
+#include <vector>
+
+#include "matrix_gen.h"
+
+// Compressed sparse rows built from adj_list
+struct CsrMatrix {
+    int n = 0;
+    std::vector<int> offsets;   // n + 1 entries
+    std::vector<int> cols;
+};
+
+extern CsrMatrix to_csr(const Graph &graph);
+
+/**
+ * y = A * x over the adjacency matrix, rows split across threads
+ * Dense graphs multiply adj_matrix rows directly, sparse ones go through CSR
+ * @param graph Source graph, csr must be built from it when the graph is sparse
+ * @param csr Sparse rows of graph (may be empty for dense graphs)
+ * @param x Input vector, n entries
+ * @param y Output vector, resized to n
+ */
+extern void adjacency_multiply(const Graph &graph, const CsrMatrix &csr, const std::vector<double> &x, std::vector<double> &y);
+
+/**
+ * Largest eigenvalues of the (symmetric) adjacency matrix via Lanczos
+ * @param graph Source graph
+ * @param k Number of eigenvalues wanted
+ * @return up to k eigenvalues in descending order
+ */
+extern std::vector<double> adjacency_spectrum(const Graph &graph, int k);
+
+// PageRank scores with convergence info
+struct PageRankResult {
+    std::vector<double> score;
+    int iterations = 0;
+    double residual = 0.0;      // L1 change of the last iteration
+};
+
+/**
+ * PageRank by power iteration, dangling vertices spread their mass uniformly
+ * @param graph Source graph
+ * @param damping Probability of following an edge
+ * @param max_iterations Upper bound on iterations
+ * @param tolerance Stop once the L1 change drops below this
+ */
+extern PageRankResult pagerank(const Graph &graph, double damping = 0.85, int max_iterations = 100, double tolerance = 1e-10);
+
+#endif //GRAPH_SPECTRAL_H
@@ -0,0 +1,70 @@
+#ifndef GRAPH_TRAVERSAL_H
+#define GRAPH_TRAVERSAL_H
+
+#include <unordered_map>
+#include <vector>
+
+#include "matrix_gen.h"
+
+// Distances and BFS tree from one source vertex
+struct BfsResult {
+    int source = -1;
+    std::vector<int> dist;      // -1 if the vertex is unreachable
+    std::vector<int> parent;    // -1 for the source and unreachable vertices
+};
+
+// Connected components, labels are numbered in order of the smallest vertex of each component
+struct ComponentsResult {
+    std::vector<int> label;
+    int count = 0;
+};
+
+/**
+ * Breadth-first search from one vertex
+ * Dense graphs use direction-optimizing BFS over bitset frontiers, sparse ones walk adj_list
+ * @param graph Source graph
+ * @param source Start vertex number 0 - n-1
+ * @return distances and parents, empty if source is invalid
+ */
+extern BfsResult bfs(const Graph &graph, int source);
+
+/**
+ * Connected components of graph
+ * Dense graphs are swept with bitset BFS, sparse ones use parallel union-find over adj_list
+ * @param graph Source graph
+ * @return component label for every vertex
+ */
+extern ComponentsResult connected_components(const Graph &graph);
+
+/**
+ * Length of the shortest path between two vertices
+ * @param graph Source graph
+ * @param s First vertex number 0 - n-1
+ * @param t Second vertex number 0 - n-1
+ * @return number of edges, -1 if t is not reachable from s
+ */
+extern int vertex_distance(const Graph &graph, int s, int t);
+
+// Traversal results kept next to a graph and patched by structural edits
+struct ConnectivityCache {
+    bool components_valid = false;
+    ComponentsResult components;
+    std::unordered_map<int, BfsResult> bfs_by_source;
+};
+
+// Drop everything in the cache
+extern void invalidate(ConnectivityCache &cache);
+
+/**
+ * Update cache after identify_vertices/contract_edge merged remove into keep
+ * Components are merged in place, BFS results are dropped
+ */
+extern void on_vertices_merged(ConnectivityCache &cache, int keep, int remove);
+
+/**
+ * Update cache after split_vertex appended a new vertex connected to v
+ * The new vertex joins v's component, BFS results are dropped
+ */
+extern void on_vertex_split(ConnectivityCache &cache, int v);
+
+#endif //GRAPH_TRAVERSAL_H
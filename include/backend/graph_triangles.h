@@ -0,0 +1,25 @@
+#ifndef GRAPH_TRIANGLES_H
+#define GRAPH_TRIANGLES_H
+
+#include <vector>
+
+#include "matrix_gen.h"
+
+// Triangle statistics of an undirected graph, self-loops are ignored
+struct TriangleResult {
+    long long total = 0;
+    std::vector<long long> per_vertex;
+    std::vector<double> clustering;     // local clustering coefficient, 0 for degree < 2
+    double average_clustering = 0.0;
+    double transitivity = 0.0;          // 3 * triangles / connected triples
+};
+
+/**
+ * Count triangles of graph
+ * Dense graphs AND-popcount bitset rows, sparse ones intersect degree-ordered sorted lists
+ * @param graph Source graph
+ * @return global and per-vertex counts with clustering coefficients
+ */
+extern TriangleResult count_triangles(const Graph &graph);
+
+#endif //GRAPH_TRIANGLES_H
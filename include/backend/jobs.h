@@ -0,0 +1,118 @@
+#ifndef JOBS_H
+#define JOBS_H
+
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "result_cache.h"
+
+// Thrown at the next cancellation point of a job that was asked to stop
+class JobCancelled : public std::exception {
+public:
+    const char* what() const noexcept override { return "job cancelled"; }
+};
+
+// Progress and cancel flag shared between a running job and the console
+struct JobState {
+    std::atomic<long long> done{0};
+    std::atomic<long long> total{0};
+    // Announced by job_expect() and not yet started by parallel_for
+    std::atomic<long long> announced{0};
+    std::atomic<bool> cancel_requested{false};
+
+    int percent() const;
+};
+
+// Makes state the current job of this thread until the scope ends
+class JobScope {
+public:
+    explicit JobScope(JobState* state);
+    ~JobScope();
+
+    JobScope(const JobScope&) = delete;
+    JobScope& operator=(const JobScope&) = delete;
+
+private:
+    JobState* previous;
+};
+
+// Job of the calling thread, nullptr for foreground work
+extern JobState* current_job();
+
+/**
+ * Announce work of the current job before its phases start, so the percentage grows steadily
+ * @param items parallel_for items (rows) the caller is going to process
+ */
+extern void job_expect(long long items);
+
+/**
+ * Account for items a parallel_for is about to run, announced work is used up first
+ * @param items Number of items started
+ */
+extern void job_start_items(long long items);
+
+// Account for finished items of the current job
+extern void job_progress(long long items);
+
+// Cancellation point: throws JobCancelled if the current job was asked to stop
+extern void check_cancelled();
+
+// Command running on its own thread; the result is committed later by the console thread
+struct Job {
+    int id = 0;
+    std::string command;
+    JobState state;
+    std::thread thread;
+    std::atomic<bool> finished{false};
+
+    SharedGraph result;
+    std::string error;
+    bool cancelled = false;
+    std::function<void(const SharedGraph&)> commit;
+};
+
+/**
+ * Background jobs of the console
+ * Jobs only see snapshots of their operands, the workspace is touched by commit on the console thread
+ * All members lock, so the table may be used from script and server threads as well
+ */
+class JobTable {
+public:
+    JobTable() = default;
+    ~JobTable();
+
+    JobTable(const JobTable&) = delete;
+    JobTable& operator=(const JobTable&) = delete;
+
+    /**
+     * Start work on a new thread
+     * @param command Text shown by 'jobs'
+     * @param work Builds the result, may throw JobCancelled
+     * @param commit Stores the result, called from reap_finished() on the console thread
+     * @return Job id
+     */
+    int start(const std::string& command, std::function<SharedGraph()> work,
+              std::function<void(const SharedGraph&)> commit);
+
+    std::vector<std::shared_ptr<Job>> list() const;
+    std::shared_ptr<Job> find(int id) const;
+    bool cancel(int id);
+    void cancel_all();
+
+    // Remove finished jobs from the table and return them, their threads are joined
+    std::vector<std::shared_ptr<Job>> reap_finished();
+
+private:
+    mutable std::mutex mutex;
+    std::map<int, std::shared_ptr<Job>> jobs;
+    int next_id = 1;
+};
+
+#endif //JOBS_H
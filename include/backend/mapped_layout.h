@@ -0,0 +1,27 @@
+#ifndef MAPPED_LAYOUT_H
+#define MAPPED_LAYOUT_H
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+/**
+ * Section placement shared by the mapped formats: shared-memory graphs, spill files and the
+ * result mapping of worker processes
+ * Sections start on cache-line boundaries, so rows written by different workers never share a line
+ */
+constexpr std::uint64_t SECTION_ALIGN = 64;
+
+// First section boundary at or after offset
+constexpr std::uint64_t align_section(const std::uint64_t offset) {
+    return (offset + SECTION_ALIGN - 1) / SECTION_ALIGN * SECTION_ALIGN;
+}
+
+// Error of a failed open/map/write call on a mapped object, with the errno text
+inline std::runtime_error system_error(const std::string &what, const std::string &object) {
+    return std::runtime_error(what + " " + object + ": " + std::strerror(errno));
+}
+
+#endif //MAPPED_LAYOUT_H
@@ -5,31 +5,72 @@
 #ifndef MATRIX_GEN_H
 #define MATRIX_GEN_H
 
+#include <cstdint>
 #include <ctime>
+#include <exception>
 #include <iomanip>
 #include <iostream>
 #include <vector>
 
+// Binary operations between two graphs
+enum class GraphOp {
+    Union,
+    Intersection,
+    RingSum,
+    CartesianProduct
+};
+
+// Fresh value for Graph::version, never repeats within a process
+extern std::uint64_t next_graph_version();
+
 struct Graph {
-    int** adj_matrix;
+    int** adj_matrix = nullptr;
     std::vector<std::vector<int>> adj_list;
-    int n;
+    int n = 0;
+    // Changes whenever the graph is built or structurally edited
+    std::uint64_t version = next_graph_version();
+    // Matrix rows are mapped from elsewhere (shared memory): edit a copy, never free them with delete_graph
+    bool read_only = false;
 };
 
 // Function for allocating memory for a graph
 extern Graph create_graph(int n, double edgeProb = 0.4, double loopProb = 0.15, unsigned int seed = 0);
 
 // Function to display the matrix
-extern void print_matrix(int **matrix, int rows, int cols, const char *name);
+extern void print_matrix(int **matrix, int rows, int cols, const char *name, std::ostream &out = std::cout);
+
+// Deep copy of matrix and list, the copy gets its own version
+extern Graph copy_graph(const Graph& graph);
 
 // Free matrix memory
 extern void delete_graph(Graph& graph, int n);
 
+/**
+ * Frees a graph under construction when its builder is left by an exception
+ * (bad_alloc, a cancelled job); rows not allocated yet must be nullptr
+ */
+class GraphBuildGuard {
+public:
+    explicit GraphBuildGuard(Graph& target) : graph(target), exceptions(std::uncaught_exceptions()) {}
+    ~GraphBuildGuard() {
+        if (std::uncaught_exceptions() > exceptions && graph.adj_matrix != nullptr) {
+            delete_graph(graph, graph.n);
+        }
+    }
+
+    GraphBuildGuard(const GraphBuildGuard&) = delete;
+    GraphBuildGuard& operator=(const GraphBuildGuard&) = delete;
+
+private:
+    Graph& graph;
+    int exceptions;
+};
+
 // Convert exiting adj matrix to adj list
 extern std::vector<std::vector<int>> convert_to_adjacent_list(int** matrix, int n, const int* loops);
 
 // Display adj list
-extern void print_list(const std::vector<std::vector<int>> &list, const char *name);
+extern void print_list(const std::vector<std::vector<int>> &list, const char *name, std::ostream &out = std::cout);
 
 /**
  * Identify two vertices of graph
@@ -44,11 +85,20 @@ extern void identify_vertices(Graph& graph, int v, int u);
  * @param graph Modifiable graph
  * @param v First vertex number 0 - n-1
  * @param u Second vertex number 0 - n-1
+ * @return false if the vertices are not adjacent or out of range, the graph is left unchanged
  */
-extern void contract_edge(Graph &graph, int v, int u);
+extern bool contract_edge(Graph &graph, int v, int u);
 
 extern std::vector<int> get_neighbors(const Graph& graph, int v);
 
+/**
+ * Relabel the vertices: new vertex k is old vertex order[k], matrix and lists are permuted together
+ * @param graph Source graph
+ * @param order Permutation of 0 - n-1
+ * @return new Graph, its lists ascending like the row scans
+ */
+extern Graph permute_graph(const Graph &graph, const std::vector<int> &order);
+
 /**
  * Split one vertex
  * @param graph Modifiable graph
@@ -82,10 +132,57 @@ extern Graph graph_intersection(const Graph &g1, const Graph &g2);
 extern Graph ring_sum(const Graph &g1, const Graph &g2);
 
 /**
- *
+ * Union, intersection or ring sum merged from the adjacency lists instead of scanning both matrices:
+ * O(edges) per operand after the zeroed allocation, the better choice for sparse operands
+ * The matrix equals the one of graph_union / graph_intersection / ring_sum
  * @param g1 First graph
  * @param g2 Second graph
+ * @param op Union, Intersection or RingSum
  * @return new Graph
  */
+extern Graph merge_lists(const Graph &g1, const Graph &g2, GraphOp op);
+
+/**
+ * Remove vertices without edges to other vertices (self-loops don't count)
+ * @param g Graph to compact, its memory is taken over by the result
+ * @return new Graph
+ */
+extern Graph drop_isolated_vertices(Graph &g);
+
+/**
+ * Vertex count of the Cartesian product, shared by every kernel and plan that builds one
+ * @param n1 Vertices of the first factor
+ * @param n2 Vertices of the second factor
+ * @return n1 * n2, std::runtime_error if it does not fit in an int
+ */
+extern int product_vertex_count(int n1, int n2);
+
+/**
+ *
+ * @param g1 First graph
+ * @param g2 Second graph
+ * @return new Graph, std::runtime_error if the product has more vertices than an int numbers
+ */
 extern Graph graph_cartesian_product(const Graph &g1, const Graph &g2);
+
+/**
+ * Rows of a Cartesian product built from the factors' adjacency lists, without a product matrix
+ * Neighbors are taken from either direction of the factor matrices like graph_cartesian_product does,
+ * so every row comes out in ascending order and equal to that kernel's list
+ */
+struct ProductRows {
+    std::vector<std::vector<int>> first;    // g1, loops kept (the vertex itself in case 2)
+    std::vector<std::vector<int>> second;   // g2, loops dropped
+    int n2 = 0;
+
+    explicit ProductRows(const Graph &g1, const Graph &g2);
+
+    std::size_t degree(std::uint64_t i) const {
+        return first[i / n2].size() + second[i % n2].size();
+    }
+    // Longest row, for sizing buffers
+    std::size_t max_degree() const;
+    // Writes the neighbors of row i to out, returns the end
+    int *fill(std::uint64_t i, int *out) const;
+};
 #endif //MATRIX_GEN_H
\ No newline at end of file
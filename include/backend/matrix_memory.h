@@ -0,0 +1,40 @@
+#ifndef MATRIX_MEMORY_H
+#define MATRIX_MEMORY_H
+
+#include <cstddef>
+
+/**
+ * Row storage of n x n int matrices
+ * Small matrices get one heap row each; from LARGE_MATRIX_BYTES on the rows share one anonymous mapping
+ * aligned to 2 MB and advised for transparent huge pages, so the row kernels need far fewer TLB entries.
+ * Rows are touched first by the parallel_for workers, in the row blocks the kernels use later,
+ * so on a NUMA machine their pages land on the node of the thread that processes them
+ */
+
+// Matrices of this many bytes and more are mapped instead of allocated row by row
+constexpr std::size_t LARGE_MATRIX_BYTES = std::size_t{8} << 20;
+
+/**
+ * Rows of an n x n matrix
+ * @param n Rows and columns
+ * @param zeroed Clear every cell; otherwise the caller writes every cell, preferably from parallel_for
+ * @return Row pointers, free with free_matrix
+ * @throws std::bad_alloc if the memory is not available
+ */
+extern int** allocate_matrix(int n, bool zeroed = true);
+
+/**
+ * Free a matrix from allocate_matrix; rows still nullptr are skipped
+ * @param matrix Row pointers, nullptr is ignored
+ * @param n Rows it was allocated with
+ */
+extern void free_matrix(int** matrix, int n);
+
+// Map large matrices with huge pages from now on (on by default); off keeps every row on the heap
+extern void set_huge_pages(bool enabled);
+extern bool huge_pages_enabled();
+
+// Bytes currently held in huge-page mappings
+extern std::size_t mapped_matrix_bytes();
+
+#endif //MATRIX_MEMORY_H
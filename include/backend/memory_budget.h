@@ -0,0 +1,50 @@
+#ifndef MEMORY_BUDGET_H
+#define MEMORY_BUDGET_H
+
+#include <cstddef>
+
+#include "graph_expr.h"
+
+// Bytes of a graph split by representation
+struct GraphFootprint {
+    std::size_t matrix = 0;    // n x n ints and row pointers on the heap
+    std::size_t lists = 0;     // adjacency list vectors
+    std::size_t mapped = 0;    // matrix rows inside a shared-memory mapping, not on the heap
+
+    std::size_t total() const { return matrix + lists + mapped; }
+
+    GraphFootprint& operator+=(const GraphFootprint &other) {
+        matrix += other.matrix;
+        lists += other.lists;
+        mapped += other.mapped;
+        return *this;
+    }
+};
+
+extern GraphFootprint graph_footprint(const Graph &graph);
+
+/**
+ * Estimate what materializing an expression allocates, from vertex counts and operand list sizes
+ * Covers the result plus the temporaries alive at the same time (product operands, ring sum renumbering);
+ * list sizes are upper bounds, so the estimate errs on the high side
+ * @param expr Expression, a leaf costs nothing
+ */
+extern GraphFootprint predict_footprint(const ExprPtr &expr);
+
+// Adjacency list entries of the expression's result, an upper bound for computed nodes
+extern std::size_t predict_entries(const ExprPtr &expr);
+
+/**
+ * Estimate the footprint of create_graph
+ * @param n Vertex count
+ * @param edge_probability Expected share of set cells
+ */
+extern GraphFootprint predict_create_footprint(int n, double edge_probability);
+
+// Installed RAM, 0 if unknown
+extern std::size_t physical_memory_bytes();
+
+// Resident set of this process, 0 if unknown
+extern std::size_t resident_bytes();
+
+#endif //MEMORY_BUDGET_H
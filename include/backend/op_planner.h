@@ -0,0 +1,74 @@
+#ifndef OP_PLANNER_H
+#define OP_PLANNER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "disk_graph.h"
+#include "graph_expr.h"
+#include "memory_budget.h"
+
+// Ways to produce the result of a binary operation
+enum class Strategy {
+    DenseMatrix,    // row scans over both int matrices (graph_union, ..., graph_cartesian_product)
+    ListMerge,      // merge of the adjacency lists into a zeroed matrix (merge_lists)
+    LazyView,       // keep the expression, evaluated by the fused bit-row pass when used
+    OutOfCore,      // product streamed to a file in row blocks and mapped back (graph_cartesian_product_to_file)
+    WorkerProcesses // dense row scans split across forked processes (run_in_processes)
+};
+
+struct StrategyCost {
+    Strategy strategy = Strategy::DenseMatrix;
+    double seconds = 0;         // predicted wall time with the current worker threads
+    std::size_t bytes = 0;      // allocated on top of the operands
+    std::size_t file_bytes = 0; // written to the spill directory
+    bool available = true;      // false if the strategy cannot run this operation at all
+    std::string note;           // why it is unavailable or what it defers
+};
+
+// Estimate and decision for one operation
+struct OpPlan {
+    GraphOp op = GraphOp::Union;
+    int n = 0;                  // result vertices
+    std::size_t entries = 0;    // result adjacency list entries, an upper bound
+    std::vector<StrategyCost> candidates;
+    Strategy chosen = Strategy::DenseMatrix;
+    std::size_t block_bytes = 0;  // RAM for one block of rows when out of core
+    int processes = 0;            // worker processes for WorkerProcesses
+
+    const StrategyCost &choice() const;
+};
+
+extern const char *strategy_name(Strategy strategy);
+
+/**
+ * Estimate every strategy from vertex counts, list sizes and the worker count, then pick the fastest one
+ * whose memory fits; a product that fits nowhere in memory goes out of core if the disk has room,
+ * anything else stays a lazy view; with worker processes they replace the threads of the dense scan
+ * @param expr Binary operation node
+ * @param available Bytes the operation may allocate, SIZE_MAX for no limit
+ * @param spill_space Free bytes in the spill directory, 0 turns out-of-core results off
+ * @param processes Worker processes for union, ring sum and product, 0 or 1 keeps them on threads
+ */
+extern OpPlan plan_operation(const ExprPtr &expr, std::size_t available, std::size_t spill_space = 0,
+                             int processes = 0);
+
+/**
+ * Materialize the expression with the plan's strategy; pending operands are evaluated first
+ * @param plan Result of plan_operation for expr, not a lazy view
+ * @param expr Binary operation node
+ * @return new Graph, its rows are in a shared mapping (read_only) for worker processes
+ */
+extern SharedGraph run_plan(const OpPlan &plan, const ExprPtr &expr);
+
+/**
+ * Write the result of an out-of-core plan to a new spill file and map it
+ * @param plan Result of plan_operation for expr with the OutOfCore strategy
+ * @param expr Product node, pending operands are evaluated first
+ * @param dir Spill directory, the system temp directory if empty
+ * @return Mapped result, its file is removed with the last owner
+ */
+extern SharedDiskGraph run_plan_out_of_core(const OpPlan &plan, const ExprPtr &expr, const std::string &dir);
+
+#endif //OP_PLANNER_H
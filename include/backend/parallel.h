@@ -0,0 +1,31 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <functional>
+
+// Number of worker threads used by the row-parallel backend kernels
+extern int hardware_threads();
+
+/**
+ * Resize the shared executor; safe while loops run, they finish on the old workers,
+ * which are joined once the last of those loops returns
+ * @param threads Worker count including the calling thread, 0 = one per hardware thread
+ */
+extern void set_thread_count(int threads);
+
+/**
+ * Grain for row loops where a row costs about cost_per_row simple operations,
+ * so one task is big enough to pay for being scheduled
+ * @param cost_per_row Work per row, usually the number of matrix cells in it
+ */
+extern int row_grain(long long cost_per_row);
+
+/**
+ * Run body over [0, count) split into contiguous chunks on the shared work-stealing executor
+ * @param count Number of items (rows, vertices, ...)
+ * @param body Called as body(begin, end) for each chunk
+ * @param grain Minimal chunk size, smaller ranges stay on the calling thread
+ */
+extern void parallel_for(int count, const std::function<void(int, int)> &body, int grain = 1024);
+
+#endif //PARALLEL_H
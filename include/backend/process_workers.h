@@ -0,0 +1,23 @@
+#ifndef PROCESS_WORKERS_H
+#define PROCESS_WORKERS_H
+
+#include "result_cache.h"
+
+/**
+ * Union, ring sum or Cartesian product computed by forked worker processes instead of threads:
+ * the result matrix and a list area sized from the operands live in one shared anonymous mapping,
+ * workers claim blocks of rows from a shared counter and write rows and lists in place,
+ * so every process does its own allocation and page faults
+ * The result equals graph_union / ring_sum / graph_cartesian_product; its rows stay in the mapping,
+ * so it is read_only and edits copy it first, except a ring sum that dropped isolated vertices,
+ * which is renumbered into an ordinary heap graph
+ * @param g1 First graph
+ * @param g2 Second graph
+ * @param op Union, RingSum or CartesianProduct
+ * @param processes Worker processes to fork, at least one
+ * @return Graph unmapped when the last owner lets go
+ * @throws std::runtime_error if the mapping or a process cannot be created or a worker fails
+ */
+extern SharedGraph run_in_processes(const Graph &g1, const Graph &g2, GraphOp op, int processes);
+
+#endif //PROCESS_WORKERS_H
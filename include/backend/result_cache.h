@@ -0,0 +1,72 @@
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "matrix_gen.h"
+
+// Graph shared between a slot and the cache, freed with delete_graph when the last owner goes
+using SharedGraph = std::shared_ptr<Graph>;
+
+extern SharedGraph make_shared_graph(Graph &&graph);
+
+// Bytes held by a graph: matrix rows, row pointers and adjacency lists
+extern std::size_t graph_bytes(const Graph &graph);
+
+/**
+ * LRU cache of binary operation results keyed by (operation, operand versions)
+ * Entries are evicted from the cold end once the byte budget is exceeded
+ * All members lock, commands running on different threads share one cache
+ */
+class ResultCache {
+public:
+    explicit ResultCache(std::size_t limit = 256u << 20);
+
+    SharedGraph find(GraphOp op, std::uint64_t v1, std::uint64_t v2);
+    void insert(GraphOp op, std::uint64_t v1, std::uint64_t v2, const SharedGraph &result);
+    void clear();
+
+    void set_budget(std::size_t limit);
+    std::size_t budget() const;
+    std::size_t used() const;
+    // Bytes of entries no slot or expression holds any more, what clear() gives back
+    std::size_t exclusive() const;
+    std::size_t size() const;
+    std::size_t hit_count() const;
+    std::size_t miss_count() const;
+
+private:
+    struct Key {
+        GraphOp op;
+        std::uint64_t v1;
+        std::uint64_t v2;
+        bool operator==(const Key &other) const = default;
+    };
+
+    struct KeyHash {
+        std::size_t operator()(const Key &key) const;
+    };
+
+    struct Entry {
+        Key key;
+        SharedGraph result;
+        std::size_t bytes;
+    };
+
+    mutable std::mutex mutex;
+    std::list<Entry> entries;   // most recently used first
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index;
+    std::size_t budget_bytes;
+    std::size_t used_bytes = 0;
+    std::size_t hits = 0;
+    std::size_t misses = 0;
+
+    void evict();
+};
+
+#endif //RESULT_CACHE_H
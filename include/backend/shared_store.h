@@ -0,0 +1,42 @@
+#ifndef SHARED_STORE_H
+#define SHARED_STORE_H
+
+#include <cstddef>
+#include <string>
+
+#include "result_cache.h"
+
+/**
+ * Graphs published as POSIX shared-memory objects, so other processes can map them instead of rebuilding them
+ * The object is position independent: a header with byte offsets from its start, the n x n matrix row by row,
+ * then the adjacency lists as CSR (n + 1 offsets and the neighbors)
+ */
+
+// Shared-memory object name for a user-given name, a leading '/' is added when missing
+extern std::string shared_object_name(const std::string &name);
+
+/**
+ * Copy a graph into a new shared-memory object
+ * @param graph Graph to publish
+ * @param name Object name, publishing over an existing object fails
+ * @return Size of the object in bytes
+ * @throws std::runtime_error if the object cannot be created
+ */
+extern std::size_t publish_graph(const Graph &graph, const std::string &name);
+
+/**
+ * Map a published graph read-only; matrix rows point into the mapping (no copy),
+ * adjacency lists are rebuilt from the CSR part since Graph keeps them in vectors
+ * The graph has read_only set and is unmapped when the last owner lets go
+ * @param name Object name
+ * @throws std::runtime_error if the object is missing or not a published graph
+ */
+extern SharedGraph attach_graph(const std::string &name);
+
+/**
+ * Remove the object name; processes that attached it keep their mapping
+ * @return false if there was no such object
+ */
+extern bool unpublish_graph(const std::string &name);
+
+#endif //SHARED_STORE_H
@@ -0,0 +1,72 @@
+#ifndef WORKSPACE_H
+#define WORKSPACE_H
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "disk_graph.h"
+#include "graph_expr.h"
+#include "graph_traversal.h"
+#include "memory_budget.h"
+#include "result_cache.h"
+
+// One named graph: materialized, a pending lazy expression or an out-of-core file
+struct GraphSlot {
+    SharedGraph graph;
+    ExprPtr pending;
+    SharedDiskGraph disk;
+    ConnectivityCache cache;
+    // Original number of each vertex after 'reorder', empty while the graph keeps its numbering
+    std::vector<int> labels;
+};
+
+/**
+ * Named set of graphs used as operands and destinations of commands
+ * Graphs are shared with the result cache and lazy expressions, writers get a private copy
+ * The slot map is locked, so commands on different slots may run on different threads;
+ * a slot itself must not be written while another thread uses it
+ */
+class Workspace {
+public:
+    bool contains(const std::string& name) const;
+    bool is_pending(const std::string& name) const;
+    std::vector<std::string> names() const;
+
+    // Graph for reading, pending expressions are evaluated first; nullptr if missing
+    Graph* get(const std::string& name);
+
+    // Graph for in-place edits, unshared from the cache and from lazy expressions
+    Graph* get_for_write(const std::string& name);
+
+    // Snapshot of the slot usable as an expression operand; nullptr if missing or on disk
+    ExprPtr operand(const std::string& name) const;
+
+    ConnectivityCache* cache(const std::string& name);
+    // Reorder permutation of the slot, replaced together with its graph; nullptr if missing
+    std::vector<int>* labels(const std::string& name);
+
+    void put(const std::string& name, SharedGraph graph);
+    void put_pending(const std::string& name, ExprPtr expr);
+    void put_disk(const std::string& name, SharedDiskGraph graph);
+    // Out-of-core graph of the slot, nullptr for other slots
+    SharedDiskGraph disk(const std::string& name) const;
+    bool erase(const std::string& name);
+    void clear();
+
+    // Bytes held by the slot's graph, 0 while it is still pending
+    std::size_t bytes(const std::string& name) const;
+    GraphFootprint footprint(const std::string& name) const;
+    // Graphs shared by several slots are counted once
+    std::size_t total_bytes() const;
+
+private:
+    mutable std::mutex mutex;
+    std::map<std::string, GraphSlot> slots;
+
+    std::size_t bytes_locked(const std::string& name) const;
+};
+
+#endif //WORKSPACE_H
@@ -32,6 +32,15 @@ struct ConsoleConfig {
     bool show_help_on_unknown = true;
     bool clear_screen_on_start = false;
     int history_size = 100;
+    int cache_budget_mb = 256;
+    int memory_budget_mb = 0;
+    bool out_of_core = true;
+    std::string spill_dir;
+    int threads = 0;
+    int worker_processes = 0;
+    bool huge_pages = true;
+    int server_connections = 16;
+    bool profiling = false;
 
     std::unordered_map<std::string, std::string> colors;
     std::vector<CommandConfig> commands;
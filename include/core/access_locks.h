@@ -0,0 +1,88 @@
+#ifndef ACCESS_LOCKS_H
+#define ACCESS_LOCKS_H
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "script_scheduler.h"
+
+/**
+ * Reader/writer locks over named resources, taken as a CommandAccess describes
+ * Readers of a resource share its lock, a writer holds it alone; a barrier excludes everyone
+ */
+class AccessLocks {
+public:
+    // Holds the locks of one command until it goes out of scope
+    class Guard {
+    public:
+        Guard() = default;
+        Guard(Guard&& other) noexcept
+            : gate(std::exchange(other.gate, nullptr)), exclusive_gate(other.exclusive_gate),
+              held(std::move(other.held)) {}
+        Guard& operator=(Guard&&) = delete;
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+
+        ~Guard() {
+            for (auto it = held.rbegin(); it != held.rend(); ++it) {
+                if (it->second) it->first->unlock();
+                else it->first->unlock_shared();
+            }
+            if (gate == nullptr) return;
+            if (exclusive_gate) gate->unlock();
+            else gate->unlock_shared();
+        }
+
+    private:
+        friend class AccessLocks;
+        std::shared_mutex* gate = nullptr;
+        bool exclusive_gate = false;
+        // Resource lock and whether it is held for writing
+        std::vector<std::pair<std::shared_mutex*, bool>> held;
+    };
+
+    Guard acquire(const CommandAccess& access) {
+        Guard guard;
+        guard.gate = &gate;
+        guard.exclusive_gate = access.barrier;
+        if (access.barrier) {
+            gate.lock();
+            return guard;
+        }
+        gate.lock_shared();
+
+        // Name order everywhere, so two commands never wait for each other
+        std::map<std::string, bool> wanted;
+        for (const auto& name : access.reads) wanted.emplace(name, false);
+        for (const auto& name : access.writes) wanted[name] = true;
+
+        for (const auto& [name, write] : wanted) {
+            std::shared_mutex& lock = resource(name);
+            if (write) lock.lock();
+            else lock.lock_shared();
+            guard.held.emplace_back(&lock, write);
+        }
+        return guard;
+    }
+
+private:
+    std::shared_mutex gate;
+    std::mutex table_mutex;
+    // Never erased, a dropped slot name keeps its (unlocked) entry
+    std::map<std::string, std::unique_ptr<std::shared_mutex>> table;
+
+    std::shared_mutex& resource(const std::string& name) {
+        std::lock_guard lock(table_mutex);
+        auto& entry = table[name];
+        if (entry == nullptr) entry = std::make_unique<std::shared_mutex>();
+        return *entry;
+    }
+};
+
+#endif //ACCESS_LOCKS_H
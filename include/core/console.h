@@ -1,6 +1,9 @@
 #ifndef UNIVERSAL_CONSOLE_H
 #define UNIVERSAL_CONSOLE_H
 
+#include <atomic>
+#include <cctype>
+#include <charconv>
 #include <deque>
 #include <string>
 #include <unordered_map>
@@ -10,6 +13,10 @@
 #include <iostream>
 #include <ranges>
 #include <sstream>
+#include <string_view>
+
+#include "dispatch_table.h"
+#include "profiler.h"
 
 #include "../config/config_loader.h"
 
@@ -32,7 +39,7 @@ class Console {
 public:
     using CommandHandler = std::function<void(const std::vector<std::string>&)>;
 
-    Console() : running(false) {
+    Console() : running(false), interactive(true), failures(0) {
         config.prompt = "> ";
         config.welcome_msg = "Console v0.0.1";
     }
@@ -47,10 +54,17 @@ public:
         info.parameters = parameters;
         info.usage = usage.empty() ? build_usage(name, parameters) : usage;
         commands[name] = info;
+        dispatch_ready = false;
     }
 
     void register_alias(const std::string& alias, const std::string& command) {
         aliases[alias] = command;
+        dispatch_ready = false;
+    }
+
+    // Called before each input line is handled, e.g. to report finished background work
+    void set_before_command(const std::function<void()>& hook) {
+        before_command = hook;
     }
 
     void set_config(const ConsoleConfig& newConfig) {
@@ -60,18 +74,21 @@ public:
 
     void run() {
         running = true;
+        prepare_dispatch();
         std::string input;
 
         if (config.clear_screen_on_start) {
             clear_screen();
         }
 
-        std::cout << get_color("info") << config.welcome_msg << reset_color() << std::endl;
-        std::cout << "Type 'help' for available commands" << std::endl;
+        out() << get_color("info") << config.welcome_msg << reset_color() << '\n';
+        out() << "Type 'help' for available commands" << '\n';
 
         while (running) {
-            std::cout << get_color("info") << config.prompt << reset_color();
-            std::getline(std::cin, input);
+            out() << get_color("info") << config.prompt << reset_color();
+            if (!std::getline(std::cin, input)) {
+                break;
+            }
 
             if (input.empty()) continue;
 
@@ -81,38 +98,134 @@ public:
         }
     }
 
+    /**
+     * Run commands from a stream without banner, prompt, colors or history
+     * @param in Script file or piped stdin, '#' starts a comment line
+     * @param stop_on_error Stop at the first line that reported a failure
+     * @return Number of failures reported while running
+     */
+    int run_batch(std::istream& in, const bool stop_on_error = false) {
+        start_batch();
+
+        std::string input;
+        while (running && std::getline(in, input)) {
+            if (is_blank_or_comment(input)) continue;
+            if (execute(input) && stop_on_error) break;
+        }
+
+        running = false;
+        return failures;
+    }
+
+    // Batch setup without reading anything, for runners that schedule lines themselves
+    void start_batch() {
+        prepare_dispatch();
+        running = true;
+        interactive = false;
+        config.colors_enabled = false;
+    }
+
+    static bool is_blank_or_comment(const std::string& input) {
+        const size_t start = input.find_first_not_of(" \t\r");
+        return start == std::string::npos || input[start] == '#';
+    }
+
+    /**
+     * Handle one command line, output goes to out() of the calling thread
+     * @param input Command line
+     * @param run_hooks Call the before-command hook; lines running next to others skip it
+     * @return true if the line reported a failure
+     */
+    bool execute(const std::string& input, const bool run_hooks = true) {
+        line_failed = false;
+        process_input(input, run_hooks);
+        return line_failed;
+    }
+
+    bool is_running() const {
+        return running;
+    }
+
+    // Stream for command output on this thread, std::cout unless redirected
+    static std::ostream& out() {
+        return output != nullptr ? *output : std::cout;
+    }
+
+    // Send this thread's output to stream, nullptr goes back to std::cout
+    static void redirect_output(std::ostream* stream) {
+        output = stream;
+    }
+
     void stop() {
         running = false;
-        std::cout << get_color("success") << config.exit_msg << reset_color() << std::endl;
+        if (interactive) {
+            out() << get_color("success") << config.exit_msg << reset_color() << '\n';
+        }
+    }
+
+    bool is_interactive() const {
+        return interactive;
+    }
+
+    // Commands call this when they print an error, batch mode turns it into the exit status
+    void mark_failed() {
+        failures++;
+        line_failed = true;
+    }
+
+    int failure_count() const {
+        return failures;
     }
 
     static std::vector<std::string> tokenize(const std::string& input) {
-        std::vector<std::string> tokens;
-        std::istringstream iss(input);
-        std::string token;
+        std::vector<std::string_view> views;
+        split_tokens(input, views);
+        return {views.begin(), views.end()};
+    }
 
-        while (iss >> token) {
-            tokens.push_back(token);
+    // Plain whitespace scan into views of input, tokens keeps its capacity between calls
+    static void split_tokens(const std::string_view input, std::vector<std::string_view>& tokens) {
+        tokens.clear();
+        size_t pos = 0;
+        while (pos < input.size()) {
+            while (pos < input.size() && is_blank(input[pos])) pos++;
+            const size_t begin = pos;
+            while (pos < input.size() && !is_blank(input[pos])) pos++;
+            if (pos > begin) tokens.push_back(input.substr(begin, pos - begin));
         }
+    }
+
+    // Whole-token number parsing without exceptions or locale; false if text is not exactly a number
+    static bool parse_number(const std::string_view text, int& value) {
+        const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+        return error == std::errc() && end == text.data() + text.size();
+    }
+
+    static bool parse_number(const std::string_view text, double& value) {
+        const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+        return error == std::errc() && end == text.data() + text.size();
+    }
 
-        return tokens;
+    std::string resolve_command(const std::string& input) const {
+        const auto it = aliases.find(input);
+        return it != aliases.end() ? it->second : input;
     }
 
     void print_help() {
-        std::cout << get_color("info") << "Available commands:" << reset_color() << std::endl;
+        out() << get_color("info") << "Available commands:" << reset_color() << '\n';
         size_t max_name_length = 12;
         for (const auto &name: commands | views::keys) {
             max_name_length = std::max(max_name_length, name.length());
         }
 
         for (const auto& [name, info] : commands) {
-            std::cout << "  " << get_color("success") << std::setw(static_cast<int>(max_name_length))
+            out() << "  " << get_color("success") << std::setw(static_cast<int>(max_name_length))
                       << std::left << name << reset_color() << " - " << info.description;
 
             if (!info.usage.empty()) {
-                std::cout << " " << get_color("warning") << "(" << info.usage << ")" << reset_color();
+                out() << " " << get_color("warning") << "(" << info.usage << ")" << reset_color();
             }
-            std::cout << std::endl;
+            out() << '\n';
         }
     }
 
@@ -121,18 +234,18 @@ public:
 
         if (auto it = commands.find(resolved); it != commands.end()) {
             const auto& info = it->second;
-            std::cout << get_color("info") << "Command: " << resolved << reset_color() << std::endl;
-            std::cout << "  Description: " << info.description << std::endl;
-            std::cout << "  Usage: " << get_color("success") << info.usage << reset_color() << std::endl;
+            out() << get_color("info") << "Command: " << resolved << reset_color() << '\n';
+            out() << "  Description: " << info.description << '\n';
+            out() << "  Usage: " << get_color("success") << info.usage << reset_color() << '\n';
 
             if (!info.parameters.empty()) {
-                std::cout << "  Parameters:" << std::endl;
+                out() << "  Parameters:" << '\n';
                 for (const auto& param : info.parameters) {
-                    std::cout << "    - " << param << std::endl;
+                    out() << "    - " << param << '\n';
                 }
             }
         } else {
-            std::cout << get_color("error") << "Unknown command: " << command_name << reset_color() << std::endl;
+            out() << get_color("error") << "Unknown command: " << command_name << reset_color() << '\n';
         }
     }
 
@@ -144,6 +257,11 @@ public:
     void load_aliases(const std::string& aliasPath) {
         auto newAliases = ConfigLoader::load_aliases(aliasPath);
         aliases.insert(newAliases.begin(), newAliases.end());
+        dispatch_ready = false;
+    }
+
+    const ConsoleConfig& get_config() const {
+        return config;
     }
 
     std::unordered_map<std::string, std::string> get_aliases() {
@@ -159,14 +277,18 @@ public:
     }
 
     void show_history() {
-        std::cout << get_color("info") << "Command history (last " << command_history.size() << " commands):" << reset_color() << std::endl;
+        out() << get_color("info") << "Command history (last " << command_history.size() << " commands):" << reset_color() << '\n';
         for (size_t i = 0; i < command_history.size(); ++i) {
-            std::cout << "  " << (i + 1) << ": " << command_history[i] << std::endl;
+            out() << "  " << (i + 1) << ": " << command_history[i] << '\n';
         }
     }
 
 private:
     bool running;
+    bool interactive;
+    std::atomic<int> failures;
+    static inline thread_local bool line_failed = false;
+    static inline thread_local std::ostream* output = nullptr;
     std::deque<std::string> commands_history;
     ConsoleConfig config;
     std::deque<std::string> command_history;
@@ -180,60 +302,114 @@ private:
 
     std::unordered_map<std::string, CommandInfo> commands;
     std::unordered_map<std::string, std::string> aliases;
+    std::function<void()> before_command;
 
-    std::string resolve_command(const std::string& input) {
-        const auto it = aliases.find(input);
-        return it != aliases.end() ? it->second : input;
-    }
+    enum class Builtin { None, Exit, Help, Clear, History };
 
-    void process_input(const std::string& input) {
-        auto tokens = tokenize(input);
-        if (tokens.empty()) return;
+    // What a typed name runs: a built-in, a command (aliases already resolved), or nothing
+    struct Dispatch {
+        Builtin builtin = Builtin::None;
+        const CommandInfo* info = nullptr;
+        std::string resolved;   // name reported when info is missing
+        ProfileSite* site = nullptr;  // latency of the command, shared by its aliases
+    };
 
-        std::string commandName = tokens[0];
+    DispatchTable<Dispatch> dispatch;
+    bool dispatch_ready = false;
 
-        if (commandName == "exit" || commandName == "quit") {
-            stop();
-            return;
-        }
+    static bool is_blank(const char c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+    }
+
+    // Built-ins win over aliases and aliases over commands, as the old lookup chain did
+    void prepare_dispatch() {
+        if (dispatch_ready) return;
 
-        if (commandName == "help") {
-            if (tokens.size() > 1) {
-                show_command_help(tokens[1]);
+        std::unordered_map<std::string, Dispatch> names;
+        for (const auto& [name, info] : commands) {
+            names[name] = Dispatch{Builtin::None, &info, name, &profile_site("command", name)};
+        }
+        for (const auto& [alias, target] : aliases) {
+            const auto it = commands.find(target);
+            if (it != commands.end()) {
+                names[alias] = Dispatch{Builtin::None, &it->second, target, &profile_site("command", target)};
             } else {
-                print_help();
+                names[alias] = Dispatch{Builtin::None, nullptr, target};
             }
-            return;
         }
-
-        if (commandName == "clear") {
-            clear_screen();
-            return;
+        for (const auto& [name, builtin] : {std::pair{"exit", Builtin::Exit}, std::pair{"quit", Builtin::Exit},
+                                            std::pair{"help", Builtin::Help}, std::pair{"clear", Builtin::Clear},
+                                            std::pair{"history", Builtin::History}}) {
+            names[name] = Dispatch{builtin, nullptr, name};
         }
 
-        if (commandName == "history") {
-            show_history();
-            return;
+        std::vector<DispatchTable<Dispatch>::Entry> entries;
+        entries.reserve(names.size());
+        for (auto& [name, target] : names) {
+            entries.push_back({name, std::move(target)});
         }
+        dispatch.build(std::move(entries));
+        dispatch_ready = true;
+    }
+
+    void process_input(const std::string& input, const bool run_hooks = true) {
+        // Token views and argument strings are reused per thread, steady-state lines allocate nothing.
+        // Handlers therefore must not feed lines back into the console while they run
+        thread_local std::vector<std::string_view> tokens;
+        thread_local std::vector<std::string> args;
+
+        split_tokens(input, tokens);
+        if (tokens.empty()) return;
 
-        std::string resolvedCommand = resolve_command(commandName);
-        if (resolvedCommand != commandName) {
-            tokens[0] = resolvedCommand;
+        if (run_hooks && before_command) {
+            before_command();
         }
 
-        commandName = resolvedCommand;
+        // Single-threaded callers may still be registering commands
+        prepare_dispatch();
+        const Dispatch* target = dispatch.find(tokens[0]);
+
+        if (target != nullptr) {
+            switch (target->builtin) {
+                case Builtin::Exit:
+                    stop();
+                    return;
+                case Builtin::Help:
+                    if (tokens.size() > 1) {
+                        show_command_help(std::string(tokens[1]));
+                    } else {
+                        print_help();
+                    }
+                    return;
+                case Builtin::Clear:
+                    clear_screen();
+                    return;
+                case Builtin::History:
+                    show_history();
+                    return;
+                case Builtin::None:
+                    break;
+            }
+        }
 
-        if (const auto it = commands.find(commandName); it != commands.end()) {
+        if (target != nullptr && target->info != nullptr) {
+            args.resize(tokens.size() - 1);
+            for (size_t i = 1; i < tokens.size(); i++) {
+                args[i - 1].assign(tokens[i]);
+            }
             try {
-                const std::vector<std::string> args(tokens.begin() + 1, tokens.end());
-                it->second.handler(args);
+                ProfileScope scope(*target->site);
+                target->info->handler(args);
             } catch (const std::exception& e) {
-                std::cout << get_color("error") << "Error executing command: " << e.what() << reset_color() << std::endl;
+                mark_failed();
+                out() << get_color("error") << "Error executing command: " << e.what() << reset_color() << '\n';
             }
         } else {
-            std::cout << get_color("error") << config.unknown_msg << ": " << commandName << reset_color() << std::endl;
+            mark_failed();
+            const std::string_view commandName = target != nullptr ? std::string_view(target->resolved) : tokens[0];
+            out() << get_color("error") << config.unknown_msg << ": " << commandName << reset_color() << '\n';
             if (config.show_help_on_unknown) {
-                std::cout << "Type 'help' for available commands" << std::endl;
+                out() << "Type 'help' for available commands" << '\n';
             }
         }
     }
@@ -0,0 +1,80 @@
+#ifndef DISPATCH_TABLE_H
+#define DISPATCH_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * Collision-free hash table over a fixed set of names, rebuilt whenever the set changes
+ * build() searches for a seed that gives every name its own bucket, so a lookup is one hash,
+ * one load from a small index and one string compare; misses usually stop at the empty bucket
+ */
+template <typename Value>
+class DispatchTable {
+public:
+    struct Entry {
+        std::string name;
+        Value value;
+    };
+
+    // Names must be unique
+    void build(std::vector<Entry> items) {
+        entries = std::move(items);
+
+        // Birthday bound: about n^2 / 2 buckets give a good chance per seed, a few seeds are tried per size
+        std::size_t size = 16;
+        while (size < entries.size() * entries.size() / 2) size <<= 1;
+
+        for (;; size <<= 1) {
+            for (std::uint64_t attempt = 1; attempt <= SEEDS_PER_SIZE; attempt++) {
+                if (try_place(size, attempt * 0x9e3779b97f4a7c15ull)) return;
+            }
+        }
+    }
+
+    const Value* find(const std::string_view name) const {
+        if (index.empty()) return nullptr;
+        const std::uint32_t slot = index[hash(name, seed) & mask];
+        if (slot == 0) return nullptr;
+        const Entry& entry = entries[slot - 1];
+        return entry.name == name ? &entry.value : nullptr;
+    }
+
+private:
+    static constexpr std::uint64_t SEEDS_PER_SIZE = 32;
+
+    std::vector<Entry> entries;
+    // Bucket -> entry number + 1, 0 for an empty bucket
+    std::vector<std::uint32_t> index;
+    std::uint64_t seed = 0;
+    std::size_t mask = 0;
+
+    // FNV-1a with a seeded start and a final fold of the high bits
+    static std::uint64_t hash(const std::string_view name, const std::uint64_t start) {
+        std::uint64_t h = 0xcbf29ce484222325ull ^ start;
+        for (const char c : name) {
+            h ^= static_cast<unsigned char>(c);
+            h *= 0x100000001b3ull;
+        }
+        return h ^ (h >> 29);
+    }
+
+    bool try_place(const std::size_t size, const std::uint64_t candidate) {
+        std::vector<std::uint32_t> buckets(size, 0);
+        for (std::size_t i = 0; i < entries.size(); i++) {
+            std::uint32_t& bucket = buckets[hash(entries[i].name, candidate) & (size - 1)];
+            if (bucket != 0) return false;
+            bucket = static_cast<std::uint32_t>(i + 1);
+        }
+        index = std::move(buckets);
+        seed = candidate;
+        mask = size - 1;
+        return true;
+    }
+};
+
+#endif //DISPATCH_TABLE_H
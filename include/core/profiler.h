@@ -0,0 +1,246 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "trace.h"
+
+/**
+ * Latency and allocation statistics of one instrumented place: a console command or a backend function
+ * Durations go into quarter-octave buckets, so percentiles are exact to about 10% and recording
+ * is a handful of relaxed atomic adds with no lock
+ */
+class ProfileSite {
+public:
+    struct Summary {
+        std::uint64_t calls = 0;
+        std::uint64_t total_ns = 0;
+        std::uint64_t p50_ns = 0;
+        std::uint64_t p99_ns = 0;
+        std::uint64_t max_ns = 0;
+        std::uint64_t allocations = 0;
+        std::uint64_t allocated_bytes = 0;
+    };
+
+    ProfileSite(std::string site_category, std::string site_name)
+        : category(std::move(site_category)), name(std::move(site_name)) {}
+
+    void record(const std::uint64_t ns, const std::uint64_t allocation_count, const std::uint64_t bytes) {
+        buckets[bucket_of(ns)].fetch_add(1, std::memory_order_relaxed);
+        calls.fetch_add(1, std::memory_order_relaxed);
+        total_ns.fetch_add(ns, std::memory_order_relaxed);
+        allocations.fetch_add(allocation_count, std::memory_order_relaxed);
+        allocated_bytes.fetch_add(bytes, std::memory_order_relaxed);
+        std::uint64_t seen = max_ns.load(std::memory_order_relaxed);
+        while (ns > seen && !max_ns.compare_exchange_weak(seen, ns, std::memory_order_relaxed)) {}
+    }
+
+    Summary summary() const {
+        Summary result;
+        result.calls = calls.load(std::memory_order_relaxed);
+        result.total_ns = total_ns.load(std::memory_order_relaxed);
+        result.max_ns = max_ns.load(std::memory_order_relaxed);
+        result.allocations = allocations.load(std::memory_order_relaxed);
+        result.allocated_bytes = allocated_bytes.load(std::memory_order_relaxed);
+        result.p50_ns = std::min(percentile(0.50), result.max_ns);
+        result.p99_ns = std::min(percentile(0.99), result.max_ns);
+        return result;
+    }
+
+    void reset() {
+        for (auto& bucket : buckets) bucket.store(0, std::memory_order_relaxed);
+        calls = 0;
+        total_ns = 0;
+        max_ns = 0;
+        allocations = 0;
+        allocated_bytes = 0;
+    }
+
+    const std::string category;
+    const std::string name;
+
+private:
+    // Four buckets per power of two, bucket 4e + s holds [(4 + s) << (e - 2), (5 + s) << (e - 2))
+    static constexpr int BUCKETS = 64 * 4;
+
+    std::array<std::atomic<std::uint64_t>, BUCKETS> buckets{};
+    std::atomic<std::uint64_t> calls{0};
+    std::atomic<std::uint64_t> total_ns{0};
+    std::atomic<std::uint64_t> max_ns{0};
+    std::atomic<std::uint64_t> allocations{0};
+    std::atomic<std::uint64_t> allocated_bytes{0};
+
+    static int bucket_of(const std::uint64_t ns) {
+        if (ns < 4) return static_cast<int>(ns);
+        const int exponent = std::bit_width(ns) - 1;
+        return exponent * 4 + static_cast<int>((ns >> (exponent - 2)) & 3);
+    }
+
+    // Middle of a bucket, what a percentile falling into it reports
+    static std::uint64_t bucket_value(const int bucket) {
+        if (bucket < 4) return static_cast<std::uint64_t>(bucket);
+        const int exponent = bucket / 4;
+        const std::uint64_t low = static_cast<std::uint64_t>(4 + bucket % 4) << (exponent - 2);
+        return low + (std::uint64_t{1} << (exponent - 2)) / 2;
+    }
+
+    std::uint64_t percentile(const double fraction) const {
+        const std::uint64_t total = calls.load(std::memory_order_relaxed);
+        if (total == 0) return 0;
+        const auto rank = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(fraction * static_cast<double>(total) + 0.999));
+        // The slowest call is known exactly
+        if (rank >= total) return max_ns.load(std::memory_order_relaxed);
+        std::uint64_t seen = 0;
+        for (int b = 0; b < BUCKETS; b++) {
+            seen += buckets[b].load(std::memory_order_relaxed);
+            if (seen >= rank) return bucket_value(b);
+        }
+        return bucket_value(BUCKETS - 1);
+    }
+};
+
+namespace profiling {
+    // Collecting is off until `profile on`, a disabled scope or allocation costs one relaxed load
+    inline std::atomic<bool> enabled{false};
+
+    struct AllocationTotals {
+        std::uint64_t count = 0;
+        std::uint64_t bytes = 0;
+    };
+
+    // Process-wide allocation counters, sharded so threads allocating at once do not share a cache line
+    struct alignas(64) AllocationShard {
+        std::atomic<std::uint64_t> count{0};
+        std::atomic<std::uint64_t> bytes{0};
+    };
+
+    constexpr unsigned ALLOCATION_SHARDS = 16;
+    inline std::array<AllocationShard, ALLOCATION_SHARDS> allocation_shards;
+    inline std::atomic<unsigned> next_shard{0};
+
+    // Called by the replaced operator new for every allocation, must not allocate itself
+    inline void count_allocation(const std::size_t size) {
+        if (!enabled.load(std::memory_order_relaxed)) return;
+        thread_local const unsigned shard = next_shard.fetch_add(1, std::memory_order_relaxed) % ALLOCATION_SHARDS;
+        allocation_shards[shard].count.fetch_add(1, std::memory_order_relaxed);
+        allocation_shards[shard].bytes.fetch_add(size, std::memory_order_relaxed);
+    }
+
+    inline AllocationTotals allocation_totals() {
+        AllocationTotals totals;
+        for (const auto& shard : allocation_shards) {
+            totals.count += shard.count.load(std::memory_order_relaxed);
+            totals.bytes += shard.bytes.load(std::memory_order_relaxed);
+        }
+        return totals;
+    }
+
+    struct Registry {
+        std::mutex mutex;
+        // Keyed by category and name; sites are never removed, so references stay valid
+        std::map<std::pair<std::string, std::string>, std::unique_ptr<ProfileSite>> sites;
+    };
+
+    inline Registry& registry() {
+        static Registry instance;
+        return instance;
+    }
+}
+
+/**
+ * Site for a category ("command", "backend") and name, created on first use
+ * Look it up once and keep the reference (a function-local static), the lookup takes a lock
+ */
+inline ProfileSite& profile_site(const std::string& category, const std::string& name) {
+    auto& registry = profiling::registry();
+    std::lock_guard lock(registry.mutex);
+    auto& site = registry.sites[{category, name}];
+    if (!site) site = std::make_unique<ProfileSite>(category, name);
+    return *site;
+}
+
+// Every site ever used, ordered by category and name
+inline std::vector<const ProfileSite*> profile_sites() {
+    auto& registry = profiling::registry();
+    std::lock_guard lock(registry.mutex);
+    std::vector<const ProfileSite*> result;
+    result.reserve(registry.sites.size());
+    for (const auto& [key, site] : registry.sites) {
+        result.push_back(site.get());
+    }
+    return result;
+}
+
+inline void reset_profile() {
+    auto& registry = profiling::registry();
+    std::lock_guard lock(registry.mutex);
+    for (const auto& [key, site] : registry.sites) {
+        site->reset();
+    }
+}
+
+/**
+ * Times its own lifetime into a site, together with the allocations made meanwhile, and adds
+ * a span to the trace when tracing is on
+ * Allocation counts are process-wide: worker threads of the scope's kernel are included,
+ * and so is anything other threads allocate at the same time
+ */
+class ProfileScope {
+public:
+    explicit ProfileScope(ProfileSite& target)
+        : site(&target),
+          profiled(profiling::enabled.load(std::memory_order_relaxed)),
+          traced(tracing::enabled.load(std::memory_order_relaxed)) {
+        if (!profiled && !traced) return;
+        if (profiled) allocations = profiling::allocation_totals();
+        if (traced) {
+            parent = tracing::current_span;
+            tracing::current_span = site->name.c_str();
+        }
+        start_ns = tracing::now_ns();
+    }
+
+    ~ProfileScope() {
+        finish();
+    }
+
+    // Ends the scope before the end of its block, for a phase followed by more work
+    void finish() {
+        if (!profiled && !traced) return;
+        const std::uint64_t end_ns = tracing::now_ns();
+        if (profiled) {
+            const auto [count, bytes] = profiling::allocation_totals();
+            site->record(end_ns - start_ns, count - allocations.count, bytes - allocations.bytes);
+        }
+        if (traced) {
+            tracing::record(site->name.c_str(), site->category.c_str(), start_ns, end_ns);
+            tracing::current_span = parent;
+        }
+        profiled = false;
+        traced = false;
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    ProfileSite* site;
+    bool profiled;
+    bool traced;
+    const char* parent = nullptr;
+    profiling::AllocationTotals allocations;
+    std::uint64_t start_ns = 0;
+};
+
+#endif //PROFILER_H
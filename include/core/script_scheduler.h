@@ -0,0 +1,263 @@
+#ifndef SCRIPT_SCHEDULER_H
+#define SCRIPT_SCHEDULER_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <istream>
+#include <mutex>
+#include <queue>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "console.h"
+
+// Named resources (graph slots) a command line reads and writes
+struct CommandAccess {
+    std::vector<std::string> reads;
+    std::vector<std::string> writes;
+    // Touches something that is not a named resource, or leaves effects outside the process (shared memory,
+    // files): waits for all earlier lines, later ones wait for it
+    bool barrier = false;
+};
+
+/**
+ * Runs batch input like Console::run_batch, but lines that touch different resources at the same time
+ * Each line waits only for earlier lines it conflicts with (read after write, write after read or write),
+ * its output is buffered and printed in input order. The printed output and the effects outside the
+ * process match a sequential run; when a run is cut short, later independent lines may already have
+ * changed graphs in the workspace
+ */
+class ScriptScheduler {
+public:
+    using Analyzer = std::function<CommandAccess(const std::vector<std::string>&)>;
+
+    /**
+     * @param target Console whose commands are run
+     * @param analyzer Resources of a tokenized line, aliases are not resolved yet
+     * @param lines_at_once Lines running at the same time
+     */
+    ScriptScheduler(Console& target, Analyzer analyzer, const int lines_at_once)
+        : console(target), analyze(std::move(analyzer)), threads(std::max(1, lines_at_once)) {}
+
+    /**
+     * @param in Script file or piped stdin, '#' starts a comment line
+     * @param stop_on_error Nothing after the first failing line is printed, and no line is started once it
+     *        has failed; independent lines already running or done still change the workspace, barriers wait
+     *        for the failing line and never run
+     * @return Number of failures reported while running
+     */
+    int run(std::istream& in, const bool stop_on_error = false) {
+        console.start_batch();
+        stop_on_failure = stop_on_error;
+
+        // Lines are scheduled in windows, so a long pipe is not read up front; the workers serve every window
+        std::vector<std::string> lines;
+        std::string input;
+        bool more = true;
+        try {
+            while (more && console.is_running()) {
+                lines.clear();
+                while (lines.size() < WINDOW && (more = static_cast<bool>(std::getline(in, input)))) {
+                    if (!Console::is_blank_or_comment(input)) lines.push_back(input);
+                }
+                if (!run_window(lines)) break;
+            }
+        } catch (...) {
+            stop_workers();
+            throw;
+        }
+        stop_workers();
+
+        return console.failure_count();
+    }
+
+private:
+    static constexpr size_t WINDOW = 1024;
+
+    struct Step {
+        std::string input;
+        CommandAccess access;
+        std::vector<int> dependents;
+        int waiting = 0;
+        std::ostringstream output;
+        bool done = false;
+        bool failed = false;
+    };
+
+    Console& console;
+    Analyzer analyze;
+    int threads;
+    bool stop_on_failure = false;
+
+    // Window being run; steps is only resized while no line of it is queued or running
+    std::vector<Step> steps;
+    std::mutex mutex;
+    std::condition_variable changed;
+    // Lowest line first, so output can be printed as early as possible
+    std::priority_queue<int, std::vector<int>, std::greater<>> ready;
+    int active = 0;
+    // Lines after this one are not started once it is set, it is the failing or exiting line
+    int cut = 0;
+    bool stopping = false;
+    std::vector<std::thread> workers;
+
+    static void build_graph(std::vector<Step>& steps) {
+        std::unordered_map<std::string, int> last_writer;
+        std::unordered_map<std::string, std::vector<int>> readers;
+        int last_barrier = -1;
+
+        for (int i = 0; i < static_cast<int>(steps.size()); i++) {
+            const CommandAccess& access = steps[i].access;
+            std::vector<int> depends;
+
+            if (access.barrier) {
+                for (int j = std::max(0, last_barrier); j < i; j++) {
+                    depends.push_back(j);
+                }
+                last_barrier = i;
+                last_writer.clear();
+                readers.clear();
+            } else {
+                if (last_barrier >= 0) depends.push_back(last_barrier);
+                for (const auto& name : access.reads) {
+                    if (const auto it = last_writer.find(name); it != last_writer.end()) depends.push_back(it->second);
+                }
+                for (const auto& name : access.writes) {
+                    if (const auto it = last_writer.find(name); it != last_writer.end()) depends.push_back(it->second);
+                    const auto& previous = readers[name];
+                    depends.insert(depends.end(), previous.begin(), previous.end());
+                }
+
+                for (const auto& name : access.reads) {
+                    readers[name].push_back(i);
+                }
+                for (const auto& name : access.writes) {
+                    last_writer[name] = i;
+                    readers[name].clear();
+                }
+            }
+
+            std::sort(depends.begin(), depends.end());
+            depends.erase(std::unique(depends.begin(), depends.end()), depends.end());
+            for (const int j : depends) {
+                if (j == i) continue;
+                steps[j].dependents.push_back(i);
+                steps[i].waiting++;
+            }
+        }
+    }
+
+    void worker() {
+        std::unique_lock lock(mutex);
+        while (true) {
+            changed.wait(lock, [&] { return !ready.empty() || stopping; });
+            if (ready.empty()) return;
+
+            const int index = ready.top();
+            ready.pop();
+            if (index > cut) {
+                changed.notify_all();
+                continue;
+            }
+            active++;
+            lock.unlock();
+
+            Step& step = steps[index];
+            Console::redirect_output(&step.output);
+            try {
+                // Only a barrier runs alone, so only there the before-command hook is safe
+                step.failed = console.execute(step.input, step.access.barrier);
+            } catch (...) {
+                console.mark_failed();
+                step.failed = true;
+                step.output << "Unknown exception" << '\n';
+            }
+            Console::redirect_output(nullptr);
+
+            lock.lock();
+            step.done = true;
+            active--;
+            if ((step.failed && stop_on_failure) || !console.is_running()) {
+                cut = std::min(cut, index);
+            }
+            for (const int next : step.dependents) {
+                if (--steps[next].waiting == 0) ready.push(next);
+            }
+            changed.notify_all();
+        }
+    }
+
+    // Starts workers up to the thread limit, never more than a window has lines
+    void start_workers(const int wanted) {
+        const int target = std::min(threads, wanted);
+        while (static_cast<int>(workers.size()) < target) {
+            const int t = static_cast<int>(workers.size());
+            workers.emplace_back([this, t] {
+                tracing::name_thread("script " + std::to_string(t + 1));
+                worker();
+            });
+        }
+    }
+
+    void stop_workers() {
+        {
+            std::lock_guard lock(mutex);
+            stopping = true;
+        }
+        changed.notify_all();
+        for (auto& thread : workers) {
+            thread.join();
+        }
+        workers.clear();
+        std::lock_guard lock(mutex);
+        stopping = false;
+    }
+
+    // Returns false when the run has to stop (exit, or a failure with stop_on_error)
+    bool run_window(const std::vector<std::string>& lines) {
+        const int count = static_cast<int>(lines.size());
+        if (count == 0) return true;
+
+        std::vector<Step> window(count);
+        for (int i = 0; i < count; i++) {
+            window[i].input = lines[i];
+            const auto tokens = Console::tokenize(lines[i]);
+            window[i].access = analyze(tokens);
+        }
+        build_graph(window);
+
+        {
+            std::lock_guard lock(mutex);
+            steps = std::move(window);
+            active = 0;
+            cut = count;
+            for (int i = 0; i < count; i++) {
+                if (steps[i].waiting == 0) ready.push(i);
+            }
+        }
+        start_workers(count);
+        changed.notify_all();
+
+        bool keep_going = true;
+        for (int i = 0; i < count && keep_going; i++) {
+            std::unique_lock lock(mutex);
+            changed.wait(lock, [&] { return steps[i].done || (ready.empty() && active == 0); });
+            if (!steps[i].done) break;
+            keep_going = i < cut;
+            lock.unlock();
+
+            std::cout << steps[i].output.str();
+        }
+
+        // Lines past the cut may still be running; the window ends when nothing is queued or running
+        std::unique_lock lock(mutex);
+        changed.wait(lock, [&] { return ready.empty() && active == 0; });
+        return keep_going && console.is_running();
+    }
+};
+
+#endif //SCRIPT_SCHEDULER_H
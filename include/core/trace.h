@@ -0,0 +1,264 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * Timeline of spans (commands, kernel phases, worker tasks) for Chrome / Perfetto
+ * Each thread appends to its own fixed-size buffer with no lock; the buffers are
+ * read and written out as trace-event JSON after the session stops
+ */
+namespace tracing {
+    struct Event {
+        const char* name = nullptr;      // must outlive the session: literals or profile site names
+        const char* category = nullptr;
+        std::uint64_t start_ns = 0;
+        std::uint64_t duration_ns = 0;
+        int begin = -1;                  // row range of a worker task, -1 otherwise
+        int end = -1;
+    };
+
+    // Events kept per thread and session, later ones are counted as dropped
+    constexpr std::size_t BUFFER_EVENTS = 1 << 16;
+
+    struct ThreadBuffer {
+        // Allocated on the first event and never freed, a reader may still look at it; recycled with the buffer
+        std::unique_ptr<Event[]> events;
+        // Published with release after the event is written, read with acquire
+        std::atomic<std::size_t> count{0};
+        std::atomic<std::uint64_t> dropped{0};
+        // Session the events belong to; a buffer from an older session is reset by its own thread
+        std::atomic<std::uint64_t> session{0};
+        int id = 0;
+        std::string label;   // guarded by the registry mutex
+    };
+
+    inline std::atomic<bool> enabled{false};
+    inline std::atomic<std::uint64_t> session{0};
+    inline std::atomic<std::uint64_t> session_start_ns{0};
+
+    struct Registry {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+        // Buffers of exited threads, taken by the next thread that records; their events stay readable
+        std::vector<ThreadBuffer*> idle;
+    };
+
+    inline Registry& registry() {
+        static Registry instance;
+        return instance;
+    }
+
+    inline std::uint64_t now_ns() {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    /**
+     * Label and buffer of the calling thread, the buffer is only taken when the thread records an event
+     * and goes back to the registry when the thread exits, so buffers are bounded by the threads that
+     * trace at the same time. A track can therefore hold the events of several threads that ran one
+     * after another; it is shown under the label of the last one
+     */
+    struct ThreadSlot {
+        ThreadBuffer* buffer = nullptr;
+        std::string label;
+
+        ThreadSlot() = default;
+        ThreadSlot(const ThreadSlot&) = delete;
+        ThreadSlot& operator=(const ThreadSlot&) = delete;
+
+        ~ThreadSlot() {
+            if (buffer == nullptr) return;
+            auto& reg = registry();
+            std::lock_guard lock(reg.mutex);
+            reg.idle.push_back(buffer);
+        }
+    };
+
+    inline ThreadSlot& thread_slot() {
+        thread_local ThreadSlot slot;
+        return slot;
+    }
+
+    inline ThreadBuffer& thread_buffer() {
+        ThreadSlot& slot = thread_slot();
+        if (slot.buffer == nullptr) {
+            auto& reg = registry();
+            std::lock_guard lock(reg.mutex);
+            if (!reg.idle.empty()) {
+                slot.buffer = reg.idle.back();
+                reg.idle.pop_back();
+            } else {
+                auto& created = reg.buffers.emplace_back(std::make_unique<ThreadBuffer>());
+                created->id = static_cast<int>(reg.buffers.size());
+                slot.buffer = created.get();
+            }
+            slot.buffer->label = slot.label.empty() ? "thread " + std::to_string(slot.buffer->id) : slot.label;
+        }
+        return *slot.buffer;
+    }
+
+    // Name shown for the calling thread's track, e.g. "worker 2"; kept until the thread first records
+    inline void name_thread(const std::string& label) {
+        ThreadSlot& slot = thread_slot();
+        slot.label = label;
+        if (slot.buffer == nullptr) return;
+        std::lock_guard lock(registry().mutex);
+        slot.buffer->label = label;
+    }
+
+    inline void record(const char* name, const char* category, const std::uint64_t start_ns,
+                       const std::uint64_t end_ns, const int begin = -1, const int end = -1) {
+        ThreadBuffer& buffer = thread_buffer();
+        const std::uint64_t current = session.load(std::memory_order_acquire);
+        if (buffer.session.load(std::memory_order_relaxed) != current) {
+            if (!buffer.events) buffer.events = std::make_unique<Event[]>(BUFFER_EVENTS);
+            buffer.count.store(0, std::memory_order_relaxed);
+            buffer.dropped.store(0, std::memory_order_relaxed);
+            buffer.session.store(current, std::memory_order_release);
+        }
+
+        const std::size_t index = buffer.count.load(std::memory_order_relaxed);
+        if (index >= BUFFER_EVENTS) {
+            buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        buffer.events[index] = Event{name, category, start_ns, end_ns - start_ns, begin, end};
+        buffer.count.store(index + 1, std::memory_order_release);
+    }
+
+    // Innermost traced scope of this thread, names the worker tasks it starts
+    inline thread_local const char* current_span = nullptr;
+
+    // Starts a new session, events of earlier ones are discarded as threads record again
+    inline void start() {
+        session_start_ns.store(now_ns(), std::memory_order_relaxed);
+        session.fetch_add(1, std::memory_order_acq_rel);
+        enabled.store(true, std::memory_order_release);
+    }
+
+    inline void stop() {
+        enabled.store(false, std::memory_order_release);
+    }
+
+    struct Totals {
+        std::uint64_t events = 0;
+        std::uint64_t dropped = 0;
+        int threads = 0;
+    };
+
+    inline Totals totals() {
+        Totals result;
+        const std::uint64_t current = session.load(std::memory_order_acquire);
+        auto& reg = registry();
+        std::lock_guard lock(reg.mutex);
+        for (const auto& buffer : reg.buffers) {
+            if (buffer->session.load(std::memory_order_acquire) != current) continue;
+            result.events += buffer->count.load(std::memory_order_acquire);
+            result.dropped += buffer->dropped.load(std::memory_order_relaxed);
+            result.threads++;
+        }
+        return result;
+    }
+
+    inline void write_json_string(std::ostream& out, const std::string& text) {
+        out << '"';
+        for (const char c : text) {
+            if (c == '"' || c == '\\') out << '\\' << c;
+            else if (static_cast<unsigned char>(c) < 0x20) out << ' ';
+            else out << c;
+        }
+        out << '"';
+    }
+
+    /**
+     * Writes the current session in the Chrome trace-event format ("X" complete events plus thread names)
+     * @param out Destination, usually a .json file opened in chrome://tracing or ui.perfetto.dev
+     * @return Events written
+     */
+    inline std::uint64_t write_chrome_trace(std::ostream& out) {
+        const std::uint64_t current = session.load(std::memory_order_acquire);
+        const std::uint64_t origin = session_start_ns.load(std::memory_order_relaxed);
+        const auto micros = [](const std::uint64_t ns) {
+            return std::to_string(ns / 1000) + "." + std::to_string(ns % 1000 + 1000).substr(1);
+        };
+
+        std::uint64_t written = 0;
+        bool first = true;
+        out << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n";
+        auto& reg = registry();
+        std::lock_guard lock(reg.mutex);
+        for (const auto& buffer : reg.buffers) {
+            if (buffer->session.load(std::memory_order_acquire) != current) continue;
+            const std::size_t count = buffer->count.load(std::memory_order_acquire);
+
+            out << (first ? "" : ",\n") << R"({"ph": "M", "name": "thread_name", "pid": 1, "tid": )" << buffer->id
+                << R"(, "args": {"name": )";
+            write_json_string(out, buffer->label);
+            out << "}}";
+            first = false;
+
+            for (std::size_t i = 0; i < count; i++) {
+                const Event& event = buffer->events[i];
+                const std::uint64_t start = event.start_ns > origin ? event.start_ns - origin : 0;
+                out << ",\n{\"ph\": \"X\", \"name\": ";
+                write_json_string(out, event.name);
+                out << ", \"cat\": \"" << event.category << "\", \"pid\": 1, \"tid\": " << buffer->id
+                    << ", \"ts\": " << micros(start) << ", \"dur\": " << micros(event.duration_ns);
+                if (event.begin >= 0) {
+                    out << R"(, "args": {"rows": ")" << event.begin << ".." << event.end << "\"}";
+                }
+                out << "}";
+                written++;
+            }
+        }
+        out << "\n]}\n";
+        return written;
+    }
+
+    // Stops the session and writes it to path; false when the file cannot be written
+    inline bool save(const std::string& path, std::uint64_t& events) {
+        stop();
+        std::ofstream file(path);
+        if (!file.is_open()) return false;
+        events = write_chrome_trace(file);
+        return static_cast<bool>(file);
+    }
+}
+
+/**
+ * Span that only goes to the trace, for places too hot or too numerous for a profile site
+ * name and category must outlive the session
+ */
+class TraceSpan {
+public:
+    TraceSpan(const char* span_name, const char* span_category, const int row_begin = -1, const int row_end = -1)
+        : name(span_name), category(span_category), begin(row_begin), end(row_end),
+          start(tracing::enabled.load(std::memory_order_relaxed) ? tracing::now_ns() : 0) {}
+
+    ~TraceSpan() {
+        if (start != 0) tracing::record(name, category, start, tracing::now_ns(), begin, end);
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    const char* name;
+    const char* category;
+    int begin;
+    int end;
+    std::uint64_t start;
+};
+
+#endif //TRACE_H
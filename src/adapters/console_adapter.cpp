@@ -9,20 +9,50 @@
 #include <windows.h>
 #include <shlobj.h>
 #else
+#include <pwd.h>
 #include <unistd.h>
 #include <sys/ioctl.h>
 #include <stdio.h>
 #endif
 
 #include "../include/adapters/console_adapter.h"
+#include "../include/adapters/graph_server.h"
+#include "../include/backend/graph_closure.h"
+#include "../include/backend/graph_hash.h"
+#include "../include/backend/graph_reorder.h"
+#include "../include/backend/graph_spectral.h"
+#include "../include/backend/graph_triangles.h"
 #include "../include/backend/matrix_gen.h"
+#include "../include/backend/matrix_memory.h"
+#include "../include/backend/memory_budget.h"
+#include "../include/backend/op_planner.h"
+#include "../include/backend/parallel.h"
+#include "../include/backend/shared_store.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
 #include <filesystem>
 #include <fstream>
+#include <set>
+#include <thread>
 #include <utility>
 
 namespace fs = std::filesystem;
 
-GraphConsoleAdapter::GraphConsoleAdapter(const std::string& config_path, const std::string& aliases_path): graphs_created(false), graph1(nullptr), graph2(nullptr), graph(nullptr), n(0) {
+namespace {
+    // Nanoseconds with a unit that keeps three significant digits readable
+    std::string format_duration(const double ns) {
+        std::ostringstream text;
+        text << std::fixed << std::setprecision(1);
+        if (ns < 10'000) text << static_cast<long long>(ns) << " ns";
+        else if (ns < 10'000'000) text << ns / 1e3 << " us";
+        else if (ns < 10'000'000'000) text << ns / 1e6 << " ms";
+        else text << ns / 1e9 << " s";
+        return text.str();
+    }
+}
+
+GraphConsoleAdapter::GraphConsoleAdapter(const std::string& config_path, const std::string& aliases_path): lazy_mode(false) {
     // const std::string config_file = ("../../resources/config_files/graph_console.conf");
     // const std::string aliases_file = ("../../resources/config_files/aliases.conf");
 
@@ -55,6 +85,14 @@ GraphConsoleAdapter::GraphConsoleAdapter(const std::string& config_path, const s
 
     console.load_config(actual_config_path);
     console.load_aliases(actual_aliases_path);
+    results.set_budget(static_cast<size_t>(console.get_config().cache_budget_mb) << 20);
+    memory_budget = budget_from_megabytes(console.get_config().memory_budget_mb);
+    set_worker_processes(console.get_config().worker_processes);
+    set_thread_count(console.get_config().threads);
+    set_huge_pages(console.get_config().huge_pages);
+    profiling::enabled = console.get_config().profiling;
+    tracing::name_thread("console");
+    console.set_before_command([this] { this->report_finished_jobs(); });
 
     register_graph_commands();
 }
@@ -67,18 +105,330 @@ void GraphConsoleAdapter::run() {
     console.run();
 }
 
+int GraphConsoleAdapter::run_script(std::istream& in, const bool stop_on_error, const bool parallel) {
+    if (parallel) {
+        ScriptScheduler scheduler(console, [this](const std::vector<std::string>& tokens) {
+            return this->command_access(tokens);
+        }, hardware_threads());
+        scheduler.run(in, stop_on_error);
+    } else {
+        console.run_batch(in, stop_on_error);
+    }
+
+    // Jobs started with '&' still finish and report before the process exits
+    for (const auto& job : jobs.list()) {
+        while (!job->finished.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+    report_finished_jobs();
+
+    std::cout.flush();
+    return console.failure_count() == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int GraphConsoleAdapter::serve(const std::string& socket_path) {
+    console.start_batch();
+    GraphServer server(socket_path, [this](const std::string& line, std::string& output) {
+        return this->serve_request(line, output);
+    }, console.get_config().server_connections);
+    return server.run();
+}
+
+bool GraphConsoleAdapter::serve_request(const std::string& line, std::string& output) {
+    const auto tokens = Console::tokenize(line);
+    if (tokens.empty()) return false;
+
+    // Readers of a slot run side by side, a writer waits for them and runs alone on that slot
+    const CommandAccess access = command_access(tokens);
+    const auto guard = slot_locks.acquire(access);
+
+    std::ostringstream buffer;
+    Console::redirect_output(&buffer);
+    bool failed;
+    try {
+        failed = console.execute(line, access.barrier);
+    } catch (...) {
+        console.mark_failed();
+        buffer << "Unknown exception" << '\n';
+        failed = true;
+    }
+    Console::redirect_output(nullptr);
+
+    output = buffer.str();
+    return failed;
+}
+
+std::ostream& GraphConsoleAdapter::out() {
+    return Console::out();
+}
+
+std::ostream& GraphConsoleAdapter::fail() {
+    console.mark_failed();
+    return out();
+}
+
+CommandAccess GraphConsoleAdapter::command_access(const std::vector<std::string>& tokens) const {
+    CommandAccess access;
+    std::vector<std::string> args(tokens.begin() + 1, tokens.end());
+    const std::string command = console.resolve_command(tokens[0]);
+
+    // Jobs commit into their slot whenever they finish, the command line itself only orders them
+    if (split_background(args)) {
+        access.barrier = true;
+        return access;
+    }
+
+    if (command == "create") {
+        // The plain form replaces the whole workspace
+        const std::string destination = split_destination(args, "");
+        if (destination.empty()) access.barrier = true;
+        else access.writes = {destination};
+    } else if (command == "product" && console.get_config().out_of_core) {
+        // May spill to a file, which a run cut short by --fail-fast must not leave behind
+        access.barrier = true;
+    } else if (command == "union" || command == "intersect" || command == "ring" || command == "product") {
+        access.writes = {split_destination(args, "3")};
+        access.reads = args.size() >= 2 ? std::vector{args[0], args[1]} : std::vector<std::string>{"1", "2"};
+    } else if (command == "closure" || command == "copy" || command == "reorder") {
+        const std::string fallback = command == "closure" ? "3"
+            : command == "reorder" ? (args.empty() ? "" : args[0]) : args.size() > 1 ? args[1] : "";
+        access.writes = {split_destination(args, fallback)};
+        if (!args.empty()) access.reads = {args[0]};
+    } else if (command == "drop" || command == "identify" || command == "contract" || command == "split"
+               || command == "bfs" || command == "components" || command == "distance") {
+        // Traversals count as writes, they fill the connectivity cache of the slot
+        if (!args.empty()) access.writes = {args[0]};
+    } else if (command == "triangles" || command == "apsp" || command == "spectrum" || command == "pagerank"
+               || command == "neighbors") {
+        if (!args.empty()) access.reads = {args[0]};
+    } else if (command == "attach") {
+        if (!args.empty()) access.writes = {split_destination(args, default_attach_slot(args[0]))};
+    } else if (command == "print" || command == "hash") {
+        // Without names they cover every graph
+        if (args.empty()) access.barrier = true;
+        else access.reads = args;
+    } else {
+        // Settings, cache, jobs, listings, help, unknown commands, and publish/unpublish/save whose
+        // shared-memory objects and files outlive the process
+        access.barrier = true;
+    }
+    return access;
+}
+
 
 void GraphConsoleAdapter::cleanup() {
-    if (graph1 != nullptr) {
-        delete_graph(*graph1, graph1->n);
-        graph1.reset();
+    workspace.clear();
+    results.clear();
+}
+
+Graph* GraphConsoleAdapter::require_graph(const std::string& name) {
+    if (workspace.names().empty()) {
+        fail() << "No graphs created. Use 'create' command first." << '\n';
+        return nullptr;
+    }
+
+    // A pending result allocates here, results kept lazy over the budget are stopped again
+    if (workspace.is_pending(name)) {
+        const std::size_t predicted = predict_footprint(workspace.operand(name)).total();
+        if (!fits_budget(predicted)) {
+            fail() << "Graph " << name << " cannot be evaluated: " << over_budget(predicted) << '\n';
+            return nullptr;
+        }
+    }
+
+    // Out-of-core results have no matrix, only their lists can be read
+    if (const SharedDiskGraph disk = workspace.disk(name)) {
+        fail() << "Graph " << name << " is out-of-core (" << disk->path << "), only 'neighbors' reads it" << '\n';
+        return nullptr;
     }
-    if (graph2 != nullptr) {
-        delete_graph(*graph2, graph2->n);
-        graph2.reset();
+
+    Graph* target = workspace.get(name);
+    if (target == nullptr) {
+        fail() << "No such graph: " << name << '\n';
     }
-    n = 0;
-    graphs_created = false;
+    return target;
+}
+
+std::size_t GraphConsoleAdapter::budget_from_megabytes(const int megabytes) {
+    if (megabytes < 0) return 0;
+    if (megabytes > 0) return static_cast<std::size_t>(megabytes) << 20;
+    return physical_memory_bytes() / 4 * 3;
+}
+
+std::size_t GraphConsoleAdapter::memory_in_use() const {
+    return workspace.total_bytes() + results.exclusive() + reserved_bytes.load();
+}
+
+std::size_t GraphConsoleAdapter::memory_headroom() const {
+    const std::size_t limit = memory_budget.load();
+    if (limit == 0) return SIZE_MAX;
+    const std::size_t in_use = memory_in_use();
+    return in_use < limit ? limit - in_use : 0;
+}
+
+std::size_t GraphConsoleAdapter::spill_space() const {
+#ifdef _WIN32
+    return 0;
+#else
+    const ConsoleConfig& config = console.get_config();
+    if (!config.out_of_core) return 0;
+    std::error_code error;
+    const fs::path dir = config.spill_dir.empty() ? fs::temp_directory_path(error) : fs::path(config.spill_dir);
+    const fs::space_info space = fs::space(dir, error);
+    return error ? 0 : static_cast<std::size_t>(space.available);
+#endif
+}
+
+void GraphConsoleAdapter::set_worker_processes(const int processes) {
+#ifdef _WIN32
+    worker_processes = 0;
+#else
+    worker_processes = processes > 1 ? processes : 0;
+#endif
+}
+
+bool GraphConsoleAdapter::fits_budget(const std::size_t bytes, const std::size_t released) const {
+    const std::size_t limit = memory_budget.load();
+    if (limit == 0) return true;
+    const std::size_t in_use = memory_in_use();
+    return bytes <= limit && in_use - std::min(in_use, released) <= limit - bytes;
+}
+
+std::string GraphConsoleAdapter::over_budget(const std::size_t bytes) const {
+    return "needs about " + std::to_string((bytes >> 20) + 1) + " MB with " + std::to_string(memory_in_use() >> 20)
+        + " of " + std::to_string(memory_budget.load() >> 20) + " MB in use (see 'mem')";
+}
+
+std::string GraphConsoleAdapter::split_destination(std::vector<std::string>& args, const std::string& fallback) {
+    // "... -> name" names the slot that receives the result
+    if (args.size() >= 2 && args[args.size() - 2] == "->") {
+        std::string destination = args.back();
+        args.resize(args.size() - 2);
+        return destination;
+    }
+    return fallback;
+}
+
+bool GraphConsoleAdapter::split_background(std::vector<std::string>& args) {
+    // A trailing "&" runs the command as a background job
+    if (!args.empty() && args.back() == "&") {
+        args.pop_back();
+        return true;
+    }
+    return false;
+}
+
+void GraphConsoleAdapter::start_job(const std::string& command, std::function<SharedGraph()> work,
+                                    std::function<void(const SharedGraph&)> commit, const std::size_t reserve) {
+    // The reservation ends with the work, from then on the result is counted by its slot
+    reserved_bytes += reserve;
+    const int id = jobs.start(command,
+        [this, reserve, work = std::move(work)] {
+            struct Release {
+                std::atomic<std::size_t>& reserved;
+                std::size_t bytes;
+                ~Release() { reserved -= bytes; }
+            } release{reserved_bytes, reserve};
+            return work();
+        },
+        std::move(commit));
+    out() << "[" << id << "] " << command << '\n';
+}
+
+void GraphConsoleAdapter::report_finished_jobs() {
+    for (const auto& job : jobs.reap_finished()) {
+        if (job->cancelled) {
+            out() << "[" << job->id << "] Cancelled: " << job->command << '\n';
+        } else if (!job->error.empty()) {
+            fail() << "[" << job->id << "] Failed: " << job->command << ": " << job->error << '\n';
+        } else {
+            // Results only reach the workspace here, on the console thread
+            job->commit(job->result);
+            out() << "[" << job->id << "] Done: " << job->command << '\n';
+        }
+    }
+}
+
+void GraphConsoleAdapter::run_binary(std::vector<std::string> args, const GraphOp op) {
+    const bool background = split_background(args);
+    const std::string destination = split_destination(args, "3");
+    const std::string first = args.size() >= 2 ? args[0] : "1";
+    const std::string second = args.size() >= 2 ? args[1] : "2";
+    if (!workspace.contains(first) || !workspace.contains(second)) {
+        require_graph(workspace.contains(first) ? second : first);
+        return;
+    }
+
+    const ExprPtr lhs = workspace.operand(first);
+    const ExprPtr rhs = workspace.operand(second);
+    if (lhs == nullptr || rhs == nullptr) {
+        require_graph(lhs == nullptr ? first : second);
+        return;
+    }
+    const ExprPtr expr = expr_binary(op, lhs, rhs);
+
+    // In lazy mode only the expression grows, it is evaluated when the result is needed
+    if (lazy_mode && !background) {
+        workspace.put_pending(destination, expr);
+        return;
+    }
+
+    // Operands that have not changed since the last call give the same result
+    const bool leaves = expr->lhs->leaf != nullptr && expr->rhs->leaf != nullptr;
+    if (leaves) {
+        if (SharedGraph cached = results.find(op, expr->lhs->leaf->version, expr->rhs->leaf->version)) {
+            workspace.put(destination, std::move(cached));
+            return;
+        }
+    }
+
+    // Over the budget the result degrades to a spill file (products) or to what lazy mode would store;
+    // pending operands count as well
+    const OpPlan plan = plan_operation(expr, memory_headroom(), spill_space(), worker_processes.load());
+    const std::size_t predicted = plan.candidates.front().bytes;
+    if (plan.chosen == Strategy::LazyView) {
+        workspace.put_pending(destination, expr);
+        out() << "Graph " << destination << " kept lazy, evaluating it " << over_budget(predicted) << '\n';
+        return;
+    }
+    if (plan.chosen == Strategy::OutOfCore) {
+        const std::string dir = console.get_config().spill_dir;
+        if (background) {
+            // Jobs carry SharedGraph results, the mapped file travels beside it
+            auto written = std::make_shared<SharedDiskGraph>();
+            start_job(describe(expr) + " -> " + destination,
+                [expr, plan, dir, written] {
+                    *written = run_plan_out_of_core(plan, expr, dir);
+                    return SharedGraph{};
+                },
+                [this, written, destination](const SharedGraph&) { workspace.put_disk(destination, *written); },
+                plan.choice().bytes);
+            return;
+        }
+
+        const SharedDiskGraph result = run_plan_out_of_core(plan, expr, dir);
+        workspace.put_disk(destination, result);
+        out() << "Graph " << destination << " written out of core: " << result->n << " vertices, "
+              << result->entries << " list entries, " << (result->file_bytes >> 20) << " MB in " << result->path << '\n';
+        return;
+    }
+
+    // The job works on snapshots of the operands, later edits of the slots copy them first
+    if (background) {
+        start_job(describe(expr) + " -> " + destination,
+            [expr, plan] { return run_plan(plan, expr); },
+            [this, expr, leaves, op, destination](const SharedGraph& result) {
+                if (leaves) results.insert(op, expr->lhs->leaf->version, expr->rhs->leaf->version, result);
+                workspace.put(destination, result);
+            },
+            predicted);
+        return;
+    }
+
+    SharedGraph result = run_plan(plan, expr);
+    if (leaves) results.insert(op, expr->lhs->leaf->version, expr->rhs->leaf->version, result);
+    workspace.put(destination, std::move(result));
 }
 
 std::string GraphConsoleAdapter::find_config_file(const std::string &filename, const std::vector<std::string> &search_paths) {
@@ -108,17 +458,38 @@ std::string GraphConsoleAdapter::get_default_config_path() {
 #endif
 }
 
+
 void GraphConsoleAdapter::register_graph_commands() {
     console.register_command("create",
             [this](const std::vector<std::string>& args) { this->cmd_create(args); },
             "Create a new graph system",
             {"vertices", "edge_probability", "loop_probability"},
-            "create <n> <edgeProb> <loopProb>"
+            "create <n> <edgeProb> <loopProb> [-> name] [&]"
         );
 
     console.register_command("print",
-        [this](const std::vector<std::string>&) { this->cmd_print(); },
-        "Print current graph system"
+        [this](const std::vector<std::string>& args) { this->cmd_print(args); },
+        "Print current graph system",
+        {"graph"},
+        "print [graph]"
+    );
+
+    console.register_command("graphs",
+        [this](const std::vector<std::string>&) { this->cmd_graphs(); },
+        "List graphs in the workspace with their memory"
+    );
+
+    console.register_command("drop",
+        [this](const std::vector<std::string>& args) { this->cmd_drop(args); },
+        "Remove a graph from the workspace",
+        {"graph"}
+    );
+
+    console.register_command("copy",
+        [this](const std::vector<std::string>& args) { this->cmd_copy(args); },
+        "Copy a graph under another name",
+        {"graph", "name"},
+        "copy <graph> -> <name>"
     );
 
     console.register_command("clear",
@@ -134,40 +505,206 @@ void GraphConsoleAdapter::register_graph_commands() {
     console.register_command("identify",
         [this](const std::vector<std::string>& args) { this->cmd_identify(args); },
             "Identify two vertices of graph",
-            {"graphNum", "v", "u"}
+            {"graph", "v", "u"}
     );
 
     console.register_command("contract",
         [this](const std::vector<std::string>& args) { this->cmd_contract(args); },
         "Contract an edge between two vertices of graph",
-        {"graphNum", "v", "u"}
+        {"graph", "v", "u"}
     );
 
     console.register_command("split",
         [this](const std::vector<std::string>& args) { this->cmd_split(args); },
         "Split a vertex",
-        {"graphNum", "v"}
+        {"graph", "v"}
     );
 
     console.register_command("union",
-        [this](const std::vector<std::string>&) { this->cmd_union(); },
+        [this](const std::vector<std::string>& args) { this->cmd_union(args); },
         "Union graphs",
-        {"graph1", "graph2"}
+        {"graph1", "graph2"},
+        "union [graph graph] [-> name] [&]"
     );
 
     console.register_command("intersect",
-        [this](const std::vector<std::string>&) { this->cmd_intersection(); },
-        "Intersect graphs"
+        [this](const std::vector<std::string>& args) { this->cmd_intersection(args); },
+        "Intersect graphs",
+        {"graph1", "graph2"},
+        "intersect [graph graph] [-> name] [&]"
     );
 
     console.register_command("ring",
-        [this](const std::vector<std::string>&) { this->cmd_ring(); },
-        "Ring sum of graphs"
+        [this](const std::vector<std::string>& args) { this->cmd_ring(args); },
+        "Ring sum of graphs",
+        {"graph1", "graph2"},
+        "ring [graph graph] [-> name] [&]"
     );
 
     console.register_command("product",
-        [this](const std::vector<std::string>&) { this->cmd_cartesian(); },
-            "Cartesian product of graphs"
+        [this](const std::vector<std::string>& args) { this->cmd_cartesian(args); },
+        "Cartesian product of graphs",
+        {"graph1", "graph2"},
+        "product [graph graph] [-> name] [&]"
+    );
+
+    console.register_command("lazy",
+        [this](const std::vector<std::string>& args) { this->cmd_lazy(args); },
+        "Toggle lazy evaluation of graph operations",
+        {"on|off"},
+        "lazy [on|off]"
+    );
+
+    console.register_command("bfs",
+        [this](const std::vector<std::string>& args) { this->cmd_bfs(args); },
+        "Breadth-first search levels from a vertex",
+        {"graph", "source"}
+    );
+
+    console.register_command("components",
+        [this](const std::vector<std::string>& args) { this->cmd_components(args); },
+        "Connected components of graph",
+        {"graph"}
+    );
+
+    console.register_command("distance",
+        [this](const std::vector<std::string>& args) { this->cmd_distance(args); },
+        "Shortest path length between two vertices",
+        {"graph", "v", "u"}
+    );
+
+    console.register_command("reorder",
+        [this](const std::vector<std::string>& args) { this->cmd_reorder(args); },
+        "Renumber vertices by reverse Cuthill-McKee, degree or BFS order for locality, or restore the numbering",
+        {"graph", "rcm|degree|bfs|restore", "source"},
+        "reorder <graph> [rcm|degree|bfs [source]|restore] [-> name]"
+    );
+
+    console.register_command("triangles",
+        [this](const std::vector<std::string>& args) { this->cmd_triangles(args); },
+        "Triangle counts and clustering coefficients",
+        {"graph"}
+    );
+
+    console.register_command("closure",
+        [this](const std::vector<std::string>& args) { this->cmd_closure(args); },
+        "Transitive closure of graph",
+        {"graph"},
+        "closure <graph> [-> name] [&]"
+    );
+
+    console.register_command("apsp",
+        [this](const std::vector<std::string>& args) { this->cmd_apsp(args); },
+        "All-pairs shortest path lengths",
+        {"graph"}
+    );
+
+    console.register_command("spectrum",
+        [this](const std::vector<std::string>& args) { this->cmd_spectrum(args); },
+        "Largest adjacency eigenvalues (Lanczos)",
+        {"graph", "count"},
+        "spectrum <graph> [count]"
+    );
+
+    console.register_command("pagerank",
+        [this](const std::vector<std::string>& args) { this->cmd_pagerank(args); },
+        "PageRank scores of vertices",
+        {"graph", "damping"},
+        "pagerank <graph> [damping]"
+    );
+
+    console.register_command("hash",
+        [this](const std::vector<std::string>& args) { this->cmd_hash(args); },
+        "WL isomorphism hash and exact fingerprint of graphs",
+        {"graph"},
+        "hash [graph...]"
+    );
+
+    console.register_command("publish",
+        [this](const std::vector<std::string>& args) { this->cmd_publish(args); },
+        "Copy a graph into shared memory for other processes",
+        {"graph", "name"}
+    );
+
+    console.register_command("attach",
+        [this](const std::vector<std::string>& args) { this->cmd_attach(args); },
+        "Map a published graph read-only without copying its matrix",
+        {"name"},
+        "attach <name> [-> graph]"
+    );
+
+    console.register_command("unpublish",
+        [this](const std::vector<std::string>& args) { this->cmd_unpublish(args); },
+        "Remove a published graph, attached copies stay valid",
+        {"name"}
+    );
+
+    console.register_command("jobs",
+        [this](const std::vector<std::string>&) { this->cmd_jobs(); },
+        "List background jobs with their progress"
+    );
+
+    console.register_command("wait",
+        [this](const std::vector<std::string>& args) { this->cmd_wait(args); },
+        "Wait for a background job, or for all of them",
+        {"id"},
+        "wait [id]"
+    );
+
+    console.register_command("cancel",
+        [this](const std::vector<std::string>& args) { this->cmd_cancel(args); },
+        "Cancel a background job, its destination is left unchanged",
+        {"id"},
+        "cancel <id|all>"
+    );
+
+    console.register_command("profile",
+        [this](const std::vector<std::string>& args) { this->cmd_profile(args); },
+        "Show per-command and per-kernel latency and allocations, switch collecting or reset",
+        {"mode"},
+        "profile [on|off|reset]"
+    );
+
+    console.register_command("trace",
+        [this](const std::vector<std::string>& args) { this->cmd_trace(args); },
+        "Record commands, kernel phases and worker tasks as a Chrome/Perfetto trace",
+        {"mode", "file"},
+        "trace [start|stop <file>]"
+    );
+
+    console.register_command("cache",
+        [this](const std::vector<std::string>& args) { this->cmd_cache(args); },
+        "Show or clear cached operation results",
+        {"clear"},
+        "cache [clear]"
+    );
+
+    console.register_command("mem",
+        [this](const std::vector<std::string>& args) { this->cmd_mem(args); },
+        "Show memory by graph and representation, or set the memory budget",
+        {"budget", "MB|auto|off"},
+        "mem [budget <MB>|auto|off]"
+    );
+
+    console.register_command("processes",
+        [this](const std::vector<std::string>& args) { this->cmd_processes(args); },
+        "Split union, ring and product across forked worker processes instead of threads",
+        {"count|off"},
+        "processes [<count>|off]"
+    );
+
+    console.register_command("neighbors",
+        [this](const std::vector<std::string>& args) { this->cmd_neighbors(args); },
+        "List the neighbors of a vertex, also for out-of-core graphs",
+        {"graph", "vertex"},
+        "neighbors <graph> <vertex>"
+    );
+
+    console.register_command("explain",
+        [this](const std::vector<std::string>& args) { this->cmd_explain(args); },
+        "Show the time and memory estimate of an operation and the strategy it would use",
+        {"operation", "graph1", "graph2"},
+        "explain <union|intersect|ring|product> [graph1 graph2]"
     );
 
     // console.register_command("save",
@@ -203,69 +740,165 @@ void GraphConsoleAdapter::register_graph_commands() {
 }
 
 void GraphConsoleAdapter::cmd_create(const std::vector<std::string>& args) {
-    if (args.size() < 3) {
-        std::cout << "Usage: create <n> <edgeProb> <loopProb>" << std::endl;
+    std::vector<std::string> params = args;
+    const bool background = split_background(params);
+    const std::string destination = split_destination(params, "");
+
+    if (params.size() < 3) {
+        fail() << "Usage: create <n> <edgeProb> <loopProb> [-> name] [&]" << '\n';
         return;
     }
 
     try {
-        const int new_n = std::stoi(args[0]);
-        const double new_edge_prob = std::stod(args[1]);
-        const double new_loop_prob = std::stod(args[2]);
+        int new_n = 0;
+        double new_edge_prob = 0;
+        double new_loop_prob = 0;
+        if (!Console::parse_number(params[0], new_n) || !Console::parse_number(params[1], new_edge_prob)
+            || !Console::parse_number(params[2], new_loop_prob)) {
+            fail() << "Usage: create <vertices> <edge_probability> <loop_probability> [-> name] [&]" << '\n';
+            return;
+        }
 
         if (new_n <= 0) {
-            std::cout << "Invalid number of vertices." << std::endl;
+            fail() << "Invalid number of vertices." << '\n';
             return;
         }
         if (new_edge_prob <= 0 || new_edge_prob > 1 || new_loop_prob <= 0 || new_loop_prob > 1) {
-            std::cout << "Probabilities must be between 0 and 1" << std::endl;
+            fail() << "Probabilities must be between 0 and 1" << '\n';
             return;
         }
 
-        cleanup();
+        // The plain form frees the workspace first and builds two graphs
+        const bool plain = destination.empty() && !background;
+        const std::size_t per_graph = predict_create_footprint(new_n, new_edge_prob).total();
+        const std::size_t predicted = per_graph * (destination.empty() ? 2 : 1);
+        if (!fits_budget(predicted, plain ? memory_in_use() : 0)) {
+            fail() << "Cannot create " << (destination.empty() ? "graphs" : "graph " + destination) << ": "
+                   << over_budget(predicted) << '\n';
+            return;
+        }
 
-        n = new_n;
-        graph1 = std::make_unique<Graph>(create_graph(n, new_edge_prob, new_loop_prob, 0));
-        graph2 = std::make_unique<Graph>(create_graph(n, new_edge_prob, new_loop_prob, 0));
-        graphs_created = true;
+        // In the background the workspace is not reset, graphs 1 and 2 are just replaced
+        if (background) {
+            for (const std::string& name : destination.empty() ? std::vector<std::string>{"1", "2"} : std::vector{destination}) {
+                start_job("create " + params[0] + " " + params[1] + " " + params[2] + " -> " + name,
+                    [new_n, new_edge_prob, new_loop_prob] {
+                        return make_shared_graph(create_graph(new_n, new_edge_prob, new_loop_prob, 0));
+                    },
+                    [this, name](const SharedGraph& result) { workspace.put(name, result); },
+                    per_graph);
+            }
+            return;
+        }
 
-        std::cout << "Created two graphs with " << n << " vertices" << std::endl;
-        std::cout << "  Edge probability: " << new_edge_prob << ", Loop probability: " << new_loop_prob << std::endl;
+        // A named graph joins the workspace, the plain form starts over with graphs 1 and 2
+        if (!destination.empty()) {
+            workspace.put(destination, make_shared_graph(create_graph(new_n, new_edge_prob, new_loop_prob, 0)));
+            out() << "Created graph " << destination << " with " << new_n << " vertices" << '\n';
+        } else {
+            cleanup();
+            workspace.put("1", make_shared_graph(create_graph(new_n, new_edge_prob, new_loop_prob, 0)));
+            workspace.put("2", make_shared_graph(create_graph(new_n, new_edge_prob, new_loop_prob, 0)));
+            out() << "Created two graphs with " << new_n << " vertices" << '\n';
+        }
+        out() << "  Edge probability: " << new_edge_prob << ", Loop probability: " << new_loop_prob << '\n';
 
     } catch (const std::exception& e) {
-        std::cout << "Error creating graphs: " << e.what() << std::endl;
-        std::cout << "Usage: create <vertices> <edge_probability> <loop_probability>" << std::endl;
+        fail() << "Error creating graphs: " << e.what() << '\n';
+        fail() << "Usage: create <vertices> <edge_probability> <loop_probability> [-> name]" << '\n';
+    }
+}
+
+void GraphConsoleAdapter::cmd_print(const std::vector<std::string>& args) {
+    const std::vector<std::string> names = args.empty() ? workspace.names() : args;
+    if (names.empty()) {
+        fail() << "No graphs created. Use 'create' command first." << '\n';
+        return;
+    }
+
+    for (const auto& name : names) {
+        const Graph* target = require_graph(name);
+        if (target == nullptr) continue;
+
+        out() << "=== GRAPH " << name << " ===" << '\n';
+        print_matrix(target->adj_matrix, target->n, target->n, ("Adjacency Matrix " + name).c_str(), out());
+        print_list(target->adj_list, ("Adjacency List " + name).c_str(), out());
     }
 }
 
-void GraphConsoleAdapter::cmd_print() const {
-    if (!graphs_created) {
-        std::cout << "No graphs created. Use 'create' command first." << std::endl;
+void GraphConsoleAdapter::cmd_graphs() {
+    const auto names = workspace.names();
+    if (names.empty()) {
+        fail() << "No graphs created. Use 'create' command first." << '\n';
         return;
     }
 
-    std::cout << "=== GRAPH 1 ===" << std::endl;
-    print_matrix(graph1->adj_matrix, graph1->n, graph1->n, "Adjacency Matrix 1");
-    print_list(graph1->adj_list, "Adjacency List 1");
+    out() << "Graphs:" << '\n';
+    for (const auto& name : names) {
+        out() << "  " << std::setw(8) << std::left << name << std::right;
+        if (workspace.is_pending(name)) {
+            const ExprPtr expr = workspace.operand(name);
+            out() << " lazy " << describe(expr) << " (" << expr->n << " vertices)" << '\n';
+            continue;
+        }
+        if (const SharedDiskGraph disk = workspace.disk(name)) {
+            out() << " out-of-core " << disk->n << " vertices, " << disk->entries << " list entries, "
+                  << (disk->file_bytes >> 10) << " KB on disk" << '\n';
+            continue;
+        }
+        const Graph* target = workspace.get(name);
+        out() << " " << target->n << " vertices, " << count_list_entries(*target) << " list entries, "
+                  << (workspace.bytes(name) >> 10) << " KB" << '\n';
+    }
+    out() << "Total: " << (workspace.total_bytes() >> 10) << " KB, cache "
+              << (results.used() >> 10) << " KB" << '\n';
+}
 
-    std::cout << "=== GRAPH 2 ===" << std::endl;
-    print_matrix(graph2->adj_matrix, graph2->n, graph2->n, "Adjacency Matrix 2");
-    print_list(graph2->adj_list, "Adjacency List 2");
+void GraphConsoleAdapter::cmd_drop(const std::vector<std::string>& args) {
+    if (args.empty()) {
+        fail() << "Usage: drop <graph>" << '\n';
+        return;
+    }
 
-    if (graph) {
-        std::cout << "=== GRAPH 3 ===" << std::endl;
-        print_matrix(graph->adj_matrix, graph->n, graph->n, "Adjacency Matrix 3");
-        print_list(graph->adj_list, "Adjacency List 3");
+    if (workspace.erase(args[0])) {
+        out() << "Dropped graph " << args[0] << '\n';
+    } else {
+        fail() << "No such graph: " << args[0] << '\n';
     }
 }
 
+void GraphConsoleAdapter::cmd_copy(const std::vector<std::string>& args) {
+    std::vector<std::string> params = args;
+    const std::string destination = split_destination(params, params.size() > 1 ? params[1] : "");
+    if (params.empty() || destination.empty()) {
+        fail() << "Usage: copy <graph> -> <name>" << '\n';
+        return;
+    }
+
+    // Slots share the graph until one of them is edited
+    const ExprPtr source = workspace.operand(params[0]);
+    if (const SharedDiskGraph disk = workspace.disk(params[0])) {
+        workspace.put_disk(destination, disk);
+    } else if (source == nullptr) {
+        require_graph(params[0]);
+        return;
+    } else if (workspace.is_pending(params[0])) {
+        workspace.put_pending(destination, source);
+    } else {
+        const std::vector<int> labels = *workspace.labels(params[0]);
+        workspace.put(destination, source->owned);
+        *workspace.labels(destination) = labels;
+    }
+    out() << "Copied graph " << params[0] << " to " << destination << '\n';
+}
+
 void GraphConsoleAdapter::cmd_clear() {
     console.clear_screen();
 }
 
 void GraphConsoleAdapter::cmd_cleanup() {
     cleanup();
-    std::cout << "Graph system cleaned up" << std::endl;
+    out() << "Graph system cleaned up" << '\n';
 }
 
 void GraphConsoleAdapter::cmd_exit() {
@@ -285,160 +918,932 @@ void GraphConsoleAdapter::cmd_history() {
     console.show_history();
 }
 
-void GraphConsoleAdapter::cmd_identify(const std::vector<std::string> &args) const {
-    if (!graphs_created) {
-        std::cout << "No graphs created. Use 'create' command first." << std::endl;
+void GraphConsoleAdapter::cmd_identify(const std::vector<std::string> &args) {
+    if (args.size() < 3) {
+        fail() << "Usage: identify <graph> <v> <u>" << '\n';
         return;
     }
 
+    try {
+        int v = 0;
+        int u = 0;
+        if (!Console::parse_number(args[1], v) || !Console::parse_number(args[2], u)) {
+            fail() << "Usage: identify <graph> <v> <u>" << '\n';
+            return;
+        }
+        if (require_graph(args[0]) == nullptr) return;
+        Graph* target = workspace.get_for_write(args[0]);
+        if (v >= target->n || v < 0 || u >= target->n || u < 0 || v == u) {
+            fail() << "Invalid vertice number" << '\n';
+            return;
+        }
+        const int old_n = target->n;
+        identify_vertices(*target, v, u);
+        if (target->n != old_n) {
+            on_vertices_merged(*workspace.cache(args[0]), std::min(v, u), std::max(v, u));
+            labels_after_merge(*workspace.labels(args[0]), std::max(v, u));
+        }
+        if (console.is_interactive()) cmd_print({});
+    } catch (const std::exception& e) {
+        fail() << "Error identifying vertices: " << e.what() << '\n';
+    }
+}
+
+void GraphConsoleAdapter::cmd_contract(const std::vector<std::string> &args) {
     if (args.size() < 3) {
-        std::cout << "Usage: identify <graphNum> <v> <u>" << std::endl;
+        fail() << "Usage: contract <graph> <v> <u>" << '\n';
         return;
     }
 
     try {
-        const auto graphNum = std::stoi(args[0]);
-        const auto v = stoi(args[1]);
-        const auto u = stoi(args[2]);
-        Graph* target = nullptr;
-        if (graphNum == 1) target = graph1.get();
-        else if (graphNum == 2) target = graph2.get();
-        else {
-            std::cout << "Invalid graph number (must be 1 or 2)" << std::endl;
+        int v = 0;
+        int u = 0;
+        if (!Console::parse_number(args[1], v) || !Console::parse_number(args[2], u)) {
+            fail() << "Usage: contract <graph> <v> <u>" << '\n';
             return;
         }
-        if (v > target->n || v < 0 || u > target->n || u < 0 || v == u) {
-            std::cout << "Invalid vertice number" << std::endl;
+        if (require_graph(args[0]) == nullptr) return;
+        Graph* target = workspace.get_for_write(args[0]);
+        if (v >= target->n || v < 0 || u >= target->n || u < 0 || v == u) {
+            fail() << "Invalid vertice number" << '\n';
             return;
         }
-        identify_vertices(*target, v, u);
-        cmd_print();
+        if (!contract_edge(*target, v, u)) {
+            fail() << "No such edge" << '\n';
+            return;
+        }
+        on_vertices_merged(*workspace.cache(args[0]), std::min(v, u), std::max(v, u));
+        labels_after_merge(*workspace.labels(args[0]), std::max(v, u));
+        if (console.is_interactive()) cmd_print({});
+    } catch (const std::exception& e) {
+        fail() << "Error contracting edge: " << e.what() << '\n';
+    }
+}
+
+void GraphConsoleAdapter::cmd_split(const std::vector<std::string> &args) {
+    if (args.size() < 2) {
+        fail() << "Usage: split <graph> <v>" << '\n';
+        return;
+    }
+
+    try {
+        int v = 0;
+        if (!Console::parse_number(args[1], v)) {
+            fail() << "Usage: split <graph> <v>" << '\n';
+            return;
+        }
+        if (require_graph(args[0]) == nullptr) return;
+        Graph* target = workspace.get_for_write(args[0]);
+        if (v >= target->n || v < 0) {
+            fail() << "Invalid vertice number" << '\n';
+            return;
+        }
+        const int old_n = target->n;
+        split_vertex(*target, v, get_neighbors(*target, v));
+        if (target->n != old_n) {
+            on_vertex_split(*workspace.cache(args[0]), v);
+            labels_after_split(*workspace.labels(args[0]));
+        }
+        if (console.is_interactive()) cmd_print({});
+    } catch (const std::exception& e) {
+        fail() << "Error splitting vertex: " << e.what() << '\n';
+    }
+}
+
+void GraphConsoleAdapter::cmd_union(const std::vector<std::string> &args) {
+    try {
+        run_binary(args, GraphOp::Union);
+    } catch (const std::exception& e) {
+        fail() << "Error while union: " << e.what() << '\n';
+    }
+}
+
+void GraphConsoleAdapter::cmd_intersection(const std::vector<std::string> &args) {
+    try {
+        run_binary(args, GraphOp::Intersection);
+    } catch (const std::exception& e) {
+        fail() << "Error while intersection: " << e.what() << '\n';
+    }
+}
+
+void GraphConsoleAdapter::cmd_ring(const std::vector<std::string> &args) {
+    try {
+        run_binary(args, GraphOp::RingSum);
+    } catch (const std::exception& e) {
+        fail() << "Error while ring sum: " << e.what() << '\n';
+    }
+}
+
+void GraphConsoleAdapter::cmd_cartesian(const std::vector<std::string> &args) {
+    try {
+        run_binary(args, GraphOp::CartesianProduct);
     } catch (const std::exception& e) {
-        std::cout << "Error identifying vertices: " << e.what() << std::endl;
+        fail() << "Error while production: " << e.what() << '\n';
     }
 }
 
-void GraphConsoleAdapter::cmd_contract(const std::vector<std::string> &args) const {
-    if (!graphs_created) {
-        std::cout << "No graphs created. Use 'create' command first." << std::endl;
+void GraphConsoleAdapter::cmd_bfs(const std::vector<std::string> &args) {
+    if (args.size() < 2) {
+        fail() << "Usage: bfs <graph> <source>" << '\n';
         return;
     }
 
+    try {
+        int source = 0;
+        if (!Console::parse_number(args[1], source)) {
+            fail() << "Usage: bfs <graph> <source>" << '\n';
+            return;
+        }
+        const Graph* target = require_graph(args[0]);
+        if (target == nullptr) return;
+        if (source >= target->n || source < 0) {
+            fail() << "Invalid vertice number" << '\n';
+            return;
+        }
+
+        auto& cache = *workspace.cache(args[0]);
+        auto it = cache.bfs_by_source.find(source);
+        if (it == cache.bfs_by_source.end()) {
+            it = cache.bfs_by_source.emplace(source, bfs(*target, source)).first;
+        }
+        const BfsResult& result = it->second;
+
+        std::vector<std::vector<int>> levels;
+        int reached = 0;
+        for (int i = 0; i < target->n; i++) {
+            if (result.dist[i] < 0) continue;
+            if (result.dist[i] >= static_cast<int>(levels.size())) levels.resize(result.dist[i] + 1);
+            levels[result.dist[i]].push_back(i);
+            reached++;
+        }
+
+        out() << "BFS from " << source << ":" << '\n';
+        for (size_t level = 0; level < levels.size(); level++) {
+            out() << "  level " << level << ": ";
+            for (const int v : levels[level]) {
+                out() << v << " ";
+            }
+            out() << '\n';
+        }
+        out() << "Reached " << reached << " of " << target->n << " vertices" << '\n';
+    } catch (const std::exception& e) {
+        fail() << "Error while bfs: " << e.what() << '\n';
+    }
+}
+
+void GraphConsoleAdapter::cmd_components(const std::vector<std::string> &args) {
+    if (args.empty()) {
+        fail() << "Usage: components <graph>" << '\n';
+        return;
+    }
+
+    try {
+        const Graph* target = require_graph(args[0]);
+        if (target == nullptr) return;
+
+        auto& cache = *workspace.cache(args[0]);
+        if (!cache.components_valid) {
+            cache.components = connected_components(*target);
+            cache.components_valid = true;
+        }
+        const ComponentsResult& result = cache.components;
+
+        std::vector<std::vector<int>> members(result.count);
+        for (int i = 0; i < target->n; i++) {
+            members[result.label[i]].push_back(i);
+        }
+
+        out() << "Connected components: " << result.count << '\n';
+        for (int c = 0; c < result.count; c++) {
+            out() << "  " << c << ": ";
+            for (const int v : members[c]) {
+                out() << v << " ";
+            }
+            out() << '\n';
+        }
+    } catch (const std::exception& e) {
+        fail() << "Error while components: " << e.what() << '\n';
+    }
+}
+
+void GraphConsoleAdapter::cmd_distance(const std::vector<std::string> &args) {
     if (args.size() < 3) {
-        std::cout << "Usage: contract <graphNum> <v> <u>" << std::endl;
+        fail() << "Usage: distance <graph> <v> <u>" << '\n';
         return;
     }
 
     try {
-        const auto graphNum = std::stoi(args[0]);
-        const auto v = stoi(args[1]);
-        const auto u = stoi(args[2]);
-        Graph* target = nullptr;
-        if (graphNum == 1) target = graph1.get();
-        else if (graphNum == 2) target = graph2.get();
-        else {
-            std::cout << "Invalid graph number (must be 1 or 2)" << std::endl;
+        int v = 0;
+        int u = 0;
+        if (!Console::parse_number(args[1], v) || !Console::parse_number(args[2], u)) {
+            fail() << "Usage: distance <graph> <v> <u>" << '\n';
+            return;
+        }
+        const Graph* target = require_graph(args[0]);
+        if (target == nullptr) return;
+        if (v >= target->n || v < 0 || u >= target->n || u < 0) {
+            fail() << "Invalid vertice number" << '\n';
             return;
         }
-        if (v > target->n || v < 0 || u > target->n || u < 0 || v == u) {
-            std::cout << "Invalid vertice number" << std::endl;
+
+        // Different components are never connected, no need to search
+        auto& cache = *workspace.cache(args[0]);
+        if (cache.components_valid && cache.components.label[v] != cache.components.label[u]) {
+            out() << "Vertex " << u << " is unreachable from " << v << '\n';
             return;
         }
-        contract_edge(*target, v, u);
-        cmd_print();
+
+        auto it = cache.bfs_by_source.find(v);
+        if (it == cache.bfs_by_source.end()) {
+            it = cache.bfs_by_source.emplace(v, bfs(*target, v)).first;
+        }
+
+        if (const int d = it->second.dist[u]; d < 0) {
+            out() << "Vertex " << u << " is unreachable from " << v << '\n';
+        } else {
+            out() << "Distance from " << v << " to " << u << ": " << d << '\n';
+        }
     } catch (const std::exception& e) {
-        std::cout << "Error identifying vertices: " << e.what() << std::endl;
+        fail() << "Error while distance: " << e.what() << '\n';
     }
 }
 
-void GraphConsoleAdapter::cmd_split(const std::vector<std::string> &args) const {
-    if (!graphs_created) {
-        std::cout << "No graphs created. Use 'create' command first." << std::endl;
+void GraphConsoleAdapter::cmd_reorder(const std::vector<std::string> &args) {
+    std::vector<std::string> params = args;
+    const std::string destination = split_destination(params, params.empty() ? "" : params[0]);
+    VertexOrder order = VertexOrder::ReverseCuthillMcKee;
+    int source = 0;
+    const bool restore = params.size() == 2 && params[1] == "restore";
+    if (params.empty() || params.size() > 3 || (params.size() >= 2 && !restore && !parse_vertex_order(params[1], order))
+        || (params.size() == 3 && (order != VertexOrder::Bfs || !Console::parse_number(params[2], source)))) {
+        fail() << "Usage: reorder <graph> [rcm|degree|bfs [source]|restore] [-> name]" << '\n';
         return;
     }
 
-    if (args.size() < 2) {
-        std::cout << "Usage: split <graphNum> <v>" << std::endl;
+    try {
+        const Graph* target = require_graph(params[0]);
+        if (target == nullptr) return;
+        const std::vector<int> labels = *workspace.labels(params[0]);
+
+        // Without a method only the state of the numbering is shown
+        if (params.size() == 1) {
+            out() << "Graph " << params[0] << ": bandwidth " << graph_bandwidth(*target) << ", "
+                  << (labels.empty() ? "original numbering" : "reordered") << '\n';
+            if (!labels.empty()) {
+                out() << "  Original numbers (-1 = added later):";
+                for (const int label : labels) out() << ' ' << label;
+                out() << '\n';
+            }
+            return;
+        }
+        if (restore && labels.empty()) {
+            out() << "Graph " << params[0] << " already has its original numbering" << '\n';
+            return;
+        }
+        if (!fits_budget(graph_bytes(*target))) {
+            fail() << "Cannot reorder graph " << params[0] << ": " << over_budget(graph_bytes(*target)) << '\n';
+            return;
+        }
+        if (source < 0 || source >= std::max(target->n, 1)) {
+            fail() << "Invalid vertice number" << '\n';
+            return;
+        }
+
+        const std::vector<int> permutation = restore ? restore_order(labels) : vertex_order(*target, order, source);
+        const int before = graph_bandwidth(*target);
+        SharedGraph result = make_shared_graph(permute_graph(*target, permutation));
+        const int after = graph_bandwidth(*result);
+        workspace.put(destination, std::move(result));
+
+        // Labels are dropped only when every vertex is back at its own number; after a merge or split
+        // the restored graph keeps them, so vertices removed or added since stay visible
+        std::vector<int> composed = compose_labels(labels, permutation);
+        bool original = true;
+        for (std::size_t v = 0; v < composed.size() && original; v++) {
+            original = composed[v] == static_cast<int>(v);
+        }
+        if (original) composed.clear();
+        *workspace.labels(destination) = std::move(composed);
+        out() << "Graph " << destination << (restore ? " restored" : std::string(" reordered by ") + vertex_order_name(order))
+              << ": bandwidth " << before << " -> " << after << '\n';
+    } catch (const std::exception& e) {
+        fail() << "Error reordering graph: " << e.what() << '\n';
+    }
+}
+
+void GraphConsoleAdapter::cmd_triangles(const std::vector<std::string> &args) {
+    if (args.empty()) {
+        fail() << "Usage: triangles <graph>" << '\n';
         return;
     }
 
     try {
-        const auto graphNum = std::stoi(args[0]);
-        const auto v = stoi(args[1]);
-        Graph* target = nullptr;
-        if (graphNum == 1) target = graph1.get();
-        else if (graphNum == 2) target = graph2.get();
-        else {
-            std::cout << "Invalid graph number (must be 1 or 2)" << std::endl;
+        const Graph* target = require_graph(args[0]);
+        if (target == nullptr) return;
+
+        const TriangleResult result = count_triangles(*target);
+
+        out() << "Triangles: " << result.total << '\n';
+        out() << "  Average clustering: " << result.average_clustering
+                  << ", Transitivity: " << result.transitivity << '\n';
+        for (int v = 0; v < target->n; v++) {
+            out() << "  " << v << ": " << result.per_vertex[v]
+                      << " triangles, clustering " << result.clustering[v] << '\n';
+        }
+    } catch (const std::exception& e) {
+        fail() << "Error while triangles: " << e.what() << '\n';
+    }
+}
+
+void GraphConsoleAdapter::cmd_closure(const std::vector<std::string> &args) {
+    std::vector<std::string> params = args;
+    const bool background = split_background(params);
+    const std::string destination = split_destination(params, "3");
+    if (params.empty()) {
+        fail() << "Usage: closure <graph> [-> name] [&]" << '\n';
+        return;
+    }
+
+    try {
+        const ExprPtr source = workspace.operand(params[0]);
+        if (source == nullptr) {
+            require_graph(params[0]);
             return;
         }
-        if (v > target->n || v < 0) {
-            std::cout << "Invalid vertice number" << std::endl;
+
+        // The closure may be dense whatever the operand looks like
+        const std::size_t predicted = predict_footprint(source).total() + predict_create_footprint(source->n, 1.0).total();
+        if (!fits_budget(predicted)) {
+            fail() << "Cannot compute the closure of " << params[0] << ": " << over_budget(predicted) << '\n';
             return;
         }
-        split_vertex(*target, v, get_neighbors(*target, v));
-        cmd_print();
+
+        if (background) {
+            start_job("closure " + params[0] + " -> " + destination,
+                [source] {
+                    if (source->leaf != nullptr) return make_shared_graph(transitive_closure(*source->leaf));
+                    Graph operand = evaluate(source);
+                    GraphBuildGuard guard(operand);
+                    Graph closure = transitive_closure(operand);
+                    delete_graph(operand, operand.n);
+                    return make_shared_graph(std::move(closure));
+                },
+                [this, destination](const SharedGraph& result) { workspace.put(destination, result); },
+                predicted);
+            return;
+        }
+
+        const Graph* target = require_graph(params[0]);
+        if (target == nullptr) return;
+
+        SharedGraph result = make_shared_graph(transitive_closure(*target));
+        const long long pairs = count_list_entries(*result);
+        workspace.put(destination, std::move(result));
+
+        out() << "Transitive closure stored as graph " << destination << ": "
+                  << pairs << " reachable pairs" << '\n';
+    } catch (const std::exception& e) {
+        fail() << "Error while closure: " << e.what() << '\n';
+    }
+}
+
+void GraphConsoleAdapter::cmd_apsp(const std::vector<std::string> &args) {
+    if (args.empty()) {
+        fail() << "Usage: apsp <graph>" << '\n';
+        return;
+    }
+
+    try {
+        const Graph* target = require_graph(args[0]);
+        if (target == nullptr) return;
+
+        const std::vector<int> dist = all_pairs_distances(*target);
+        out() << "Distances (-1 = unreachable):" << '\n';
+        for (int i = 0; i < target->n; i++) {
+            for (int j = 0; j < target->n; j++) {
+                out() << std::setw(2) << dist[static_cast<size_t>(i) * target->n + j] << " ";
+            }
+            out() << '\n';
+        }
     } catch (const std::exception& e) {
-        std::cout << "Error identifying vertices: " << e.what() << std::endl;
+        fail() << "Error while apsp: " << e.what() << '\n';
     }
 }
 
-void GraphConsoleAdapter::cmd_union() {
-    if (!graphs_created) {
-        std::cout << "No graphs created. Use 'create' command first." << std::endl;
+void GraphConsoleAdapter::cmd_spectrum(const std::vector<std::string> &args) {
+    if (args.empty()) {
+        fail() << "Usage: spectrum <graph> [count]" << '\n';
         return;
     }
 
     try {
-        const auto source_1 = graph1.get();
-        const auto source_2 = graph2.get();
-        GraphConsoleAdapter::graph = std::make_unique<Graph>(graph_union(*source_1, *source_2));
+        int count = 5;
+        if (args.size() > 1 && !Console::parse_number(args[1], count)) {
+            fail() << "Usage: spectrum <graph> [count]" << '\n';
+            return;
+        }
+        const Graph* target = require_graph(args[0]);
+        if (target == nullptr) return;
+        if (count <= 0) {
+            fail() << "Count must be positive" << '\n';
+            return;
+        }
+
+        const std::vector<double> values = adjacency_spectrum(*target, count);
+        out() << "Largest eigenvalues:" << '\n';
+        for (size_t i = 0; i < values.size(); i++) {
+            out() << "  " << (i + 1) << ": " << values[i] << '\n';
+        }
     } catch (const std::exception& e) {
-        std::cout << "Error while union: " << e.what() << std::endl;
+        fail() << "Error while spectrum: " << e.what() << '\n';
     }
 }
 
-void GraphConsoleAdapter::cmd_intersection() {
-    if (!graphs_created) {
-        std::cout << "No graphs created. Use 'create' command first." << std::endl;
+void GraphConsoleAdapter::cmd_pagerank(const std::vector<std::string> &args) {
+    if (args.empty()) {
+        fail() << "Usage: pagerank <graph> [damping]" << '\n';
         return;
     }
 
     try {
-        const auto source_1 = graph1.get();
-        const auto source_2 = graph2.get();
-        GraphConsoleAdapter::graph = std::make_unique<Graph>(graph_intersection(*source_1, *source_2));
+        double damping = 0.85;
+        if (args.size() > 1 && !Console::parse_number(args[1], damping)) {
+            fail() << "Usage: pagerank <graph> [damping]" << '\n';
+            return;
+        }
+        const Graph* target = require_graph(args[0]);
+        if (target == nullptr) return;
+        if (damping <= 0 || damping >= 1) {
+            fail() << "Damping must be between 0 and 1" << '\n';
+            return;
+        }
+
+        const PageRankResult result = pagerank(*target, damping);
+        out() << "PageRank (" << result.iterations << " iterations, residual " << result.residual << "):" << '\n';
+        for (int v = 0; v < target->n; v++) {
+            out() << "  " << v << ": " << result.score[v] << '\n';
+        }
+    } catch (const std::exception& e) {
+        fail() << "Error while pagerank: " << e.what() << '\n';
+    }
+}
+
+void GraphConsoleAdapter::cmd_hash(const std::vector<std::string> &args) {
+    try {
+        const std::vector<std::string> slots = args.empty() ? workspace.names() : args;
+        if (slots.empty()) {
+            fail() << "No graphs created. Use 'create' command first." << '\n';
+            return;
+        }
+        for (const auto& name : slots) {
+            if (require_graph(name) == nullptr) return;
+        }
+
+        std::vector<std::uint64_t> wl;
+        std::vector<std::uint64_t> exact;
+        for (const auto& name : slots) {
+            const Graph* target = workspace.get(name);
+            wl.push_back(wl_hash(*target));
+            exact.push_back(matrix_fingerprint(*target));
+            out() << "Graph " << name << ": WL " << std::hex << std::setfill('0')
+                      << std::setw(16) << wl.back() << ", exact " << std::setw(16) << exact.back()
+                      << std::dec << std::setfill(' ') << '\n';
+        }
+
+        for (size_t i = 0; i < slots.size(); i++) {
+            for (size_t j = i + 1; j < slots.size(); j++) {
+                if (exact[i] == exact[j]) {
+                    out() << "  Graphs " << slots[i] << " and " << slots[j] << " are identical" << '\n';
+                } else if (wl[i] == wl[j]) {
+                    out() << "  Graphs " << slots[i] << " and " << slots[j] << " are probably isomorphic" << '\n';
+                }
+            }
+        }
     } catch (const std::exception& e) {
-        std::cout << "Error while intersection: " << e.what() << std::endl;
+        fail() << "Error while hash: " << e.what() << '\n';
     }
 }
 
-void GraphConsoleAdapter::cmd_ring() {
-    if (!graphs_created) {
-        std::cout << "No graphs created. Use 'create' command first." << std::endl;
+void GraphConsoleAdapter::cmd_publish(const std::vector<std::string> &args) {
+    if (args.size() < 2) {
+        fail() << "Usage: publish <graph> <name>" << '\n';
         return;
     }
 
     try {
-        const auto source_1 = graph1.get();
-        const auto source_2 = graph2.get();
-        GraphConsoleAdapter::graph = std::make_unique<Graph>(ring_sum(*source_1, *source_2));
+        const Graph* target = require_graph(args[0]);
+        if (target == nullptr) return;
+
+        const std::size_t bytes = publish_graph(*target, args[1]);
+        out() << "Published graph " << args[0] << " as " << shared_object_name(args[1])
+              << " (" << (bytes >> 10) << " KB)" << '\n';
     } catch (const std::exception& e) {
-        std::cout << "Error while intersection: " << e.what() << std::endl;
+        fail() << "Error while publish: " << e.what() << '\n';
     }
 }
 
-void GraphConsoleAdapter::cmd_cartesian() {
-    if (!graphs_created) {
-        std::cout << "No graphs created. Use 'create' command first." << std::endl;
+std::string GraphConsoleAdapter::default_attach_slot(const std::string& name) {
+    return name[0] == '/' ? name.substr(1) : name;
+}
+
+void GraphConsoleAdapter::cmd_attach(const std::vector<std::string> &args) {
+    std::vector<std::string> params = args;
+    const std::string destination = split_destination(params, params.empty() ? "" : default_attach_slot(params[0]));
+    if (params.empty() || destination.empty()) {
+        fail() << "Usage: attach <name> [-> graph]" << '\n';
         return;
     }
 
     try {
-        const auto source_1 = graph1.get();
-        const auto source_2 = graph2.get();
-        GraphConsoleAdapter::graph = std::make_unique<Graph>(graph_cartesian_product(*source_1, *source_2));
+        SharedGraph graph = attach_graph(params[0]);
+        const int n = graph->n;
+        workspace.put(destination, std::move(graph));
+        out() << "Attached " << shared_object_name(params[0]) << " as graph " << destination
+              << " (" << n << " vertices, read-only)" << '\n';
+    } catch (const std::exception& e) {
+        fail() << "Error while attach: " << e.what() << '\n';
+    }
+}
+
+void GraphConsoleAdapter::cmd_unpublish(const std::vector<std::string> &args) {
+    if (args.empty()) {
+        fail() << "Usage: unpublish <name>" << '\n';
+        return;
+    }
+
+    if (unpublish_graph(args[0])) {
+        out() << "Unpublished " << shared_object_name(args[0]) << '\n';
+    } else {
+        fail() << "No such published graph: " << shared_object_name(args[0]) << '\n';
+    }
+}
+
+void GraphConsoleAdapter::cmd_cache(const std::vector<std::string> &args) {
+    if (!args.empty() && args[0] == "clear") {
+        results.clear();
+        out() << "Result cache cleared" << '\n';
+        return;
+    }
+
+    out() << "Result cache: " << results.size() << " entries, "
+              << (results.used() >> 10) << " / " << (results.budget() >> 10) << " KB" << '\n';
+    out() << "  Hits: " << results.hit_count() << ", Misses: " << results.miss_count() << '\n';
+}
+
+void GraphConsoleAdapter::cmd_mem(const std::vector<std::string> &args) {
+    if (!args.empty()) {
+        int megabytes = 0;
+        if (args[0] != "budget" || args.size() != 2 || (args[1] != "auto" && args[1] != "off"
+            && (!Console::parse_number(args[1], megabytes) || megabytes <= 0))) {
+            fail() << "Usage: mem [budget <MB>|auto|off]" << '\n';
+            return;
+        }
+        memory_budget = budget_from_megabytes(args[1] == "auto" ? 0 : args[1] == "off" ? -1 : megabytes);
+    }
+
+    const auto names = workspace.names();
+    if (!names.empty()) {
+        out() << "  " << std::left << std::setw(10) << "graph" << std::right << std::setw(10) << "vertices"
+              << std::setw(12) << "matrix KB" << std::setw(12) << "lists KB" << std::setw(12) << "mapped KB"
+              << std::setw(12) << "total KB" << '\n';
+    }
+
+    // Slots sharing one graph (copy, cache hits) show it once
+    GraphFootprint totals;
+    std::map<const Graph*, std::string> owners;
+    // Spill files are paged in and out by the kernel, they do not count against the budget
+    std::set<const DiskGraph*> disks;
+    std::size_t on_disk = 0;
+    for (const auto& name : names) {
+        out() << "  " << std::left << std::setw(10) << name << std::right;
+        if (workspace.is_pending(name)) {
+            const ExprPtr expr = workspace.operand(name);
+            out() << std::setw(10) << expr->n << "  lazy " << describe(expr) << ", about "
+                  << (predict_footprint(expr).total() >> 10) << " KB when evaluated" << '\n';
+            continue;
+        }
+        if (const SharedDiskGraph disk = workspace.disk(name)) {
+            if (disks.emplace(disk.get()).second) on_disk += disk->file_bytes;
+            out() << std::setw(10) << disk->n << "  out-of-core, " << (disk->file_bytes >> 10)
+                  << " KB mapped from " << disk->path << '\n';
+            continue;
+        }
+        const Graph* target = workspace.get(name);
+        if (const auto [owner, inserted] = owners.emplace(target, name); !inserted) {
+            out() << std::setw(10) << target->n << "  same graph as " << owner->second << '\n';
+            continue;
+        }
+        const GraphFootprint footprint = graph_footprint(*target);
+        totals += footprint;
+        out() << std::setw(10) << target->n << std::setw(12) << (footprint.matrix >> 10)
+              << std::setw(12) << (footprint.lists >> 10) << std::setw(12) << (footprint.mapped >> 10)
+              << std::setw(12) << (footprint.total() >> 10) << '\n';
+    }
+
+    out() << "Graphs: matrix " << (totals.matrix >> 10) << " KB, lists " << (totals.lists >> 10)
+          << " KB, mapped " << (totals.mapped >> 10) << " KB" << '\n';
+    if (const std::size_t huge = mapped_matrix_bytes(); huge > 0) {
+        out() << "Matrices on huge pages: " << (huge >> 10) << " KB, cache and jobs included" << '\n';
+    }
+    if (on_disk > 0) {
+        out() << "Out-of-core files: " << (on_disk >> 10) << " KB, not counted against the budget" << '\n';
+    }
+    out() << "Result cache: " << (results.used() >> 10) << " KB, " << (results.exclusive() >> 10)
+          << " KB of it held only by the cache" << '\n';
+    if (const std::size_t reserved = reserved_bytes.load(); reserved > 0) {
+        out() << "Background jobs: " << (reserved >> 10) << " KB reserved" << '\n';
+    }
+
+    const std::size_t limit = memory_budget.load();
+    out() << "In use: " << (memory_in_use() >> 20) << " MB";
+    if (limit == 0) out() << ", no budget" << '\n';
+    else out() << " of " << (limit >> 20) << " MB budget" << '\n';
+    if (const std::size_t resident = resident_bytes(); resident > 0) {
+        out() << "Process resident: " << (resident >> 20) << " MB" << '\n';
+    }
+}
+
+bool GraphConsoleAdapter::parse_operation(const std::string& name, GraphOp& op) {
+    if (name == "union") op = GraphOp::Union;
+    else if (name == "intersect") op = GraphOp::Intersection;
+    else if (name == "ring") op = GraphOp::RingSum;
+    else if (name == "product") op = GraphOp::CartesianProduct;
+    else return false;
+    return true;
+}
+
+void GraphConsoleAdapter::cmd_explain(const std::vector<std::string> &args) {
+    std::vector<std::string> params = args;
+    split_background(params);
+    split_destination(params, "");
+    GraphOp op = GraphOp::Union;
+    if (params.empty() || !parse_operation(params[0], op) || params.size() == 2) {
+        fail() << "Usage: explain <union|intersect|ring|product> [graph1 graph2]" << '\n';
+        return;
+    }
+
+    const std::string first = params.size() >= 3 ? params[1] : "1";
+    const std::string second = params.size() >= 3 ? params[2] : "2";
+    if (!workspace.contains(first) || !workspace.contains(second)) {
+        require_graph(workspace.contains(first) ? second : first);
+        return;
+    }
+
+    const ExprPtr lhs = workspace.operand(first);
+    const ExprPtr rhs = workspace.operand(second);
+    if (lhs == nullptr || rhs == nullptr) {
+        require_graph(lhs == nullptr ? first : second);
+        return;
+    }
+    const ExprPtr expr = expr_binary(op, lhs, rhs);
+    const OpPlan plan = plan_operation(expr, memory_headroom(), spill_space(), worker_processes.load());
+    out() << "Plan for " << describe(expr) << ": " << plan.n << " vertices, up to " << plan.entries
+          << " list entries" << '\n';
+    for (const ExprPtr& operand : {expr->lhs, expr->rhs}) {
+        out() << "  " << std::left << std::setw(10) << describe(operand) << std::right << std::setw(10) << operand->n
+              << " vertices, " << predict_entries(operand) << " list entries"
+              << (operand->leaf != nullptr ? "" : ", pending") << '\n';
+    }
+
+    out() << "  " << std::left << std::setw(16) << "strategy" << std::right << std::setw(12) << "time"
+          << std::setw(12) << "memory" << '\n';
+    for (const StrategyCost& candidate : plan.candidates) {
+        out() << "  " << std::left << std::setw(16) << strategy_name(candidate.strategy) << std::right;
+        if (!candidate.available) {
+            out() << std::setw(12) << "-" << std::setw(12) << "-" << "  " << candidate.note << '\n';
+            continue;
+        }
+        out() << std::setw(12) << format_duration(candidate.seconds * 1e9)
+              << std::setw(9) << (candidate.bytes >> 20) << " MB"
+              << (candidate.strategy == plan.chosen ? "  <- chosen" : "");
+        if (!candidate.note.empty()) out() << "  " << candidate.note;
+        out() << '\n';
+    }
+
+    const std::size_t limit = memory_budget.load();
+    out() << "Memory: " << (memory_in_use() >> 20) << " MB in use";
+    if (limit == 0) out() << ", no budget" << '\n';
+    else out() << " of " << (limit >> 20) << " MB budget" << '\n';
+    if (lazy_mode) {
+        out() << "Lazy mode is on: the command stores the expression, the plan applies to '&' jobs" << '\n';
+    }
+}
+
+void GraphConsoleAdapter::cmd_processes(const std::vector<std::string> &args) {
+    if (!args.empty()) {
+        int count = 0;
+        if (args.size() != 1 || (args[0] != "off" && (!Console::parse_number(args[0], count) || count < 2))) {
+            fail() << "Usage: processes [<count>|off], count is at least 2" << '\n';
+            return;
+        }
+#ifdef _WIN32
+        fail() << "Worker processes need POSIX fork" << '\n';
+        return;
+#endif
+        set_worker_processes(args[0] == "off" ? 0 : count);
+    }
+
+    if (const int processes = worker_processes.load(); processes > 1) {
+        out() << "Worker processes: " << processes << ", dense union, ring and product rows are written "
+              << "into a shared mapping" << '\n';
+    } else {
+        out() << "Worker processes: off, kernels use " << hardware_threads() << " threads" << '\n';
+    }
+}
+
+void GraphConsoleAdapter::cmd_neighbors(const std::vector<std::string> &args) {
+    int v = 0;
+    if (args.size() != 2 || !Console::parse_number(args[1], v)) {
+        fail() << "Usage: neighbors <graph> <vertex>" << '\n';
+        return;
+    }
+
+    // Out-of-core lists are read straight from the mapping, only the touched pages are loaded
+    std::vector<int> neighbors;
+    int n = 0;
+    if (const SharedDiskGraph disk = workspace.disk(args[0])) {
+        n = disk->n;
+        if (v >= 0 && v < n) neighbors.assign(disk->row(v).begin(), disk->row(v).end());
+    } else {
+        const Graph* target = require_graph(args[0]);
+        if (target == nullptr) return;
+        n = target->n;
+        if (v >= 0 && v < n) neighbors = target->adj_list[v];
+    }
+    if (v < 0 || v >= n) {
+        fail() << "Vertex " << v << " is out of range 0.." << n - 1 << '\n';
+        return;
+    }
+
+    out() << "Neighbors of " << v << " in " << args[0] << " (" << neighbors.size() << "):";
+    for (const int u : neighbors) out() << ' ' << u;
+    out() << '\n';
+}
+
+void GraphConsoleAdapter::cmd_profile(const std::vector<std::string> &args) {
+    if (!args.empty()) {
+        if (args[0] == "on") profiling::enabled = true;
+        else if (args[0] == "off") profiling::enabled = false;
+        else if (args[0] == "reset") {
+            reset_profile();
+            out() << "Profile counters reset" << '\n';
+            return;
+        } else {
+            fail() << "Usage: profile [on|off|reset]" << '\n';
+            return;
+        }
+    }
+
+    out() << "Profiling: " << (profiling::enabled ? "on" : "off") << '\n';
+
+    const auto duration = [](const std::uint64_t ns) { return format_duration(static_cast<double>(ns)); };
+
+    bool header = false;
+    std::string category;
+    for (const ProfileSite* site : profile_sites()) {
+        const auto summary = site->summary();
+        if (summary.calls == 0) continue;
+        if (!header) {
+            out() << "  " << std::left << std::setw(30) << "site" << std::right << std::setw(8) << "calls"
+                  << std::setw(12) << "p50" << std::setw(12) << "p99" << std::setw(12) << "max"
+                  << std::setw(12) << "total" << std::setw(12) << "allocs/call" << std::setw(11) << "KB/call" << '\n';
+            header = true;
+        }
+        if (site->category != category) {
+            category = site->category;
+            out() << "  [" << category << "]" << '\n';
+        }
+        out() << "  " << std::left << std::setw(30) << site->name << std::right << std::setw(8) << summary.calls
+              << std::setw(12) << duration(summary.p50_ns) << std::setw(12) << duration(summary.p99_ns)
+              << std::setw(12) << duration(summary.max_ns) << std::setw(12) << duration(summary.total_ns)
+              << std::setw(12) << summary.allocations / summary.calls
+              << std::setw(11) << (summary.allocated_bytes / summary.calls >> 10) << '\n';
+    }
+    if (!header) {
+        out() << "  Nothing recorded" << (profiling::enabled ? "" : ", 'profile on' starts collecting") << '\n';
+    }
+}
+
+void GraphConsoleAdapter::cmd_trace(const std::vector<std::string> &args) {
+    if (!args.empty() && args[0] == "start") {
+        tracing::start();
+        out() << "Tracing started" << '\n';
+        return;
+    }
+    if (!args.empty() && args[0] == "stop" && args.size() == 2) {
+        std::uint64_t events = 0;
+        if (!tracing::save(args[1], events)) {
+            fail() << "Cannot write trace to " << args[1] << '\n';
+            return;
+        }
+        out() << "Wrote " << events << " events to " << args[1] << '\n';
+        return;
+    }
+    if (!args.empty()) {
+        fail() << "Usage: trace [start|stop <file>]" << '\n';
+        return;
+    }
+
+    const auto [events, dropped, threads] = tracing::totals();
+    out() << "Tracing: " << (tracing::enabled ? "on" : "off") << ", " << events << " events on "
+          << threads << " threads";
+    if (dropped > 0) out() << ", " << dropped << " dropped (" << tracing::BUFFER_EVENTS << " per thread)";
+    out() << '\n';
+}
+
+void GraphConsoleAdapter::cmd_lazy(const std::vector<std::string> &args) {
+    if (!args.empty()) {
+        if (args[0] == "on") lazy_mode = true;
+        else if (args[0] == "off") lazy_mode = false;
+        else {
+            fail() << "Usage: lazy [on|off]" << '\n';
+            return;
+        }
+    }
+
+    out() << "Lazy evaluation: " << (lazy_mode ? "on" : "off") << '\n';
+    for (const auto& name : workspace.names()) {
+        if (!workspace.is_pending(name)) continue;
+        const ExprPtr expr = workspace.operand(name);
+        out() << "  " << name << " = " << describe(expr) << " (" << expr->n << " vertices)" << '\n';
+    }
+}
+
+void GraphConsoleAdapter::cmd_jobs() {
+    const auto running = jobs.list();
+    if (running.empty()) {
+        out() << "No background jobs" << '\n';
+        return;
+    }
+
+    for (const auto& job : running) {
+        out() << "[" << job->id << "] ";
+        if (job->finished.load()) {
+            out() << "finished ";
+        } else if (job->state.cancel_requested.load()) {
+            out() << "cancelling ";
+        } else {
+            out() << std::setw(3) << job->state.percent() << "% ";
+        }
+        out() << job->command << '\n';
+    }
+}
+
+void GraphConsoleAdapter::cmd_wait(const std::vector<std::string> &args) {
+    try {
+        std::vector<std::shared_ptr<Job>> waiting;
+        int id = 0;
+        if (args.empty()) {
+            waiting = jobs.list();
+        } else if (!Console::parse_number(args[0], id)) {
+            fail() << "Usage: wait [id]" << '\n';
+            return;
+        } else if (const auto job = jobs.find(id)) {
+            waiting.push_back(job);
+        } else {
+            fail() << "No such job: " << args[0] << '\n';
+            return;
+        }
+
+        // Progress is redrawn in place until the job is done
+        for (const auto& job : waiting) {
+            int shown = -1;
+            while (!job->finished.load()) {
+                if (const int percent = job->state.percent(); console.is_interactive() && percent != shown) {
+                    shown = percent;
+                    out() << "\r[" << job->id << "] " << std::setw(3) << percent << "% " << job->command << std::flush;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            }
+            if (shown >= 0) {
+                out() << "\r[" << job->id << "] " << std::setw(3) << job->state.percent() << "% " << job->command << '\n';
+            }
+        }
+        report_finished_jobs();
+    } catch (const std::exception& e) {
+        fail() << "Error while wait: " << e.what() << '\n';
+    }
+}
+
+void GraphConsoleAdapter::cmd_cancel(const std::vector<std::string> &args) {
+    if (args.empty()) {
+        fail() << "Usage: cancel <id|all>" << '\n';
+        return;
+    }
+
+    try {
+        int id = 0;
+        if (args[0] == "all") {
+            jobs.cancel_all();
+            out() << "Cancelling all jobs" << '\n';
+        } else if (!Console::parse_number(args[0], id)) {
+            fail() << "Usage: cancel <id|all>" << '\n';
+        } else if (jobs.cancel(id)) {
+            out() << "Cancelling job " << args[0] << '\n';
+        } else {
+            fail() << "No such job: " << args[0] << '\n';
+        }
     } catch (const std::exception& e) {
-        std::cout << "Error while production: " << e.what() << std::endl;
+        fail() << "Error while cancel: " << e.what() << '\n';
     }
 }
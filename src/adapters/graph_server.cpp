@@ -0,0 +1,317 @@
+#include "../include/adapters/graph_server.h"
+#include "../include/core/console.h"
+#include "../include/core/trace.h"
+
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+GraphServer::GraphServer(std::string path, Handler request_handler, const int pool_size)
+    : socket_path(std::move(path)), handler(std::move(request_handler)), threads(std::max(1, pool_size)) {}
+
+#ifdef _WIN32
+
+int GraphServer::run() {
+    std::cerr << "Error: server mode needs Unix-domain sockets, it is not available on Windows" << std::endl;
+    return EXIT_FAILURE;
+}
+
+void GraphServer::serve_client(int) const {}
+
+int run_client(const std::string&, std::istream&, bool) {
+    std::cerr << "Error: server mode needs Unix-domain sockets, it is not available on Windows" << std::endl;
+    return EXIT_FAILURE;
+}
+
+#else
+
+namespace {
+    // Longer request lines are refused instead of buffered without limit
+    constexpr size_t MAX_REQUEST = 64 << 10;
+    // How often the accept loop looks at the stop flag
+    constexpr int POLL_INTERVAL_MS = 200;
+
+    volatile std::sig_atomic_t stop_requested = 0;
+
+    void request_stop(int) {
+        stop_requested = 1;
+    }
+
+    bool make_address(const std::string& path, sockaddr_un& address) {
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+            return false;
+        }
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+        return true;
+    }
+
+    bool write_all(const int fd, const char* data, size_t size) {
+        while (size > 0) {
+            const ssize_t written = ::write(fd, data, size);
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            data += written;
+            size -= static_cast<size_t>(written);
+        }
+        return true;
+    }
+
+    // Buffered reads of '\n'-terminated lines and fixed-size payloads from a socket
+    class SocketReader {
+    public:
+        explicit SocketReader(const int socket) : fd(socket) {}
+
+        bool line(std::string& result) {
+            size_t end;
+            while ((end = buffer.find('\n')) == std::string::npos) {
+                if (buffer.size() > MAX_REQUEST || !fill()) return false;
+            }
+            result.assign(buffer, 0, end);
+            buffer.erase(0, end + 1);
+            if (!result.empty() && result.back() == '\r') result.pop_back();
+            return true;
+        }
+
+        bool exact(const size_t size, std::string& result) {
+            while (buffer.size() < size) {
+                if (!fill()) return false;
+            }
+            result.assign(buffer, 0, size);
+            buffer.erase(0, size);
+            return true;
+        }
+
+    private:
+        int fd;
+        std::string buffer;
+
+        bool fill() {
+            char chunk[4096];
+            while (true) {
+                const ssize_t got = ::read(fd, chunk, sizeof(chunk));
+                if (got < 0 && errno == EINTR) continue;
+                if (got <= 0) return false;
+                buffer.append(chunk, static_cast<size_t>(got));
+                return true;
+            }
+        }
+    };
+
+    bool closes_connection(const std::string& line) {
+        const auto tokens = Console::tokenize(line);
+        return !tokens.empty() && (tokens[0] == "exit" || tokens[0] == "quit");
+    }
+
+    int connect_to(const std::string& path) {
+        sockaddr_un address{};
+        if (!make_address(path, address)) return -1;
+        const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) return -1;
+        if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            ::close(fd);
+            return -1;
+        }
+        return fd;
+    }
+}
+
+int GraphServer::run() {
+    sockaddr_un address{};
+    if (!make_address(socket_path, address)) {
+        std::cerr << "Error: invalid socket path " << socket_path << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // A leftover file from a crashed server is replaced, a live server is not
+    if (const int other = connect_to(socket_path); other >= 0) {
+        ::close(other);
+        std::cerr << "Error: a server is already running on " << socket_path << std::endl;
+        return EXIT_FAILURE;
+    }
+    ::unlink(socket_path.c_str());
+
+    const int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0
+        || ::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+        || ::listen(listener, SOMAXCONN) != 0) {
+        std::cerr << "Error: cannot listen on " << socket_path << ": " << std::strerror(errno) << std::endl;
+        if (listener >= 0) ::close(listener);
+        return EXIT_FAILURE;
+    }
+
+    stop_requested = 0;
+    std::signal(SIGINT, request_stop);
+    std::signal(SIGTERM, request_stop);
+    // A client that hangs up mid-response must not kill the server
+    std::signal(SIGPIPE, SIG_IGN);
+
+    std::mutex mutex;
+    std::condition_variable available;
+    std::deque<int> waiting;
+    std::set<int> connected;
+    bool stopping = false;
+
+    // Each pool thread serves one connection at a time until the client hangs up
+    std::vector<std::thread> pool;
+    pool.reserve(threads);
+    for (int t = 0; t < threads; t++) {
+        pool.emplace_back([&, t] {
+            tracing::name_thread("connection " + std::to_string(t + 1));
+            while (true) {
+                int client;
+                {
+                    std::unique_lock lock(mutex);
+                    available.wait(lock, [&] { return stopping || !waiting.empty(); });
+                    if (stopping) return;
+                    client = waiting.front();
+                    waiting.pop_front();
+                }
+                serve_client(client);
+                {
+                    std::lock_guard lock(mutex);
+                    connected.erase(client);
+                }
+                ::close(client);
+            }
+        });
+    }
+
+    std::cout << "Serving graphs on " << socket_path << " with " << threads << " threads" << std::endl;
+
+    int status = EXIT_SUCCESS;
+    while (!stop_requested) {
+        pollfd ready{listener, POLLIN, 0};
+        const int events = ::poll(&ready, 1, POLL_INTERVAL_MS);
+        if (events < 0 && errno != EINTR) {
+            std::cerr << "Error: poll failed: " << std::strerror(errno) << std::endl;
+            status = EXIT_FAILURE;
+            break;
+        }
+        if (events <= 0) continue;
+
+        const int client = ::accept(listener, nullptr, nullptr);
+        if (client < 0) continue;
+        std::lock_guard lock(mutex);
+        waiting.push_back(client);
+        connected.insert(client);
+        available.notify_one();
+    }
+
+    // Wake threads blocked in read() on open connections, queued ones are dropped
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+        for (const int client : connected) {
+            ::shutdown(client, SHUT_RDWR);
+        }
+        for (const int client : waiting) {
+            ::close(client);
+        }
+        waiting.clear();
+    }
+    available.notify_all();
+    for (auto& thread : pool) {
+        thread.join();
+    }
+
+    ::close(listener);
+    ::unlink(socket_path.c_str());
+    std::signal(SIGINT, SIG_DFL);
+    std::signal(SIGTERM, SIG_DFL);
+    std::cout << "Server stopped" << std::endl;
+    return status;
+}
+
+void GraphServer::serve_client(const int client) const {
+    SocketReader reader(client);
+    std::string line;
+    while (reader.line(line)) {
+        if (closes_connection(line)) return;
+
+        std::string output;
+        const bool failed = handler(line, output);
+        const std::string header = (failed ? "error " : "ok ") + std::to_string(output.size()) + "\n";
+        if (!write_all(client, header.data(), header.size()) || !write_all(client, output.data(), output.size())) {
+            return;
+        }
+    }
+}
+
+int run_client(const std::string& socket_path, std::istream& in, const bool stop_on_error) {
+    const int server = connect_to(socket_path);
+    if (server < 0) {
+        std::cerr << "Error: cannot connect to " << socket_path << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::signal(SIGPIPE, SIG_IGN);
+
+    SocketReader reader(server);
+    int failures = 0;
+    std::string input;
+    while (std::getline(in, input)) {
+        if (Console::is_blank_or_comment(input)) continue;
+
+        const std::string request = input + "\n";
+        if (!write_all(server, request.data(), request.size())) {
+            std::cerr << "Error: server closed the connection" << std::endl;
+            failures++;
+            break;
+        }
+        if (closes_connection(input)) break;
+
+        std::string header;
+        if (!reader.line(header)) {
+            std::cerr << "Error: server closed the connection" << std::endl;
+            failures++;
+            break;
+        }
+
+        const size_t separator = header.find(' ');
+        bool valid = separator != std::string::npos;
+        size_t size = 0;
+        try {
+            if (valid) size = std::stoul(header.substr(separator + 1));
+        } catch (const std::exception&) {
+            valid = false;
+        }
+
+        std::string output;
+        if (!valid || !reader.exact(size, output)) {
+            std::cerr << "Error: malformed response from server" << std::endl;
+            failures++;
+            break;
+        }
+
+        std::cout << output;
+        if (header.compare(0, separator, "error") == 0) {
+            failures++;
+            if (stop_on_error) break;
+        }
+    }
+
+    ::close(server);
+    std::cout.flush();
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#endif
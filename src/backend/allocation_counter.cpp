@@ -0,0 +1,150 @@
+// Global operator new/delete that feed the profiler's allocation counters
+// Counted only while profiling is on: one relaxed add on a per-thread shard, one relaxed load when off
+
+#include "../../include/core/profiler.h"
+
+#include <cstdlib>
+#include <new>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+namespace {
+    void* counted_allocate(std::size_t size) {
+        if (size == 0) size = 1;
+        while (true) {
+            if (void* memory = std::malloc(size)) {
+                profiling::count_allocation(size);
+                return memory;
+            }
+            const std::new_handler handler = std::get_new_handler();
+            if (handler == nullptr) throw std::bad_alloc();
+            handler();
+        }
+    }
+
+    void* counted_allocate(const std::size_t size, const std::nothrow_t&) noexcept {
+        try {
+            return counted_allocate(size);
+        } catch (...) {
+            return nullptr;
+        }
+    }
+
+    // For over-aligned types (alignas above the default new alignment)
+    void* counted_allocate(std::size_t size, const std::align_val_t alignment) {
+        const auto align = static_cast<std::size_t>(alignment);
+        // aligned_alloc wants a multiple of the alignment
+        size = size == 0 ? align : (size + align - 1) / align * align;
+        while (true) {
+#ifdef _WIN32
+            if (void* memory = _aligned_malloc(size, align)) {
+#else
+            if (void* memory = std::aligned_alloc(align, size)) {
+#endif
+                profiling::count_allocation(size);
+                return memory;
+            }
+            const std::new_handler handler = std::get_new_handler();
+            if (handler == nullptr) throw std::bad_alloc();
+            handler();
+        }
+    }
+
+    void* counted_allocate(const std::size_t size, const std::align_val_t alignment, const std::nothrow_t&) noexcept {
+        try {
+            return counted_allocate(size, alignment);
+        } catch (...) {
+            return nullptr;
+        }
+    }
+
+    void aligned_free(void* memory) noexcept {
+#ifdef _WIN32
+        _aligned_free(memory);
+#else
+        std::free(memory);
+#endif
+    }
+}
+
+void* operator new(const std::size_t size) {
+    return counted_allocate(size);
+}
+
+void* operator new[](const std::size_t size) {
+    return counted_allocate(size);
+}
+
+void* operator new(const std::size_t size, const std::nothrow_t& tag) noexcept {
+    return counted_allocate(size, tag);
+}
+
+void* operator new[](const std::size_t size, const std::nothrow_t& tag) noexcept {
+    return counted_allocate(size, tag);
+}
+
+void* operator new(const std::size_t size, const std::align_val_t alignment) {
+    return counted_allocate(size, alignment);
+}
+
+void* operator new[](const std::size_t size, const std::align_val_t alignment) {
+    return counted_allocate(size, alignment);
+}
+
+void* operator new(const std::size_t size, const std::align_val_t alignment, const std::nothrow_t& tag) noexcept {
+    return counted_allocate(size, alignment, tag);
+}
+
+void* operator new[](const std::size_t size, const std::align_val_t alignment, const std::nothrow_t& tag) noexcept {
+    return counted_allocate(size, alignment, tag);
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::align_val_t) noexcept {
+    aligned_free(memory);
+}
+
+void operator delete[](void* memory, std::align_val_t) noexcept {
+    aligned_free(memory);
+}
+
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept {
+    aligned_free(memory);
+}
+
+void operator delete[](void* memory, std::size_t, std::align_val_t) noexcept {
+    aligned_free(memory);
+}
+
+void operator delete(void* memory, std::align_val_t, const std::nothrow_t&) noexcept {
+    aligned_free(memory);
+}
+
+void operator delete[](void* memory, std::align_val_t, const std::nothrow_t&) noexcept {
+    aligned_free(memory);
+}
@@ -0,0 +1,66 @@
+#include "../../include/backend/bit_matrix.h"
+#include "../../include/backend/matrix_memory.h"
+#include "../../include/backend/parallel.h"
+
+namespace {
+    // A row of the bitset costs n/64 words; a list row costs deg entries.
+    // Above roughly one edge per 32 cells the word-parallel kernels win.
+    constexpr int DENSE_RATIO = 32;
+}
+
+BitMatrix make_bit_matrix(const int n) {
+    BitMatrix m;
+    m.n = n;
+    m.words = bit_words(n);
+    m.bits.assign(static_cast<size_t>(n) * m.words, 0);
+    return m;
+}
+
+BitMatrix pack_matrix(const Graph &graph) {
+    BitMatrix m = make_bit_matrix(graph.n);
+
+    parallel_for(graph.n, [&](const int begin, const int end) {
+        for (int i = begin; i < end; i++) {
+            std::uint64_t* out = m.row(i);
+            const int* src = graph.adj_matrix[i];
+            for (int j = 0; j < graph.n; j++) {
+                out[j >> 6] |= static_cast<std::uint64_t>(src[j] != 0) << (j & 63);
+            }
+        }
+    }, 256);
+
+    return m;
+}
+
+Graph unpack_matrix(const BitMatrix &m) {
+    Graph graph;
+    graph.n = m.n;
+    graph.adj_matrix = allocate_matrix(m.n, false);
+    GraphBuildGuard guard(graph);
+    graph.adj_list.resize(m.n);
+
+    parallel_for(m.n, [&](const int begin, const int end) {
+        for (int i = begin; i < end; i++) {
+            const std::uint64_t* src = m.row(i);
+            for (int j = 0; j < m.n; j++) {
+                graph.adj_matrix[i][j] = static_cast<int>((src[j >> 6] >> (j & 63)) & 1u);
+                if (graph.adj_matrix[i][j]) graph.adj_list[i].push_back(j);
+            }
+        }
+    }, 256);
+
+    return graph;
+}
+
+long long count_list_entries(const Graph &graph) {
+    long long total = 0;
+    for (const auto &neighbors : graph.adj_list) {
+        total += static_cast<long long>(neighbors.size());
+    }
+    return total;
+}
+
+bool is_dense(const Graph &graph) {
+    if (graph.n <= 0) return false;
+    return count_list_entries(graph) * DENSE_RATIO >= static_cast<long long>(graph.n) * graph.n;
+}
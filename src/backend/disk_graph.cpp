@@ -0,0 +1,203 @@
+#include "../../include/backend/disk_graph.h"
+#include "../../include/backend/mapped_layout.h"
+#include "../../include/backend/jobs.h"
+#include "../../include/backend/parallel.h"
+#include "../../include/core/profiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    constexpr char DISK_MAGIC[8] = {'L', 'A', 'B', '6', 'C', 'S', 'R', '1'};
+
+    struct DiskHeader {
+        char magic[8];
+        std::int32_t n;
+        std::uint32_t reserved;
+        std::uint64_t entries;
+        std::uint64_t offsets_offset;      // n + 1 uint64, list v is neighbors[offsets[v] .. offsets[v + 1])
+        std::uint64_t neighbors_offset;    // entries ints
+        std::uint64_t total_bytes;
+    };
+
+    DiskHeader layout(const std::uint64_t n, const std::uint64_t entries) {
+        DiskHeader header{};
+        std::memcpy(header.magic, DISK_MAGIC, sizeof(DISK_MAGIC));
+        header.n = static_cast<std::int32_t>(n);
+        header.entries = entries;
+        header.offsets_offset = align_section(sizeof(DiskHeader));
+        header.neighbors_offset = align_section(header.offsets_offset + (n + 1) * sizeof(std::uint64_t));
+        header.total_bytes = header.neighbors_offset + entries * sizeof(int);
+        return header;
+    }
+}
+
+std::size_t disk_graph_bytes(const std::uint64_t n, const std::uint64_t entries) {
+    return layout(n, entries).total_bytes;
+}
+
+std::string spill_path(const std::string &dir) {
+    static std::atomic<unsigned> counter{0};
+    const std::filesystem::path base = dir.empty() ? std::filesystem::temp_directory_path() : std::filesystem::path(dir);
+    return (base / ("lab6-" + std::to_string(std::random_device{}()) + "-" + std::to_string(counter++) + ".csr")).string();
+}
+
+#ifdef _WIN32
+
+DiskGraph::~DiskGraph() = default;
+
+SharedDiskGraph open_disk_graph(const std::string &, bool) {
+    throw std::runtime_error("out-of-core graphs need POSIX mmap");
+}
+
+std::size_t graph_cartesian_product_to_file(const Graph &, const Graph &, const std::string &, std::size_t) {
+    throw std::runtime_error("out-of-core graphs need POSIX mmap");
+}
+
+#else
+
+namespace {
+    void write_at(const int fd, const void *data, std::size_t bytes, std::uint64_t position, const std::string &path) {
+        const auto *cursor = static_cast<const char *>(data);
+        while (bytes > 0) {
+            const ssize_t written = pwrite(fd, cursor, bytes, static_cast<off_t>(position));
+            if (written < 0 && errno == EINTR) continue;
+            if (written <= 0) throw system_error("cannot write", path);
+            cursor += written;
+            bytes -= static_cast<std::size_t>(written);
+            position += static_cast<std::uint64_t>(written);
+        }
+    }
+}
+
+DiskGraph::~DiskGraph() {
+    if (mapping != nullptr) munmap(mapping, file_bytes);
+    if (temporary) unlink(path.c_str());
+}
+
+SharedDiskGraph open_disk_graph(const std::string &path, const bool temporary) {
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw system_error("cannot open", path);
+    }
+
+    struct stat info{};
+    if (fstat(fd, &info) != 0 || static_cast<std::uint64_t>(info.st_size) < sizeof(DiskHeader)) {
+        close(fd);
+        throw std::runtime_error(path + " is not a graph file");
+    }
+    const auto size = static_cast<std::uint64_t>(info.st_size);
+    void *base = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        throw system_error("cannot map", path);
+    }
+
+    auto graph = std::make_shared<DiskGraph>();
+    graph->mapping = base;
+    graph->file_bytes = size;
+    graph->path = path;
+    graph->temporary = temporary;
+
+    DiskHeader header{};
+    std::memcpy(&header, base, sizeof(header));
+    const auto n = static_cast<std::uint64_t>(header.n);
+    const auto *bytes = static_cast<const char *>(base);
+    const bool valid = std::memcmp(header.magic, DISK_MAGIC, sizeof(DISK_MAGIC)) == 0 && header.n >= 0
+        && header.total_bytes <= size
+        && header.offsets_offset + (n + 1) * sizeof(std::uint64_t) <= size
+        && header.neighbors_offset <= size
+        && header.entries <= (size - header.neighbors_offset) / sizeof(int)
+        && reinterpret_cast<const std::uint64_t *>(bytes + header.offsets_offset)[n] == header.entries;
+    if (!valid) {
+        graph->temporary = false;
+        throw std::runtime_error(path + " is not a graph file");
+    }
+
+    graph->n = header.n;
+    graph->entries = header.entries;
+    graph->offsets = reinterpret_cast<const std::uint64_t *>(bytes + header.offsets_offset);
+    graph->neighbors = reinterpret_cast<const int *>(bytes + header.neighbors_offset);
+    return graph;
+}
+
+std::size_t graph_cartesian_product_to_file(const Graph &g1, const Graph &g2, const std::string &path,
+                                            const std::size_t memory_limit) {
+    static ProfileSite& site = profile_site("backend", "graph_cartesian_product_to_file");
+    ProfileScope scope(site);
+
+    const auto n = static_cast<std::uint64_t>(product_vertex_count(g1.n, g2.n));
+    job_expect(static_cast<long long>(2 * n) + g1.n + g2.n);
+
+    const ProductRows product(g1, g2);
+    const std::size_t max_degree = product.max_degree();
+
+    const int fd = open(path.c_str(), O_CREAT | O_TRUNC | O_RDWR, 0600);
+    if (fd < 0) {
+        throw system_error("cannot create", path);
+    }
+
+    static ProfileSite& blocks_site = profile_site("backend", "graph_cartesian_product_to_file: blocks");
+    ProfileScope blocks(blocks_site);
+
+    DiskHeader header = layout(n, 0);
+    try {
+        const std::uint64_t block_rows = std::clamp<std::uint64_t>(
+            memory_limit / (max_degree * sizeof(int) + sizeof(std::uint64_t)), 1, std::max<std::uint64_t>(n, 1));
+        std::vector<std::uint64_t> offsets;
+        std::vector<int> neighbors;
+        std::uint64_t entries = 0;
+
+        for (std::uint64_t begin = 0; begin < n; begin += block_rows) {
+            const auto rows = static_cast<int>(std::min(block_rows, n - begin));
+            offsets.assign(rows + 1, 0);
+            parallel_for(rows, [&](const int first, const int last) {
+                for (int k = first; k < last; k++) offsets[k + 1] = product.degree(begin + k);
+            }, row_grain(static_cast<long long>(max_degree) + 1));
+            for (int k = 0; k < rows; k++) offsets[k + 1] += offsets[k];
+
+            neighbors.resize(offsets[rows]);
+            parallel_for(rows, [&](const int first, const int last) {
+                for (int k = first; k < last; k++) product.fill(begin + k, neighbors.data() + offsets[k]);
+            }, row_grain(static_cast<long long>(max_degree) + 1));
+
+            // Offsets in the file count from the first row of the graph, not of the block
+            for (int k = 0; k < rows; k++) offsets[k] += entries;
+            write_at(fd, offsets.data(), rows * sizeof(std::uint64_t),
+                     header.offsets_offset + begin * sizeof(std::uint64_t), path);
+            write_at(fd, neighbors.data(), neighbors.size() * sizeof(int),
+                     header.neighbors_offset + entries * sizeof(int), path);
+            entries += neighbors.size();
+        }
+
+        header = layout(n, entries);
+        write_at(fd, &entries, sizeof(entries), header.offsets_offset + n * sizeof(std::uint64_t), path);
+        if (ftruncate(fd, static_cast<off_t>(header.total_bytes)) != 0) {
+            throw system_error("cannot size", path);
+        }
+        // The header goes in last, until then open_disk_graph() sees no magic and refuses the file
+        write_at(fd, &header, sizeof(header), 0, path);
+    } catch (...) {
+        close(fd);
+        unlink(path.c_str());
+        throw;
+    }
+
+    close(fd);
+    return header.total_bytes;
+}
+
+#endif
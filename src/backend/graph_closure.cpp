@@ -0,0 +1,145 @@
+#include "../../include/backend/graph_closure.h"
+#include "../../include/backend/parallel.h"
+#include "../../include/core/profiler.h"
+
+#include <algorithm>
+
+namespace {
+    // Rows of B combined per lookup table, and tables kept alive at once
+    constexpr int CHUNK_BITS = 8;
+    constexpr int TABLE_SIZE = 1 << CHUNK_BITS;
+    constexpr int GROUPS_PER_BATCH = 32;
+
+    // dst |= src over a row
+    void or_row(std::uint64_t* dst, const std::uint64_t* src, const int words) {
+        for (int k = 0; k < words; k++) {
+            dst[k] |= src[k];
+        }
+    }
+}
+
+BitMatrix bool_multiply(const BitMatrix &a, const BitMatrix &b) {
+    const int n = a.n;
+    const int words = b.words;
+    BitMatrix c = make_bit_matrix(n);
+    if (n == 0) {
+        return c;
+    }
+
+    const int groups = (n + CHUNK_BITS - 1) / CHUNK_BITS;
+    std::vector<std::uint64_t> tables(static_cast<size_t>(GROUPS_PER_BATCH) * TABLE_SIZE * words);
+    const auto table = [&](const int g, const int idx) {
+        return tables.data() + (static_cast<size_t>(g) * TABLE_SIZE + idx) * words;
+    };
+
+    for (int g0 = 0; g0 < groups; g0 += GROUPS_PER_BATCH) {
+        const int batch = std::min(GROUPS_PER_BATCH, groups - g0);
+
+        // Table entry idx of group g is the OR of the rows of B selected by the bits of idx,
+        // each entry is one earlier entry plus one row
+        parallel_for(batch, [&](const int begin, const int end) {
+            for (int g = begin; g < end; g++) {
+                const int k0 = (g0 + g) * CHUNK_BITS;
+                std::fill_n(table(g, 0), words, 0);
+                for (int idx = 1; idx < TABLE_SIZE; idx++) {
+                    const int bit = std::countr_zero(static_cast<unsigned>(idx));
+                    std::uint64_t* dst = table(g, idx);
+                    std::copy_n(table(g, idx & (idx - 1)), words, dst);
+                    if (k0 + bit < n) or_row(dst, b.row(k0 + bit), words);
+                }
+            }
+        }, 1);
+
+        // Each row of A picks one table entry per group; chunks are byte aligned inside a word
+        parallel_for(n, [&](const int begin, const int end) {
+            for (int i = begin; i < end; i++) {
+                const std::uint64_t* ar = a.row(i);
+                std::uint64_t* out = c.row(i);
+                for (int g = 0; g < batch; g++) {
+                    const int k0 = (g0 + g) * CHUNK_BITS;
+                    if (const auto idx = static_cast<int>((ar[k0 >> 6] >> (k0 & 63)) & (TABLE_SIZE - 1))) {
+                        or_row(out, table(g, idx), words);
+                    }
+                }
+            }
+        }, 64);
+    }
+
+    return c;
+}
+
+Graph transitive_closure(const Graph &graph) {
+    static ProfileSite& site = profile_site("backend", "transitive_closure");
+    ProfileScope scope(site);
+
+    BitMatrix reach = pack_matrix(graph);
+
+    // After round t reach covers every path of length up to 2^t
+    bool changed = graph.n > 0;
+    while (changed) {
+        const BitMatrix step = bool_multiply(reach, reach);
+        changed = false;
+        for (size_t k = 0; k < reach.bits.size(); k++) {
+            if (step.bits[k] & ~reach.bits[k]) {
+                changed = true;
+                reach.bits[k] |= step.bits[k];
+            }
+        }
+    }
+
+    return unpack_matrix(reach);
+}
+
+std::vector<int> all_pairs_distances(const Graph &graph) {
+    static ProfileSite& site = profile_site("backend", "all_pairs_distances");
+    ProfileScope scope(site);
+
+    const int n = graph.n;
+    std::vector<int> dist(static_cast<size_t>(n) * n, -1);
+    if (n == 0) {
+        return dist;
+    }
+
+    const BitMatrix adj = pack_matrix(graph);
+    BitMatrix reach = make_bit_matrix(n);
+    BitMatrix frontier = make_bit_matrix(n);
+    for (int i = 0; i < n; i++) {
+        reach.set(i, i);
+        frontier.set(i, i);
+        dist[static_cast<size_t>(i) * n + i] = 0;
+    }
+
+    // Layer k is (layer k-1) * A minus everything reached before
+    for (int k = 1; ; k++) {
+        BitMatrix next = bool_multiply(frontier, adj);
+        bool any = false;
+
+        parallel_for(n, [&](const int begin, const int end) {
+            for (int i = begin; i < end; i++) {
+                std::uint64_t* nr = next.row(i);
+                std::uint64_t* rr = reach.row(i);
+                for (int w = 0; w < next.words; w++) {
+                    nr[w] &= ~rr[w];
+                    rr[w] |= nr[w];
+                    std::uint64_t bits = nr[w];
+                    while (bits) {
+                        const int j = w * 64 + std::countr_zero(bits);
+                        bits &= bits - 1;
+                        dist[static_cast<size_t>(i) * n + j] = k;
+                    }
+                }
+            }
+        }, 64);
+
+        for (const std::uint64_t word : next.bits) {
+            if (word) {
+                any = true;
+                break;
+            }
+        }
+        if (!any) break;
+        frontier = std::move(next);
+    }
+
+    return dist;
+}
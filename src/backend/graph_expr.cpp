@@ -0,0 +1,181 @@
+#include "../../include/backend/graph_expr.h"
+#include "../../include/backend/bit_matrix.h"
+#include "../../include/backend/matrix_memory.h"
+#include "../../include/backend/parallel.h"
+#include "../../include/core/profiler.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+
+namespace {
+    enum class Instr { Load, Or, And, Xor };
+
+    // Postfix program for one fused region, run once per row on packed words
+    struct FusedProgram {
+        std::vector<Instr> code;
+        std::vector<int> operand;           // leaf index for Load, unused otherwise
+        std::vector<const Graph*> leaves;
+        std::vector<Graph> temporaries;     // materialized barriers, freed after the pass
+        int depth = 0;
+    };
+
+    bool fusable(const GraphExpr &node) {
+        return node.leaf == nullptr && (node.op == GraphOp::Union || node.op == GraphOp::Intersection);
+    }
+
+    int compile(const ExprPtr &node, FusedProgram &program, bool root) {
+        if (node->leaf != nullptr || (!root && !fusable(*node))) {
+            if (node->leaf != nullptr) {
+                program.leaves.push_back(node->leaf);
+            } else {
+                // Ring sums renumber vertices and products change the shape, so they
+                // cannot be fused row by row; evaluate them into a temporary operand
+                program.temporaries.push_back(evaluate(node));
+                program.leaves.push_back(nullptr);
+            }
+            program.code.push_back(Instr::Load);
+            program.operand.push_back(static_cast<int>(program.leaves.size()) - 1);
+            return 1;
+        }
+
+        const int left = compile(node->lhs, program, false);
+        const int right = compile(node->rhs, program, false);
+        program.code.push_back(node->op == GraphOp::Union ? Instr::Or : node->op == GraphOp::Intersection ? Instr::And : Instr::Xor);
+        program.operand.push_back(-1);
+        return std::max(left, right + 1);
+    }
+
+    // Row i of g packed into words covering width columns; columns of a wider operand are cut off
+    void load_row(const Graph *g, const int i, std::uint64_t *out, const int words, const int width) {
+        std::fill_n(out, words, 0);
+        if (g == nullptr || i >= g->n) return;
+        const int* row = g->adj_matrix[i];
+        const int columns = std::min(g->n, width);
+        for (int j = 0; j < columns; j++) {
+            out[j >> 6] |= static_cast<std::uint64_t>(row[j] != 0) << (j & 63);
+        }
+    }
+
+    // Frees the barrier temporaries of a program however the pass ends
+    struct TemporariesGuard {
+        std::vector<Graph> &temporaries;
+        ~TemporariesGuard() {
+            for (Graph &temporary : temporaries) {
+                if (temporary.adj_matrix != nullptr) delete_graph(temporary, temporary.n);
+            }
+        }
+    };
+
+    Graph run_fused(const ExprPtr &root) {
+        FusedProgram program;
+        TemporariesGuard temporaries_guard{program.temporaries};
+        program.depth = compile(root, program, true);
+
+        // Temporaries are only stable once compile is done adding them
+        for (size_t k = 0, t = 0; k < program.leaves.size(); k++) {
+            if (program.leaves[k] == nullptr) program.leaves[k] = &program.temporaries[t++];
+        }
+
+        Graph g;
+        g.n = root->n;
+        g.adj_matrix = allocate_matrix(g.n, false);
+        GraphBuildGuard guard(g);
+        g.adj_list.resize(g.n);
+        const int words = bit_words(g.n);
+
+        parallel_for(g.n, [&](const int begin, const int end) {
+            std::vector<std::uint64_t> stack(static_cast<size_t>(program.depth) * words);
+            for (int i = begin; i < end; i++) {
+                int top = 0;
+                for (size_t pc = 0; pc < program.code.size(); pc++) {
+                    std::uint64_t* dst = stack.data() + static_cast<size_t>(top) * words;
+                    if (program.code[pc] == Instr::Load) {
+                        load_row(program.leaves[program.operand[pc]], i, dst, words, g.n);
+                        top++;
+                        continue;
+                    }
+                    std::uint64_t* a = dst - 2 * words;
+                    const std::uint64_t* b = dst - words;
+                    if (program.code[pc] == Instr::Or) {
+                        for (int w = 0; w < words; w++) a[w] |= b[w];
+                    } else if (program.code[pc] == Instr::And) {
+                        for (int w = 0; w < words; w++) a[w] &= b[w];
+                    } else {
+                        for (int w = 0; w < words; w++) a[w] ^= b[w];
+                    }
+                    top--;
+                }
+
+                const std::uint64_t* bits = stack.data();
+                for (int j = 0; j < g.n; j++) {
+                    g.adj_matrix[i][j] = static_cast<int>((bits[j >> 6] >> (j & 63)) & 1u);
+                    if (g.adj_matrix[i][j]) g.adj_list[i].push_back(j);
+                }
+            }
+        }, 64);
+
+        if (root->leaf == nullptr && root->op == GraphOp::RingSum) {
+            return drop_isolated_vertices(g);
+        }
+        return g;
+    }
+}
+
+ExprPtr expr_leaf(const Graph *graph, const std::string &name, SharedGraph owned) {
+    auto node = std::make_shared<GraphExpr>();
+    node->leaf = graph;
+    node->owned = std::move(owned);
+    node->name = name;
+    node->n = graph->n;
+    return node;
+}
+
+ExprPtr expr_binary(const GraphOp op, const ExprPtr &lhs, const ExprPtr &rhs) {
+    auto node = std::make_shared<GraphExpr>();
+    node->op = op;
+    node->lhs = lhs;
+    node->rhs = rhs;
+    switch (op) {
+        case GraphOp::Intersection: node->n = std::min(lhs->n, rhs->n); break;
+        case GraphOp::CartesianProduct: node->n = product_vertex_count(lhs->n, rhs->n); break;
+        default: node->n = std::max(lhs->n, rhs->n); break;
+    }
+    return node;
+}
+
+std::string describe(const ExprPtr &expr) {
+    if (expr->leaf != nullptr) {
+        return expr->name;
+    }
+
+    switch (expr->op) {
+        case GraphOp::Union: return "(" + describe(expr->lhs) + " | " + describe(expr->rhs) + ")";
+        case GraphOp::Intersection: return "(" + describe(expr->lhs) + " & " + describe(expr->rhs) + ")";
+        case GraphOp::RingSum: return "(" + describe(expr->lhs) + " ^ " + describe(expr->rhs) + ")";
+        case GraphOp::CartesianProduct: return "(" + describe(expr->lhs) + " x " + describe(expr->rhs) + ")";
+    }
+    return "?";
+}
+
+Graph evaluate(const ExprPtr &expr) {
+    static ProfileSite& site = profile_site("backend", "evaluate");
+    ProfileScope scope(site);
+
+    if (expr->leaf != nullptr || expr->op != GraphOp::CartesianProduct) {
+        return run_fused(expr);
+    }
+
+    // Products need whole operand matrices
+    const EvaluatedOperand lhs(expr->lhs);
+    const EvaluatedOperand rhs(expr->rhs);
+    return graph_cartesian_product(lhs.graph(), rhs.graph());
+}
+
+EvaluatedOperand::EvaluatedOperand(const ExprPtr &operand) : source(operand->leaf) {
+    if (source == nullptr) temporary = evaluate(operand);
+}
+
+void EvaluatedOperand::release() {
+    if (temporary.adj_matrix != nullptr) delete_graph(temporary, temporary.n);
+}
@@ -0,0 +1,110 @@
+#include "../../include/backend/graph_hash.h"
+#include "../../include/backend/parallel.h"
+#include "../../include/core/profiler.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace {
+    // splitmix64 finalizer
+    std::uint64_t mix(std::uint64_t x) {
+        x += 0x9e3779b97f4a7c15ull;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+        return x ^ (x >> 31);
+    }
+
+    int count_distinct(std::vector<std::uint64_t> labels) {
+        std::ranges::sort(labels);
+        return static_cast<int>(std::ranges::unique(labels).begin() - labels.begin());
+    }
+
+    // Order-independent hash of a label multiset
+    std::uint64_t multiset_hash(const std::vector<std::uint64_t> &labels) {
+        std::uint64_t sum = 0;
+        std::uint64_t product = 1;
+        for (const std::uint64_t l : labels) {
+            const std::uint64_t h = mix(l);
+            sum += h;
+            product *= h | 1;
+        }
+        return mix(sum ^ mix(product));
+    }
+}
+
+std::uint64_t wl_hash(const Graph &graph, const int max_rounds) {
+    static ProfileSite& site = profile_site("backend", "wl_hash");
+    ProfileScope scope(site);
+
+    const int n = graph.n;
+
+    // Neighbors without self-loops and duplicates; loops only show up in the initial colour
+    std::vector<std::vector<int>> neighbors(n);
+    std::vector<std::uint64_t> labels(n);
+    parallel_for(n, [&](const int begin, const int end) {
+        for (int v = begin; v < end; v++) {
+            bool loop = false;
+            for (const int u : graph.adj_list[v]) {
+                if (u == v) loop = true;
+                else neighbors[v].push_back(u);
+            }
+            std::ranges::sort(neighbors[v]);
+            neighbors[v].erase(std::ranges::unique(neighbors[v]).begin(), neighbors[v].end());
+            labels[v] = mix((static_cast<std::uint64_t>(neighbors[v].size()) << 1) | loop);
+        }
+    });
+
+    // Refine: new colour = own colour + multiset of neighbour colours (a commutative sum,
+    // so no per-vertex sort is needed). Stop once the number of classes stops growing.
+    int classes = count_distinct(labels);
+    std::vector<std::uint64_t> next(n);
+    for (int round = 0; round < max_rounds && classes < n; round++) {
+        parallel_for(n, [&](const int begin, const int end) {
+            for (int v = begin; v < end; v++) {
+                std::uint64_t acc = 0;
+                for (const int u : neighbors[v]) {
+                    acc += mix(labels[u] ^ 0x5bd1e995ull);
+                }
+                next[v] = mix(labels[v] * 31 + acc);
+            }
+        });
+        labels.swap(next);
+
+        const int refined = count_distinct(labels);
+        if (refined == classes) break;
+        classes = refined;
+    }
+
+    return mix(multiset_hash(labels) ^ mix(static_cast<std::uint64_t>(n)));
+}
+
+std::uint64_t matrix_fingerprint(const Graph &graph) {
+    static ProfileSite& site = profile_site("backend", "matrix_fingerprint");
+    ProfileScope scope(site);
+
+    const int n = graph.n;
+    std::vector<std::uint64_t> rows(n);
+
+    // Each row is packed into 64-bit words on the fly and folded position-dependently
+    parallel_for(n, [&](const int begin, const int end) {
+        for (int i = begin; i < end; i++) {
+            const int* row = graph.adj_matrix[i];
+            std::uint64_t h = mix(static_cast<std::uint64_t>(i));
+            for (int j0 = 0; j0 < n; j0 += 64) {
+                std::uint64_t word = 0;
+                const int j1 = std::min(n, j0 + 64);
+                for (int j = j0; j < j1; j++) {
+                    word |= static_cast<std::uint64_t>(row[j] != 0) << (j - j0);
+                }
+                h = mix(h ^ word);
+            }
+            rows[i] = h;
+        }
+    }, 256);
+
+    std::uint64_t h = mix(static_cast<std::uint64_t>(n));
+    for (const std::uint64_t r : rows) {
+        h = mix(h ^ r);
+    }
+    return h;
+}
@@ -0,0 +1,146 @@
+#include "../../include/backend/graph_reorder.h"
+#include "../../include/backend/parallel.h"
+#include "../../include/core/profiler.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <functional>
+#include <numeric>
+
+namespace {
+    // Neighbors in either direction without self-loops, ascending and unique
+    std::vector<std::vector<int>> undirected_lists(const Graph &graph) {
+        std::vector<std::vector<int>> lists(graph.n);
+        for (int i = 0; i < graph.n; i++) {
+            for (const int j : graph.adj_list[i]) {
+                if (j == i) continue;
+                lists[i].push_back(j);
+                lists[j].push_back(i);
+            }
+        }
+        parallel_for(graph.n, [&](const int begin, const int end) {
+            for (int i = begin; i < end; i++) {
+                std::ranges::sort(lists[i]);
+                lists[i].erase(std::unique(lists[i].begin(), lists[i].end()), lists[i].end());
+            }
+        }, row_grain(64));
+        return lists;
+    }
+
+    // Appends the vertices reachable from start in BFS order; neighbors are taken as sorted by less
+    template <typename Less>
+    void bfs_append(const std::vector<std::vector<int>> &lists, const int start, std::vector<char> &seen,
+                    std::vector<int> &order, Less less) {
+        seen[start] = 1;
+        order.push_back(start);
+        std::vector<int> next;
+        for (std::size_t head = order.size() - 1; head < order.size(); head++) {
+            next.clear();
+            for (const int u : lists[order[head]]) {
+                if (!seen[u]) {
+                    seen[u] = 1;
+                    next.push_back(u);
+                }
+            }
+            std::ranges::sort(next, less);
+            order.insert(order.end(), next.begin(), next.end());
+        }
+    }
+}
+
+bool parse_vertex_order(const std::string &name, VertexOrder &order) {
+    if (name == "rcm") order = VertexOrder::ReverseCuthillMcKee;
+    else if (name == "degree") order = VertexOrder::Degree;
+    else if (name == "bfs") order = VertexOrder::Bfs;
+    else return false;
+    return true;
+}
+
+const char *vertex_order_name(const VertexOrder order) {
+    switch (order) {
+        case VertexOrder::ReverseCuthillMcKee: return "rcm";
+        case VertexOrder::Degree: return "degree";
+        case VertexOrder::Bfs: return "bfs";
+    }
+    return "?";
+}
+
+std::vector<int> vertex_order(const Graph &graph, const VertexOrder order, const int source) {
+    static ProfileSite& site = profile_site("backend", "vertex_order");
+    ProfileScope scope(site);
+
+    const int n = graph.n;
+    const auto lists = undirected_lists(graph);
+    const auto by_degree = [&](const int a, const int b) {
+        return lists[a].size() < lists[b].size() || (lists[a].size() == lists[b].size() && a < b);
+    };
+
+    std::vector<int> result;
+    result.reserve(n);
+    std::vector<char> seen(n, 0);
+    switch (order) {
+        case VertexOrder::ReverseCuthillMcKee: {
+            // Each component starts from its lowest-degree vertex, a cheap stand-in for a peripheral one
+            std::vector<int> starts(n);
+            std::iota(starts.begin(), starts.end(), 0);
+            std::ranges::sort(starts, by_degree);
+            for (const int v : starts) {
+                if (!seen[v]) bfs_append(lists, v, seen, result, by_degree);
+            }
+            std::ranges::reverse(result);
+            break;
+        }
+        case VertexOrder::Degree: {
+            result.resize(n);
+            std::iota(result.begin(), result.end(), 0);
+            std::ranges::sort(result, [&](const int a, const int b) { return by_degree(b, a); });
+            break;
+        }
+        case VertexOrder::Bfs: {
+            if (source >= 0 && source < n) bfs_append(lists, source, seen, result, std::less<int>());
+            for (int v = 0; v < n; v++) {
+                if (!seen[v]) bfs_append(lists, v, seen, result, std::less<int>());
+            }
+            break;
+        }
+    }
+    return result;
+}
+
+int graph_bandwidth(const Graph &graph) {
+    int width = 0;
+    for (int i = 0; i < graph.n; i++) {
+        for (const int j : graph.adj_list[i]) {
+            width = std::max(width, std::abs(i - j));
+        }
+    }
+    return width;
+}
+
+std::vector<int> compose_labels(const std::vector<int> &labels, const std::vector<int> &order) {
+    if (labels.empty()) return order;
+    std::vector<int> result(order.size());
+    for (std::size_t k = 0; k < order.size(); k++) {
+        result[k] = labels[order[k]];
+    }
+    return result;
+}
+
+std::vector<int> restore_order(const std::vector<int> &labels) {
+    std::vector<int> order(labels.size());
+    std::iota(order.begin(), order.end(), 0);
+    const auto key = [&](const int v) { return labels[v] < 0 ? INT_MAX : labels[v]; };
+    std::ranges::stable_sort(order, [&](const int a, const int b) { return key(a) < key(b); });
+    return order;
+}
+
+void labels_after_merge(std::vector<int> &labels, const int remove) {
+    if (remove >= 0 && remove < static_cast<int>(labels.size())) {
+        labels.erase(labels.begin() + remove);
+    }
+}
+
+void labels_after_split(std::vector<int> &labels) {
+    if (!labels.empty()) labels.push_back(-1);
+}
@@ -0,0 +1,224 @@
+#include "../../include/backend/graph_spectral.h"
+#include "../../include/backend/bit_matrix.h"
+#include "../../include/backend/parallel.h"
+#include "../../include/core/profiler.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    double dot(const std::vector<double> &a, const std::vector<double> &b) {
+        double sum = 0.0;
+        for (size_t i = 0; i < a.size(); i++) {
+            sum += a[i] * b[i];
+        }
+        return sum;
+    }
+
+    // a -= s * b
+    void sub_scaled(std::vector<double> &a, const double s, const std::vector<double> &b) {
+        for (size_t i = 0; i < a.size(); i++) {
+            a[i] -= s * b[i];
+        }
+    }
+
+    // Same LCG as create_graph, so results are reproducible run to run
+    std::vector<double> start_vector(const int n, unsigned int state) {
+        std::vector<double> v(n);
+        for (double &x : v) {
+            state = (state * 1664525 + 1013904223) & 0x7fffffff;
+            x = static_cast<double>(state) / 0x7fffffff - 0.5;
+        }
+        return v;
+    }
+
+    // Number of eigenvalues of the tridiagonal matrix below x (Sturm sequence)
+    int count_below(const std::vector<double> &alpha, const std::vector<double> &beta, const double x) {
+        int count = 0;
+        double q = 1.0;
+        for (size_t i = 0; i < alpha.size(); i++) {
+            const double off = i > 0 ? beta[i - 1] * beta[i - 1] : 0.0;
+            q = alpha[i] - x - (i > 0 ? off / q : 0.0);
+            if (q == 0.0) q = -1e-300;
+            if (q < 0.0) count++;
+        }
+        return count;
+    }
+
+    // index-th smallest eigenvalue of the tridiagonal matrix by bisection
+    double tridiagonal_eigenvalue(const std::vector<double> &alpha, const std::vector<double> &beta, const int index) {
+        double lo = alpha[0];
+        double hi = alpha[0];
+        for (size_t i = 0; i < alpha.size(); i++) {
+            const double radius = (i > 0 ? std::abs(beta[i - 1]) : 0.0) + (i + 1 < alpha.size() ? std::abs(beta[i]) : 0.0);
+            lo = std::min(lo, alpha[i] - radius);
+            hi = std::max(hi, alpha[i] + radius);
+        }
+
+        for (int iter = 0; iter < 200 && hi - lo > 1e-13 * std::max(1.0, std::abs(hi) + std::abs(lo)); iter++) {
+            const double mid = 0.5 * (lo + hi);
+            if (count_below(alpha, beta, mid) > index) {
+                hi = mid;
+            } else {
+                lo = mid;
+            }
+        }
+        return 0.5 * (lo + hi);
+    }
+}
+
+CsrMatrix to_csr(const Graph &graph) {
+    CsrMatrix csr;
+    csr.n = graph.n;
+    csr.offsets.assign(graph.n + 1, 0);
+    for (int i = 0; i < graph.n; i++) {
+        csr.offsets[i + 1] = csr.offsets[i] + static_cast<int>(graph.adj_list[i].size());
+    }
+
+    csr.cols.resize(csr.offsets[graph.n]);
+    parallel_for(graph.n, [&](const int begin, const int end) {
+        for (int i = begin; i < end; i++) {
+            std::ranges::copy(graph.adj_list[i], csr.cols.begin() + csr.offsets[i]);
+            std::sort(csr.cols.begin() + csr.offsets[i], csr.cols.begin() + csr.offsets[i + 1]);
+        }
+    });
+
+    return csr;
+}
+
+void adjacency_multiply(const Graph &graph, const CsrMatrix &csr, const std::vector<double> &x, std::vector<double> &y) {
+    const int n = graph.n;
+    y.resize(n);
+
+    if (csr.n != n) {
+        parallel_for(n, [&](const int begin, const int end) {
+            for (int i = begin; i < end; i++) {
+                const int* row = graph.adj_matrix[i];
+                double sum = 0.0;
+                for (int j = 0; j < n; j++) {
+                    sum += row[j] * x[j];
+                }
+                y[i] = sum;
+            }
+        }, 64);
+        return;
+    }
+
+    parallel_for(n, [&](const int begin, const int end) {
+        for (int i = begin; i < end; i++) {
+            double sum = 0.0;
+            for (int k = csr.offsets[i]; k < csr.offsets[i + 1]; k++) {
+                sum += x[csr.cols[k]];
+            }
+            y[i] = sum;
+        }
+    }, 2048);
+}
+
+std::vector<double> adjacency_spectrum(const Graph &graph, const int k) {
+    static ProfileSite& site = profile_site("backend", "adjacency_spectrum");
+    ProfileScope scope(site);
+
+    const int n = graph.n;
+    if (n <= 0 || k <= 0) {
+        return {};
+    }
+
+    const CsrMatrix csr = is_dense(graph) ? CsrMatrix{} : to_csr(graph);
+    const int steps = std::min(n, std::max(2 * k + 20, 40));
+
+    // Lanczos with full reorthogonalization; on breakdown restart from a fresh vector
+    // orthogonal to the basis so disconnected graphs still expose every component
+    std::vector<std::vector<double>> basis;
+    std::vector<double> alpha, beta;
+    std::vector<double> v = start_vector(n, 12345u);
+    double norm = std::sqrt(dot(v, v));
+    for (double &x : v) x /= norm;
+
+    std::vector<double> w;
+    for (int j = 0; j < steps; j++) {
+        basis.push_back(v);
+        adjacency_multiply(graph, csr, basis[j], w);
+        alpha.push_back(dot(w, basis[j]));
+
+        for (int pass = 0; pass < 2; pass++) {
+            for (const auto &b : basis) {
+                sub_scaled(w, dot(w, b), b);
+            }
+        }
+
+        if (j + 1 == steps) break;
+
+        norm = std::sqrt(dot(w, w));
+        if (norm < 1e-10) {
+            w = start_vector(n, 12345u + j + 1);
+            for (int pass = 0; pass < 2; pass++) {
+                for (const auto &b : basis) {
+                    sub_scaled(w, dot(w, b), b);
+                }
+            }
+            const double restart = std::sqrt(dot(w, w));
+            if (restart < 1e-10) break;
+            for (double &x : w) x /= restart;
+            beta.push_back(0.0);
+        } else {
+            for (double &x : w) x /= norm;
+            beta.push_back(norm);
+        }
+        v.swap(w);
+    }
+
+    const int m = static_cast<int>(alpha.size());
+    std::vector<double> values;
+    for (int r = 0; r < std::min(k, m); r++) {
+        values.push_back(tridiagonal_eigenvalue(alpha, beta, m - 1 - r));
+    }
+    return values;
+}
+
+PageRankResult pagerank(const Graph &graph, const double damping, const int max_iterations, const double tolerance) {
+    static ProfileSite& site = profile_site("backend", "pagerank");
+    ProfileScope scope(site);
+
+    PageRankResult result;
+    const int n = graph.n;
+    if (n <= 0) {
+        return result;
+    }
+
+    const CsrMatrix csr = is_dense(graph) ? CsrMatrix{} : to_csr(graph);
+    std::vector<double> degree(n);
+    for (int i = 0; i < n; i++) {
+        degree[i] = static_cast<double>(graph.adj_list[i].size());
+    }
+
+    // The adjacency matrix is symmetric, so pulling over rows equals pushing along edges
+    result.score.assign(n, 1.0 / n);
+    std::vector<double> share(n), next(n);
+    for (int iter = 1; iter <= max_iterations; iter++) {
+        double dangling = 0.0;
+        for (int i = 0; i < n; i++) {
+            if (degree[i] > 0) {
+                share[i] = result.score[i] / degree[i];
+            } else {
+                share[i] = 0.0;
+                dangling += result.score[i];
+            }
+        }
+
+        adjacency_multiply(graph, csr, share, next);
+
+        const double base = (1.0 - damping) / n + damping * dangling / n;
+        double residual = 0.0;
+        for (int i = 0; i < n; i++) {
+            next[i] = base + damping * next[i];
+            residual += std::abs(next[i] - result.score[i]);
+        }
+        result.score.swap(next);
+        result.iterations = iter;
+        result.residual = residual;
+        if (residual < tolerance) break;
+    }
+
+    return result;
+}
@@ -0,0 +1,298 @@
+#include "../../include/backend/graph_traversal.h"
+#include "../../include/backend/bit_matrix.h"
+#include "../../include/backend/parallel.h"
+#include "../../include/core/profiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+
+namespace {
+    // Switch to bottom-up once the frontier is this fraction of the unvisited set
+    constexpr int BOTTOM_UP_ALPHA = 14;
+
+    BfsResult bfs_dense(const BitMatrix &m, const int source) {
+        const int n = m.n;
+        const int words = m.words;
+
+        BfsResult result;
+        result.source = source;
+        result.dist.assign(n, -1);
+        result.parent.assign(n, -1);
+
+        std::vector<std::uint64_t> visited(words, 0), frontier(words, 0), next(words, 0);
+        visited[source >> 6] = frontier[source >> 6] = std::uint64_t{1} << (source & 63);
+        result.dist[source] = 0;
+
+        int frontier_size = 1;
+        int unvisited = n - 1;
+
+        for (int level = 1; frontier_size > 0; level++) {
+            std::ranges::fill(next, 0);
+
+            if (static_cast<long long>(frontier_size) * BOTTOM_UP_ALPHA > unvisited) {
+                // Bottom-up: every unvisited vertex looks for a parent in the frontier.
+                // Chunks are whole words of next, so workers never share a word.
+                parallel_for(words, [&](const int begin, const int end) {
+                    for (int w = begin; w < end; w++) {
+                        std::uint64_t todo = ~visited[w];
+                        if (w == words - 1 && (n & 63)) todo &= (std::uint64_t{1} << (n & 63)) - 1;
+                        while (todo) {
+                            const int v = w * 64 + std::countr_zero(todo);
+                            todo &= todo - 1;
+                            const std::uint64_t* row = m.row(v);
+                            for (int k = 0; k < words; k++) {
+                                if (const std::uint64_t hit = row[k] & frontier[k]) {
+                                    result.parent[v] = k * 64 + std::countr_zero(hit);
+                                    result.dist[v] = level;
+                                    next[w] |= std::uint64_t{1} << (v & 63);
+                                    break;
+                                }
+                            }
+                        }
+                    }
+                }, 16);
+            } else {
+                // Top-down: expand each frontier vertex a word at a time
+                for (int fw = 0; fw < words; fw++) {
+                    std::uint64_t bits = frontier[fw];
+                    while (bits) {
+                        const int u = fw * 64 + std::countr_zero(bits);
+                        bits &= bits - 1;
+                        const std::uint64_t* row = m.row(u);
+                        for (int k = 0; k < words; k++) {
+                            std::uint64_t fresh = row[k] & ~visited[k] & ~next[k];
+                            next[k] |= fresh;
+                            while (fresh) {
+                                const int v = k * 64 + std::countr_zero(fresh);
+                                fresh &= fresh - 1;
+                                result.parent[v] = u;
+                                result.dist[v] = level;
+                            }
+                        }
+                    }
+                }
+            }
+
+            frontier_size = 0;
+            for (int k = 0; k < words; k++) {
+                visited[k] |= next[k];
+                frontier_size += std::popcount(next[k]);
+            }
+            frontier.swap(next);
+            unvisited -= frontier_size;
+        }
+
+        return result;
+    }
+
+    BfsResult bfs_sparse(const Graph &graph, const int source) {
+        BfsResult result;
+        result.source = source;
+        result.dist.assign(graph.n, -1);
+        result.parent.assign(graph.n, -1);
+
+        std::vector<int> queue;
+        queue.reserve(graph.n);
+        queue.push_back(source);
+        result.dist[source] = 0;
+
+        for (size_t head = 0; head < queue.size(); head++) {
+            const int u = queue[head];
+            for (const int v : graph.adj_list[u]) {
+                if (result.dist[v] == -1) {
+                    result.dist[v] = result.dist[u] + 1;
+                    result.parent[v] = u;
+                    queue.push_back(v);
+                }
+            }
+        }
+
+        return result;
+    }
+
+    ComponentsResult components_dense(const BitMatrix &m) {
+        const int n = m.n;
+        const int words = m.words;
+
+        ComponentsResult result;
+        result.label.assign(n, -1);
+
+        std::vector<std::uint64_t> visited(words, 0), frontier(words, 0), next(words, 0);
+
+        for (int start = 0; start < n; start++) {
+            if (result.label[start] != -1) continue;
+
+            const int id = result.count++;
+            std::ranges::fill(frontier, 0);
+            frontier[start >> 6] = std::uint64_t{1} << (start & 63);
+            visited[start >> 6] |= frontier[start >> 6];
+
+            bool any = true;
+            while (any) {
+                // Label the frontier, then OR its rows together to get the next one
+                std::ranges::fill(next, 0);
+                for (int fw = 0; fw < words; fw++) {
+                    std::uint64_t bits = frontier[fw];
+                    while (bits) {
+                        const int u = fw * 64 + std::countr_zero(bits);
+                        bits &= bits - 1;
+                        result.label[u] = id;
+                        const std::uint64_t* row = m.row(u);
+                        for (int k = 0; k < words; k++) {
+                            next[k] |= row[k];
+                        }
+                    }
+                }
+
+                any = false;
+                for (int k = 0; k < words; k++) {
+                    next[k] &= ~visited[k];
+                    visited[k] |= next[k];
+                    any = any || next[k] != 0;
+                }
+                frontier.swap(next);
+            }
+        }
+
+        return result;
+    }
+
+    int find_root(std::vector<std::atomic<int>> &parent, int x) {
+        while (true) {
+            int p = parent[x].load(std::memory_order_relaxed);
+            if (p == x) return x;
+            const int gp = parent[p].load(std::memory_order_relaxed);
+            if (gp != p) {
+                // Path halving, losing the race here is harmless
+                parent[x].compare_exchange_weak(p, gp, std::memory_order_relaxed);
+            }
+            x = gp;
+        }
+    }
+
+    void unite(std::vector<std::atomic<int>> &parent, int a, int b) {
+        while (true) {
+            a = find_root(parent, a);
+            b = find_root(parent, b);
+            if (a == b) return;
+            // Always hang the larger root under the smaller one, so roots end up being
+            // the smallest vertex of their component and the result is deterministic
+            if (a < b) std::swap(a, b);
+            int expected = a;
+            if (parent[a].compare_exchange_strong(expected, b, std::memory_order_relaxed)) return;
+        }
+    }
+
+    ComponentsResult components_sparse(const Graph &graph) {
+        const int n = graph.n;
+        std::vector<std::atomic<int>> parent(n);
+
+        parallel_for(n, [&](const int begin, const int end) {
+            for (int i = begin; i < end; i++) parent[i].store(i, std::memory_order_relaxed);
+        });
+
+        parallel_for(n, [&](const int begin, const int end) {
+            for (int u = begin; u < end; u++) {
+                for (const int v : graph.adj_list[u]) {
+                    if (v > u) unite(parent, u, v);
+                }
+            }
+        }, 4096);
+
+        ComponentsResult result;
+        result.label.assign(n, -1);
+        for (int i = 0; i < n; i++) {
+            const int root = find_root(parent, i);
+            if (result.label[root] == -1) result.label[root] = result.count++;
+            result.label[i] = result.label[root];
+        }
+
+        return result;
+    }
+}
+
+BfsResult bfs(const Graph &graph, const int source) {
+    static ProfileSite& site = profile_site("backend", "bfs");
+    ProfileScope scope(site);
+
+    if (source < 0 || source >= graph.n) {
+        return {};
+    }
+
+    if (is_dense(graph)) {
+        return bfs_dense(pack_matrix(graph), source);
+    }
+    return bfs_sparse(graph, source);
+}
+
+ComponentsResult connected_components(const Graph &graph) {
+    static ProfileSite& site = profile_site("backend", "connected_components");
+    ProfileScope scope(site);
+
+    if (graph.n <= 0) {
+        return {};
+    }
+
+    if (is_dense(graph)) {
+        return components_dense(pack_matrix(graph));
+    }
+    return components_sparse(graph);
+}
+
+int vertex_distance(const Graph &graph, const int s, const int t) {
+    static ProfileSite& site = profile_site("backend", "vertex_distance");
+    ProfileScope scope(site);
+
+    if (s < 0 || s >= graph.n || t < 0 || t >= graph.n) {
+        return -1;
+    }
+    return bfs(graph, s).dist[t];
+}
+
+void invalidate(ConnectivityCache &cache) {
+    cache.components_valid = false;
+    cache.components = {};
+    cache.bfs_by_source.clear();
+}
+
+void on_vertices_merged(ConnectivityCache &cache, const int keep, const int remove) {
+    cache.bfs_by_source.clear();
+    if (!cache.components_valid) return;
+
+    auto &label = cache.components.label;
+    if (keep < 0 || remove < 0 || keep >= static_cast<int>(label.size()) || remove >= static_cast<int>(label.size())) {
+        invalidate(cache);
+        return;
+    }
+
+    // Fold remove's component into keep's, then drop the vertex and renumber labels
+    const int from = label[remove];
+    const int to = label[keep];
+    if (from != to) {
+        for (int &l : label) {
+            if (l == from) l = to;
+        }
+    }
+    label.erase(label.begin() + remove);
+
+    std::vector<int> renumber(cache.components.count, -1);
+    int count = 0;
+    for (int &l : label) {
+        if (renumber[l] == -1) renumber[l] = count++;
+        l = renumber[l];
+    }
+    cache.components.count = count;
+}
+
+void on_vertex_split(ConnectivityCache &cache, const int v) {
+    cache.bfs_by_source.clear();
+    if (!cache.components_valid) return;
+
+    auto &label = cache.components.label;
+    if (v < 0 || v >= static_cast<int>(label.size())) {
+        invalidate(cache);
+        return;
+    }
+    label.push_back(label[v]);
+}
@@ -0,0 +1,137 @@
+#include "../../include/backend/graph_triangles.h"
+#include "../../include/backend/bit_matrix.h"
+#include "../../include/backend/parallel.h"
+#include "../../include/core/profiler.h"
+
+#include <algorithm>
+#include <atomic>
+
+namespace {
+    void triangles_dense(const Graph &graph, std::vector<long long> &per_vertex, std::vector<long long> &degree) {
+        BitMatrix m = pack_matrix(graph);
+        for (int i = 0; i < m.n; i++) {
+            m.row(i)[i >> 6] &= ~(std::uint64_t{1} << (i & 63));
+        }
+
+        // Every triangle through v is seen twice, once from each of its other two corners
+        parallel_for(m.n, [&](const int begin, const int end) {
+            for (int v = begin; v < end; v++) {
+                const std::uint64_t* rv = m.row(v);
+                long long twice = 0;
+                long long deg = 0;
+                for (int w = 0; w < m.words; w++) {
+                    std::uint64_t bits = rv[w];
+                    deg += std::popcount(bits);
+                    while (bits) {
+                        const int u = w * 64 + std::countr_zero(bits);
+                        bits &= bits - 1;
+                        twice += and_popcount(rv, m.row(u), m.words);
+                    }
+                }
+                per_vertex[v] = twice / 2;
+                degree[v] = deg;
+            }
+        }, 64);
+    }
+
+    void triangles_sparse(const Graph &graph, std::vector<long long> &per_vertex, std::vector<long long> &degree) {
+        const int n = graph.n;
+
+        std::vector<std::vector<int>> neighbors(n);
+        parallel_for(n, [&](const int begin, const int end) {
+            for (int v = begin; v < end; v++) {
+                auto &list = neighbors[v];
+                list.reserve(graph.adj_list[v].size());
+                for (const int u : graph.adj_list[v]) {
+                    if (u != v) list.push_back(u);
+                }
+                std::sort(list.begin(), list.end());
+                list.erase(std::unique(list.begin(), list.end()), list.end());
+                degree[v] = static_cast<long long>(list.size());
+            }
+        });
+
+        // Orient every edge from lower to higher (degree, id) so each triangle is found once
+        // and the forward lists of hubs stay short
+        const auto before = [&](const int a, const int b) {
+            return degree[a] < degree[b] || (degree[a] == degree[b] && a < b);
+        };
+        std::vector<std::vector<int>> forward(n);
+        parallel_for(n, [&](const int begin, const int end) {
+            for (int v = begin; v < end; v++) {
+                for (const int u : neighbors[v]) {
+                    if (before(v, u)) forward[v].push_back(u);
+                }
+            }
+        });
+
+        std::vector<std::atomic<long long>> counts(n);
+        parallel_for(n, [&](const int begin, const int end) {
+            for (int v = begin; v < end; v++) {
+                const auto &fv = forward[v];
+                for (const int u : fv) {
+                    const auto &fu = forward[u];
+                    auto a = fv.begin();
+                    auto b = fu.begin();
+                    while (a != fv.end() && b != fu.end()) {
+                        if (*a < *b) {
+                            ++a;
+                        } else if (*b < *a) {
+                            ++b;
+                        } else {
+                            counts[v].fetch_add(1, std::memory_order_relaxed);
+                            counts[u].fetch_add(1, std::memory_order_relaxed);
+                            counts[*a].fetch_add(1, std::memory_order_relaxed);
+                            ++a;
+                            ++b;
+                        }
+                    }
+                }
+            }
+        }, 256);
+
+        for (int v = 0; v < n; v++) {
+            per_vertex[v] = counts[v].load(std::memory_order_relaxed);
+        }
+    }
+}
+
+TriangleResult count_triangles(const Graph &graph) {
+    static ProfileSite& site = profile_site("backend", "count_triangles");
+    ProfileScope scope(site);
+
+    TriangleResult result;
+    const int n = graph.n;
+    if (n <= 0) {
+        return result;
+    }
+
+    result.per_vertex.assign(n, 0);
+    result.clustering.assign(n, 0.0);
+    std::vector<long long> degree(n, 0);
+
+    if (is_dense(graph)) {
+        triangles_dense(graph, result.per_vertex, degree);
+    } else {
+        triangles_sparse(graph, result.per_vertex, degree);
+    }
+
+    long long corners = 0;
+    long long triples = 0;
+    double clustering_sum = 0.0;
+    for (int v = 0; v < n; v++) {
+        corners += result.per_vertex[v];
+        const long long pairs = degree[v] * (degree[v] - 1) / 2;
+        triples += pairs;
+        if (pairs > 0) {
+            result.clustering[v] = static_cast<double>(result.per_vertex[v]) / static_cast<double>(pairs);
+            clustering_sum += result.clustering[v];
+        }
+    }
+
+    result.total = corners / 3;
+    result.average_clustering = clustering_sum / n;
+    result.transitivity = triples > 0 ? static_cast<double>(corners) / static_cast<double>(triples) : 0.0;
+
+    return result;
+}
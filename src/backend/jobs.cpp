@@ -0,0 +1,143 @@
+#include "../../include/backend/jobs.h"
+#include "../../include/core/trace.h"
+
+#include <algorithm>
+#include <ranges>
+
+namespace {
+    thread_local JobState* active_job = nullptr;
+}
+
+int JobState::percent() const {
+    const long long all = total.load(std::memory_order_relaxed);
+    if (all <= 0) return 0;
+    return static_cast<int>(std::min(100LL, done.load(std::memory_order_relaxed) * 100 / all));
+}
+
+JobScope::JobScope(JobState* state) : previous(active_job) {
+    active_job = state;
+}
+
+JobScope::~JobScope() {
+    active_job = previous;
+}
+
+JobState* current_job() {
+    return active_job;
+}
+
+void job_expect(const long long items) {
+    if (active_job == nullptr || items <= 0) return;
+    active_job->total.fetch_add(items, std::memory_order_relaxed);
+    active_job->announced.fetch_add(items, std::memory_order_relaxed);
+}
+
+void job_start_items(const long long items) {
+    if (active_job == nullptr || items <= 0) return;
+
+    // Work that was announced is already in the total, only the surplus is new
+    long long announced = active_job->announced.load(std::memory_order_relaxed);
+    long long used = 0;
+    do {
+        used = std::min(announced, items);
+    } while (!active_job->announced.compare_exchange_weak(announced, announced - used, std::memory_order_relaxed));
+
+    if (items > used) {
+        active_job->total.fetch_add(items - used, std::memory_order_relaxed);
+    }
+}
+
+void job_progress(const long long items) {
+    if (active_job == nullptr) return;
+    active_job->done.fetch_add(items, std::memory_order_relaxed);
+}
+
+void check_cancelled() {
+    if (active_job != nullptr && active_job->cancel_requested.load(std::memory_order_relaxed)) {
+        throw JobCancelled();
+    }
+}
+
+JobTable::~JobTable() {
+    cancel_all();
+    for (auto& job : jobs | std::views::values) {
+        if (job->thread.joinable()) job->thread.join();
+    }
+}
+
+int JobTable::start(const std::string& command, std::function<SharedGraph()> work,
+                    std::function<void(const SharedGraph&)> commit) {
+    auto job = std::make_shared<Job>();
+    std::lock_guard lock(mutex);
+    job->id = next_id++;
+    job->command = command;
+    job->commit = std::move(commit);
+
+    // The thread only writes result/error/cancelled before publishing finished
+    job->thread = std::thread([job, work = std::move(work)] {
+        // Only sets the label; a trace buffer is taken from the idle ones once the job records
+        tracing::name_thread("job " + std::to_string(job->id));
+        JobScope scope(&job->state);
+        try {
+            job->result = work();
+        } catch (const JobCancelled&) {
+            job->cancelled = true;
+        } catch (const std::exception& e) {
+            job->error = e.what();
+        }
+        job->finished.store(true, std::memory_order_release);
+    });
+
+    jobs.emplace(job->id, job);
+    return job->id;
+}
+
+std::vector<std::shared_ptr<Job>> JobTable::list() const {
+    std::lock_guard lock(mutex);
+    std::vector<std::shared_ptr<Job>> result;
+    result.reserve(jobs.size());
+    for (const auto& job : jobs | std::views::values) {
+        result.push_back(job);
+    }
+    return result;
+}
+
+std::shared_ptr<Job> JobTable::find(const int id) const {
+    std::lock_guard lock(mutex);
+    const auto it = jobs.find(id);
+    return it != jobs.end() ? it->second : nullptr;
+}
+
+bool JobTable::cancel(const int id) {
+    const auto job = find(id);
+    if (job == nullptr) return false;
+    job->state.cancel_requested.store(true, std::memory_order_relaxed);
+    return true;
+}
+
+void JobTable::cancel_all() {
+    std::lock_guard lock(mutex);
+    for (const auto& job : jobs | std::views::values) {
+        job->state.cancel_requested.store(true, std::memory_order_relaxed);
+    }
+}
+
+std::vector<std::shared_ptr<Job>> JobTable::reap_finished() {
+    std::vector<std::shared_ptr<Job>> finished;
+    {
+        std::lock_guard lock(mutex);
+        for (auto it = jobs.begin(); it != jobs.end();) {
+            if (!it->second->finished.load(std::memory_order_acquire)) {
+                ++it;
+                continue;
+            }
+            finished.push_back(it->second);
+            it = jobs.erase(it);
+        }
+    }
+    // Finished jobs are past their last statement, joining them is immediate
+    for (const auto& job : finished) {
+        job->thread.join();
+    }
+    return finished;
+}
@@ -1,85 +1,224 @@
 // Created by IWOFLEUR on 19.10.2025
 
 #include "../../include/backend/matrix_gen.h"
-
+#include "../../include/backend/bit_matrix.h"
+#include "../../include/backend/jobs.h"
+#include "../../include/backend/matrix_memory.h"
+#include "../../include/backend/parallel.h"
+#include "../../include/core/profiler.h"
+
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+
+namespace {
+    // Copy of an n x n matrix without row and column remove, filled by the threads that will process its rows
+    int** matrix_without(int** matrix, const int n, const int remove) {
+        const int new_n = n - 1;
+        const auto result = allocate_matrix(new_n, false);
+        parallel_for(new_n, [&](const int begin, const int end) {
+            for (int new_i = begin; new_i < end; new_i++) {
+                const int *row = matrix[new_i < remove ? new_i : new_i + 1];
+                std::copy_n(row, remove, result[new_i]);
+                std::copy(row + remove + 1, row + n, result[new_i] + remove);
+            }
+        }, row_grain(new_n));
+        return result;
+    }
+
+    // Adjacency lists as the ascending scan of each matrix row
+    void rebuild_adj_list(Graph &g) {
+        static ProfileSite& site = profile_site("backend", "rebuild_adj_list");
+        ProfileScope scope(site);
+
+        g.adj_list.assign(g.n, {});
+        parallel_for(g.n, [&](const int begin, const int end) {
+            // Branchless compaction: every column is written, only neighbors advance the cursor
+            std::vector<int> scratch(g.n);
+            for (int i = begin; i < end; i++) {
+                const int *row = g.adj_matrix[i];
+                int count = 0;
+                for (int j = 0; j < g.n; j++) {
+                    scratch[count] = j;
+                    count += row[j] == 1;
+                }
+                g.adj_list[i].assign(scratch.begin(), scratch.begin() + count);
+            }
+        }, row_grain(g.n));
+    }
+
+    // State of the generator's LCG after the given number of steps (jump-ahead by squaring)
+    unsigned int lcg_skip(const unsigned int state, unsigned long long steps) {
+        unsigned int mul = 1664525;
+        unsigned int add = 1013904223;
+        unsigned int total_mul = 1;
+        unsigned int total_add = 0;
+        while (steps > 0) {
+            if (steps & 1) {
+                total_mul *= mul;
+                total_add = total_add * mul + add;
+            }
+            add = add * mul + add;
+            mul *= mul;
+            steps >>= 1;
+        }
+        return (total_mul * state + total_add) & 0x7fffffff;
+    }
+}
+
+std::uint64_t next_graph_version() {
+    static std::atomic<std::uint64_t> counter{1};
+    return counter.fetch_add(1, std::memory_order_relaxed);
+}
 
 Graph create_graph(const int n, const double edgeProb, const double loopProb, const unsigned int seed) {
+    static ProfileSite& site = profile_site("backend", "create_graph");
+    ProfileScope scope(site);
+
     Graph graph;
     graph.n = n;
 
-    // Matrix memory allocating
-    graph.adj_matrix = new int*[n];
-    for (int i = 0; i < n; i++) {
-        graph.adj_matrix[i] = new int[n];
-        for (int j = 0; j < n; j++) {
-            graph.adj_matrix[i][j] = 0;
-        }
-    }
+    // Allocation, generation and the list rebuild each pass over all rows
+    job_expect(3LL * n);
 
-    // List initialization
-    graph.adj_list.resize(n);
+    // Matrix memory allocating
+    graph.adj_matrix = allocate_matrix(n);
+    GraphBuildGuard guard(graph);
 
-    static unsigned int counter = 0;
+    static std::atomic<unsigned int> counter{0};
     const auto now = std::chrono::high_resolution_clock::now();
     const auto nanos = std::chrono::time_point_cast<std::chrono::nanoseconds>(now).time_since_epoch().count();
-    unsigned int state = seed == 0 ? static_cast<unsigned int>(nanos) + counter++ : seed;
+    const unsigned int state = seed == 0 ? static_cast<unsigned int>(nanos) + counter++ : seed;
 
-    for (int i = 0; i < n; i++) {
-        for (int j = i; j < n; j++) {
-            state = (state * 1664525 + 1013904223) & 0x7fffffff;
-            const int rand_value = static_cast<int>(state) % 100;
-
-            if (i == j) {
-                if (rand_value < static_cast<int>(loopProb * 100)) {
-                    graph.adj_matrix[i][j] = 1;
-                    graph.adj_list[i].push_back(i);
-                }
-            } else {
-                if (rand_value < static_cast<int>(edgeProb * 100)) {
-                    graph.adj_matrix[i][j] = graph.adj_matrix[j][i] = 1;
-                    graph.adj_list[i].push_back(j);
-                    graph.adj_list[j].push_back(i);
+    static ProfileSite& generate_site = profile_site("backend", "create_graph: generate");
+    ProfileScope generate(generate_site);
+
+    // Row i starts where the sequential generator would be after the pairs of rows 0..i-1,
+    // so a seed gives the same graph with any number of threads
+    parallel_for(n, [&](const int begin, const int end) {
+        for (int i = begin; i < end; i++) {
+            const long long skipped = static_cast<long long>(i) * n - static_cast<long long>(i) * (i - 1) / 2;
+            unsigned int row_state = lcg_skip(state, skipped);
+
+            for (int j = i; j < n; j++) {
+                row_state = (row_state * 1664525 + 1013904223) & 0x7fffffff;
+                const int rand_value = static_cast<int>(row_state) % 100;
+
+                if (i == j) {
+                    if (rand_value < static_cast<int>(loopProb * 100)) {
+                        graph.adj_matrix[i][j] = 1;
+                    }
+                } else {
+                    if (rand_value < static_cast<int>(edgeProb * 100)) {
+                        graph.adj_matrix[i][j] = graph.adj_matrix[j][i] = 1;
+                    }
                 }
             }
         }
-    }
+    }, row_grain(n));
+
+    generate.finish();
+
+    // Rows are scanned in order, so lists come out ascending like the sequential generator made them
+    rebuild_adj_list(graph);
 
     return graph;
 }
 
-void print_matrix(int **matrix, const int rows, const int cols, const char *name) {
-    std::cout << name << ": " << std::endl;
+void print_matrix(int **matrix, const int rows, const int cols, const char *name, std::ostream &out) {
+    static ProfileSite& site = profile_site("backend", "print_matrix");
+    ProfileScope scope(site);
+
+    out << name << ": " << '\n';
     for (int i = 0; i < rows; i++) {
         for (int j = 0; j < cols; j++) {
-            std::cout << std::setw(2) << matrix[i][j] << " ";
+            out << std::setw(2) << matrix[i][j] << " ";
         }
-        std::cout << std::endl;
+        out << '\n';
     }
 }
 
+Graph copy_graph(const Graph &graph) {
+    static ProfileSite& site = profile_site("backend", "copy_graph");
+    ProfileScope scope(site);
+
+    Graph copy;
+    copy.n = graph.n;
+    copy.adj_matrix = allocate_matrix(graph.n, false);
+    parallel_for(graph.n, [&](const int begin, const int end) {
+        for (int i = begin; i < end; i++) {
+            std::copy_n(graph.adj_matrix[i], graph.n, copy.adj_matrix[i]);
+        }
+    }, row_grain(graph.n));
+    copy.adj_list = graph.adj_list;
+    return copy;
+}
+
 void delete_graph(Graph& graph, const int n) {
-    for (int i = 0; i < n; i++) {
-        delete[] graph.adj_matrix[i];
-    }
-    delete[] graph.adj_matrix;
+    free_matrix(graph.adj_matrix, n);
     graph.adj_matrix = nullptr;
     graph.n = 0;
     graph.adj_list.resize(0);
 }
 
-void print_list(const std::vector<std::vector<int> > &list, const char* name) {
-    std::cout << name << ":" << std::endl;
-    for (int i = 0; i < list.size(); i++) {
-        std::cout << i << ": ";
+void print_list(const std::vector<std::vector<int> > &list, const char* name, std::ostream &out) {
+    static ProfileSite& site = profile_site("backend", "print_list");
+    ProfileScope scope(site);
+
+    out << name << ":" << '\n';
+    for (size_t i = 0; i < list.size(); i++) {
+        out << i << ": ";
         for (const int neigh : list[i]) {
-            std::cout << neigh << " ";
+            out << neigh << " ";
         }
-        std::cout << std::endl;
+        out << '\n';
+    }
+}
+
+Graph permute_graph(const Graph &graph, const std::vector<int> &order) {
+    static ProfileSite& site = profile_site("backend", "permute_graph");
+    ProfileScope scope(site);
+
+    Graph g;
+    g.n = graph.n;
+    job_expect(2LL * g.n);
+    g.adj_matrix = allocate_matrix(g.n);
+    GraphBuildGuard guard(g);
+    g.adj_list.resize(g.n);
+
+    std::vector<int> position(g.n);
+    for (int k = 0; k < g.n; k++) {
+        position[order[k]] = k;
     }
+
+    // Row k gathers old row order[k] in the new column order; the list follows the same mapping
+    parallel_for(g.n, [&](const int begin, const int end) {
+        for (int k = begin; k < end; k++) {
+            const int *old_row = graph.adj_matrix[order[k]];
+            int *row = g.adj_matrix[k];
+            for (int l = 0; l < g.n; l++) {
+                row[l] = old_row[order[l]];
+            }
+            std::vector<int> &list = g.adj_list[k];
+            list.reserve(graph.adj_list[order[k]].size());
+            for (const int j : graph.adj_list[order[k]]) {
+                list.push_back(position[j]);
+            }
+            std::ranges::sort(list);
+        }
+    }, row_grain(g.n));
+
+    return g;
 }
 
 void identify_vertices(Graph &graph, int v, int u) {
+    static ProfileSite& site = profile_site("backend", "identify_vertices");
+    ProfileScope scope(site);
+
     if (u == v || u >= graph.n || v >= graph.n || u < 0 || v < 0) {
         return;
     }
@@ -89,6 +228,9 @@ void identify_vertices(Graph &graph, int v, int u) {
     const int remove = u < v ? v : u;
     const int new_n = n - 1;
 
+    static ProfileSite& merge_site = profile_site("backend", "identify_vertices: merge");
+    ProfileScope merge(merge_site);
+
     // Merge edges into keep
     for (int j = 0; j < n; j++) {
         if (j != keep && j != remove) {
@@ -100,31 +242,25 @@ void identify_vertices(Graph &graph, int v, int u) {
     // Merge self-loops and the edge between keep and remove into keep's self-loop
     graph.adj_matrix[keep][keep] = graph.adj_matrix[keep][keep] || graph.adj_matrix[remove][remove] || graph.adj_matrix[keep][remove];
 
-    // Create new matrix without remove
-    const auto new_matrix = new int*[new_n];
-    for (int i = 0; i < new_n; i++) {
-        new_matrix[i] = new int[new_n];
-    }
-
-    for (int i = 0, new_i = 0; i < n; i++) {
-        if (i == remove) continue;
+    merge.finish();
 
-        for (int j = 0, new_j = 0; j < n; j++) {
-            if (j == remove) continue;
+    static ProfileSite& copy_site = profile_site("backend", "identify_vertices: copy");
+    ProfileScope copy(copy_site);
 
-            new_matrix[new_i][new_j] = graph.adj_matrix[i][j];
-            new_j++;
-        }
-        new_i++;
-    }
+    // Create new matrix without remove
+    const auto new_matrix = matrix_without(graph.adj_matrix, n, remove);
 
     // Clean up old matrix
-    for (int i = 0; i < n; i++) {
-        delete[] graph.adj_matrix[i];
-    }
-    delete[] graph.adj_matrix;
+    free_matrix(graph.adj_matrix, n);
     graph.adj_matrix = new_matrix;
     graph.n = new_n;
+    graph.version = next_graph_version();
+
+    copy.finish();
+
+    // The rest only maintains the adjacency lists
+    static ProfileSite& lists_site = profile_site("backend", "identify_vertices: lists");
+    ProfileScope lists(lists_site);
 
     // Add non-self, non-keep neighbors from remove to keep, if not already present
     for (int neigh : graph.adj_list[remove]) {
@@ -202,9 +338,12 @@ void identify_vertices(Graph &graph, int v, int u) {
     }
 }
 
-void contract_edge(Graph &graph, const int v, const int u) {
+bool contract_edge(Graph &graph, const int v, const int u) {
+    static ProfileSite& site = profile_site("backend", "contract_edge");
+    ProfileScope scope(site);
+
     if (u == v || u >= graph.n || v >= graph.n || u < 0 || v < 0) {
-        return;
+        return false;
     }
 
     const int n = graph.n;
@@ -213,10 +352,12 @@ void contract_edge(Graph &graph, const int v, const int u) {
     const int new_n = n - 1;
 
     if (!graph.adj_matrix[u][v] && !graph.adj_matrix[v][u]) {
-        std::cout << "No such edge" << std::endl;
-        return;
+        return false;
     }
 
+    static ProfileSite& merge_site = profile_site("backend", "contract_edge: merge");
+    ProfileScope merge(merge_site);
+
     // Merge edges into keep
     for (int j = 0; j < n; j++) {
         if (j != keep && j != remove) {
@@ -228,31 +369,25 @@ void contract_edge(Graph &graph, const int v, const int u) {
     // Merge self-loops (but not the edge between keep and remove)
     graph.adj_matrix[keep][keep] = graph.adj_matrix[keep][keep] || graph.adj_matrix[remove][remove];
 
-    // Create new matrix without remove
-    const auto new_matrix = new int*[new_n];
-    for (int i = 0; i < new_n; i++) {
-        new_matrix[i] = new int[new_n];
-    }
-
-    for (int i = 0, new_i = 0; i < n; i++) {
-        if (i == remove) continue;
+    merge.finish();
 
-        for (int j = 0, new_j = 0; j < n; j++) {
-            if (j == remove) continue;
+    static ProfileSite& copy_site = profile_site("backend", "contract_edge: copy");
+    ProfileScope copy(copy_site);
 
-            new_matrix[new_i][new_j] = graph.adj_matrix[i][j];
-            new_j++;
-        }
-        new_i++;
-    }
+    // Create new matrix without remove
+    const auto new_matrix = matrix_without(graph.adj_matrix, n, remove);
 
     // Clean up old matrix
-    for (int i = 0; i < n; i++) {
-        delete[] graph.adj_matrix[i];
-    }
-    delete[] graph.adj_matrix;
+    free_matrix(graph.adj_matrix, n);
     graph.adj_matrix = new_matrix;
     graph.n = new_n;
+    graph.version = next_graph_version();
+
+    copy.finish();
+
+    // The rest only maintains the adjacency lists
+    static ProfileSite& lists_site = profile_site("backend", "contract_edge: lists");
+    ProfileScope lists(lists_site);
 
     // Add non-self, non-keep neighbors from remove to keep, if not already present
     for (int neigh : graph.adj_list[remove]) {
@@ -338,6 +473,7 @@ void contract_edge(Graph &graph, const int v, const int u) {
             }
         }
     }
+    return true;
 }
 
 std::vector<int> get_neighbors(const Graph& graph, const int v) {
@@ -355,6 +491,9 @@ std::vector<int> get_neighbors(const Graph& graph, const int v) {
 }
 
 void split_vertex(Graph &graph, const int v, const std::vector<int> &neighbors_for_v2) {
+    static ProfileSite& site = profile_site("backend", "split_vertex");
+    ProfileScope scope(site);
+
     if (v >= graph.n || v < 0) {
         return;
     }
@@ -363,29 +502,29 @@ void split_vertex(Graph &graph, const int v, const std::vector<int> &neighbors_f
     const int new_v = old_n;
     const int new_n = old_n + 1;
 
+    static ProfileSite& copy_site = profile_site("backend", "split_vertex: copy");
+    ProfileScope copy(copy_site);
+
     // Create new matrix with one more row/column
-    const auto new_matrix = new int*[new_n];
-    for (int i = 0; i < new_n; i++) {
-        new_matrix[i] = new int[new_n];
-        for (int j = 0; j < new_n; j++) {
-            new_matrix[i][j] = 0;
-        }
-    }
+    const auto new_matrix = allocate_matrix(new_n);
 
     // Copy old matrix
-    for (int i = 0; i < old_n; i++) {
-        for (int j = 0; j < old_n; j++) {
-            new_matrix[i][j] = graph.adj_matrix[i][j];
+    parallel_for(old_n, [&](const int begin, const int end) {
+        for (int i = begin; i < end; i++) {
+            std::copy_n(graph.adj_matrix[i], old_n, new_matrix[i]);
         }
-    }
+    }, row_grain(old_n));
 
     // Clean up old matrix
-    for (int i = 0; i < old_n; i++) {
-        delete[] graph.adj_matrix[i];
-    }
-    delete[] graph.adj_matrix;
+    free_matrix(graph.adj_matrix, old_n);
     graph.adj_matrix = new_matrix;
     graph.n = new_n;
+    graph.version = next_graph_version();
+
+    copy.finish();
+
+    static ProfileSite& edges_site = profile_site("backend", "split_vertex: edges");
+    ProfileScope edges(edges_site);
 
     // Resize adj_list and initialize new_v's list
     graph.adj_list.resize(new_n);
@@ -433,108 +572,208 @@ void split_vertex(Graph &graph, const int v, const std::vector<int> &neighbors_f
 }
 
 Graph graph_union(const Graph &g1, const Graph &g2) {
+    static ProfileSite& site = profile_site("backend", "graph_union");
+    ProfileScope scope(site);
+
     Graph g;
     g.n = g1.n > g2.n ? g1.n : g2.n;
     const auto loopI = g1.n > g2.n ? g2.n : g1.n;
+    job_expect(2LL * g.n);
 
     // Allocate new matrix
-    g.adj_matrix = new int*[g.n];
-    for (int i = 0; i < g.n; i++) {
-        g.adj_matrix[i] = new int[g.n];
-        for (int j = 0; j < g.n; j++) {
-            g.adj_matrix[i][j] = 0;
-        }
-    }
-
-    for (int i = 0; i < g.n; i++) {
-        for (int j = 0; j < g.n; j++) {
-            if (i < loopI && j < loopI) {
-                // Union: an edge exists if it is in g1 OR in g2
-                g.adj_matrix[i][j] = g1.adj_matrix[i][j] || g2.adj_matrix[i][j];
-            } else {
-                g.adj_matrix[i][j] = g1.n > g2.n ? g1.adj_matrix[i][j] : g2.adj_matrix[i][j];
-            }
-        }
-    }
+    g.adj_matrix = allocate_matrix(g.n);
+    GraphBuildGuard guard(g);
 
     // Initialize adj_list
     g.adj_list.resize(g.n);
 
-    // Merging adjacency lists
-    for (int i = 0; i < g.n; i++) {
-        // Copying neighbors from the first graph
-        g.adj_list[i] = g1.adj_list[i];
+    static ProfileSite& merge_site = profile_site("backend", "graph_union: merge");
+    ProfileScope merge(merge_site);
+
+    // Rows are independent: each one is merged in the matrix and in the list by one thread
+    parallel_for(g.n, [&](const int begin, const int end) {
+        for (int i = begin; i < end; i++) {
+            for (int j = 0; j < g.n; j++) {
+                if (i < loopI && j < loopI) {
+                    // Union: an edge exists if it is in g1 OR in g2
+                    g.adj_matrix[i][j] = g1.adj_matrix[i][j] || g2.adj_matrix[i][j];
+                } else {
+                    g.adj_matrix[i][j] = g1.n > g2.n ? g1.adj_matrix[i][j] : g2.adj_matrix[i][j];
+                }
+            }
 
-        // Add neighbors from the second graph that do not exist yet
-        for (const int neigh : g2.adj_list[i]) {
-            if (std::ranges::find(g.adj_list[i], neigh) == g.adj_list[i].end()) {
-                g.adj_list[i].push_back(neigh);
+            // Copying neighbors from the first graph (the smaller graph has no row i past its size)
+            if (i < g1.n) {
+                g.adj_list[i] = g1.adj_list[i];
+            }
+            if (i >= g2.n) {
+                continue;
+            }
+
+            // Add neighbors from the second graph that do not exist yet
+            for (const int neigh : g2.adj_list[i]) {
+                if (std::ranges::find(g.adj_list[i], neigh) == g.adj_list[i].end()) {
+                    g.adj_list[i].push_back(neigh);
+                }
             }
         }
-    }
+    }, row_grain(g.n));
 
     return g;
 }
 
 Graph graph_intersection(const Graph &g1, const Graph &g2) {
+    static ProfileSite& site = profile_site("backend", "graph_intersection");
+    ProfileScope scope(site);
+
     Graph g;
     g.n = g1.n > g2.n ? g2.n : g1.n;
+    job_expect(3LL * g.n);
 
     // Allocate new matrix
-    g.adj_matrix = new int*[g.n];
-    for (int i = 0; i < g.n; i++) {
-        g.adj_matrix[i] = new int[g.n];
-        for (int j = 0; j < g.n; j++) {
-            // Intersection: an edge exists if it is in g1 AND in g2
-            g.adj_matrix[i][j] = g1.adj_matrix[i][j] && g2.adj_matrix[i][j];
+    g.adj_matrix = allocate_matrix(g.n);
+    GraphBuildGuard guard(g);
+    static ProfileSite& merge_site = profile_site("backend", "graph_intersection: merge");
+    ProfileScope merge(merge_site);
+
+    parallel_for(g.n, [&](const int begin, const int end) {
+        for (int i = begin; i < end; i++) {
+            for (int j = 0; j < g.n; j++) {
+                // Intersection: an edge exists if it is in g1 AND in g2
+                g.adj_matrix[i][j] = g1.adj_matrix[i][j] && g2.adj_matrix[i][j];
+            }
         }
-    }
+    }, row_grain(g.n));
 
-    // Initialize adj_list
-    g.adj_list.resize(g.n);
+    merge.finish();
 
     // Build adjacency list from the intersection matrix
-    for (int i = 0; i < g.n; i++) {
-        for (int j = 0; j < g.n; j++) {
-            if (g.adj_matrix[i][j] == 1) {
-                g.adj_list[i].push_back(j);
-            }
-        }
-    }
+    rebuild_adj_list(g);
 
     return g;
 }
 
 Graph ring_sum(const Graph &g1, const Graph &g2) {
+    static ProfileSite& site = profile_site("backend", "ring_sum");
+    ProfileScope scope(site);
+
     Graph g;
     g.n = g1.n > g2.n ? g1.n : g2.n;
 
+    job_expect(3LL * g.n);
+
     // Allocate new matrix
-    g.adj_matrix = new int*[g.n];
-    for (int i = 0; i < g.n; i++) {
-        g.adj_matrix[i] = new int[g.n];
-        for (int j = 0; j < g.n; j++) {
-            const int val1 = (i < g1.n && j < g1.n) ? g1.adj_matrix[i][j] : 0;
-            const int val2 = (i < g2.n && j < g2.n) ? g2.adj_matrix[i][j] : 0;
-            g.adj_matrix[i][j] = val1 ^ val2;
+    g.adj_matrix = allocate_matrix(g.n);
+    GraphBuildGuard guard(g);
+    static ProfileSite& merge_site = profile_site("backend", "ring_sum: merge");
+    ProfileScope merge(merge_site);
+
+    parallel_for(g.n, [&](const int begin, const int end) {
+        for (int i = begin; i < end; i++) {
+            for (int j = 0; j < g.n; j++) {
+                const int val1 = (i < g1.n && j < g1.n) ? g1.adj_matrix[i][j] : 0;
+                const int val2 = (i < g2.n && j < g2.n) ? g2.adj_matrix[i][j] : 0;
+                g.adj_matrix[i][j] = val1 ^ val2;
+            }
         }
-    }
+    }, row_grain(g.n));
+
+    merge.finish();
+
+    // Build adjacency list
+    rebuild_adj_list(g);
 
-    // Build adjacency list and check for isolated vertices
+    return drop_isolated_vertices(g);
+}
+
+Graph merge_lists(const Graph &g1, const Graph &g2, const GraphOp op) {
+    static ProfileSite& site = profile_site("backend", "merge_lists");
+    ProfileScope scope(site);
+
+    Graph g;
+    g.n = op == GraphOp::Intersection ? std::min(g1.n, g2.n) : std::max(g1.n, g2.n);
+    job_expect(2LL * g.n);
+
+    g.adj_matrix = allocate_matrix(g.n);
+    GraphBuildGuard guard(g);
     g.adj_list.resize(g.n);
-    std::vector<bool> has_real_edges(g.n, false);
 
-    for (int i = 0; i < g.n; i++) {
-        for (int j = 0; j < g.n; j++) {
-            if (g.adj_matrix[i][j] == 1) {
-                g.adj_list[i].push_back(j);
-                if (i != j) {
-                    has_real_edges[i] = true;
-                    has_real_edges[j] = true;
+    static ProfileSite& merge_site = profile_site("backend", "merge_lists: merge");
+    ProfileScope merge(merge_site);
+
+    const long long entries = count_list_entries(g1) + count_list_entries(g2);
+    parallel_for(g.n, [&](const int begin, const int end) {
+        // mark[j] == i: j is a neighbor of i in g1 that g2 has not matched (yet)
+        std::vector<int> mark(g.n, -1);
+        for (int i = begin; i < end; i++) {
+            std::vector<int> &out = g.adj_list[i];
+            static const std::vector<int> none;
+            const std::vector<int> &first = i < g1.n ? g1.adj_list[i] : none;
+            const std::vector<int> &second = i < g2.n ? g2.adj_list[i] : none;
+
+            for (const int j : first) {
+                if (j < g.n) mark[j] = i;
+            }
+            if (op == GraphOp::Union) {
+                // Same order as graph_union: the neighbors of g1, then the new ones of g2
+                out = first;
+                for (const int j : second) {
+                    if (mark[j] != i) out.push_back(j);
+                }
+            } else if (op == GraphOp::Intersection) {
+                for (const int j : second) {
+                    if (j < g.n && mark[j] == i) out.push_back(j);
+                }
+            } else {
+                for (const int j : second) {
+                    if (mark[j] == i) mark[j] = -1;
+                    else out.push_back(j);
+                }
+                for (const int j : first) {
+                    if (mark[j] == i) out.push_back(j);
                 }
             }
+            // Ascending like the rows rebuild_adj_list scans
+            if (op != GraphOp::Union) std::ranges::sort(out);
+
+            int *row = g.adj_matrix[i];
+            for (const int j : out) row[j] = 1;
         }
+    }, row_grain(g.n + entries / std::max(g.n, 1)));
+
+    merge.finish();
+
+    if (op == GraphOp::RingSum) {
+        return drop_isolated_vertices(g);
     }
+    return g;
+}
+
+Graph drop_isolated_vertices(Graph &g) {
+    static ProfileSite& site = profile_site("backend", "drop_isolated_vertices");
+    ProfileScope scope(site);
+
+    job_expect(g.n);
+
+    // Each chunk marks its rows and their columns locally, the marks are OR-ed together
+    std::vector<char> has_real_edges(g.n, 0);
+    std::mutex merge_mutex;
+    parallel_for(g.n, [&](const int begin, const int end) {
+        std::vector<char> local(g.n, 0);
+        for (int i = begin; i < end; i++) {
+            for (int j = 0; j < g.n; j++) {
+                if (g.adj_matrix[i][j] == 1 && i != j) {
+                    local[i] = 1;
+                    local[j] = 1;
+                }
+            }
+        }
+
+        std::lock_guard lock(merge_mutex);
+        for (int v = 0; v < g.n; v++) {
+            has_real_edges[v] |= local[v];
+        }
+    }, row_grain(g.n));
 
     // Remove isolated vertices (including those with only self-loops)
     std::vector<int> vertices_with_edges;
@@ -545,7 +784,7 @@ Graph ring_sum(const Graph &g1, const Graph &g2) {
     }
 
     // Create new graph without isolated vertices
-    if (vertices_with_edges.size() < g.n) {
+    if (vertices_with_edges.size() < static_cast<size_t>(g.n)) {
         Graph new_g;
         new_g.n = static_cast<int>(vertices_with_edges.size());
 
@@ -555,34 +794,34 @@ Graph ring_sum(const Graph &g1, const Graph &g2) {
                 index_map[vertices_with_edges[i]] = static_cast<int>(i);
             }
 
-            new_g.adj_matrix = new int*[new_g.n];
-            for (int i = 0; i < new_g.n; i++) {
-                new_g.adj_matrix[i] = new int[new_g.n]{0};
-            }
+            job_expect(2LL * new_g.n);
+            new_g.adj_matrix = allocate_matrix(new_g.n);
+            GraphBuildGuard guard(new_g);
 
             new_g.adj_list.resize(new_g.n);
 
-            for (const int old_i : vertices_with_edges) {
-                const int new_i = index_map[old_i];
-                for (const int old_j : vertices_with_edges) {
-                    int new_j = index_map[old_j];
-                    if (g.adj_matrix[old_i][old_j] == 1) {
-                        new_g.adj_matrix[new_i][new_j] = 1;
-                        new_g.adj_list[new_i].push_back(new_j);
+            parallel_for(new_g.n, [&](const int begin, const int end) {
+                for (int new_i = begin; new_i < end; new_i++) {
+                    const int old_i = vertices_with_edges[new_i];
+                    for (const int old_j : vertices_with_edges) {
+                        int new_j = index_map[old_j];
+                        if (g.adj_matrix[old_i][old_j] == 1) {
+                            new_g.adj_matrix[new_i][new_j] = 1;
+                            new_g.adj_list[new_i].push_back(new_j);
+                        }
                     }
                 }
-            }
+            }, row_grain(new_g.n));
         }
 
         // Clean up
-        for (int i = 0; i < g.n; i++) {
-            delete[] g.adj_matrix[i];
-        }
-        delete[] g.adj_matrix;
+        free_matrix(g.adj_matrix, g.n);
+        g.adj_matrix = nullptr;
+        g.n = 0;
         return new_g;
     }
 
-    return g;
+    return std::move(g);
 }
 
 // Graph graph_cartesian_product(const Graph &g1, const Graph &g2) {
@@ -644,63 +883,108 @@ Graph ring_sum(const Graph &g1, const Graph &g2) {
 //     return g;
 // }
 
+int product_vertex_count(const int n1, const int n2) {
+    const std::uint64_t n = static_cast<std::uint64_t>(n1) * static_cast<std::uint64_t>(n2);
+    if (n > static_cast<std::uint64_t>(std::numeric_limits<int>::max())) {
+        throw std::runtime_error("product of " + std::to_string(n1) + " and " + std::to_string(n2)
+            + " vertices has too many vertices to number");
+    }
+    return static_cast<int>(n);
+}
+
 Graph graph_cartesian_product(const Graph &g1, const Graph &g2) {
+    static ProfileSite& site = profile_site("backend", "graph_cartesian_product");
+    ProfileScope scope(site);
+
     Graph g;
     // The number of vertices in Cartesian product is |V1| * |V2|
-    g.n = g1.n * g2.n;
+    g.n = product_vertex_count(g1.n, g2.n);
+    job_expect(3LL * g.n);
 
     // Allocate memory for the new adjacency matrix
-    g.adj_matrix = new int*[g.n];
-    for (int i = 0; i < g.n; i++) {
-        g.adj_matrix[i] = new int[g.n];
-        // Initialize with zeros (no edges)
-        for (int j = 0; j < g.n; j++) {
-            g.adj_matrix[i][j] = 0;
-        }
-    }
+    g.adj_matrix = allocate_matrix(g.n);
+    GraphBuildGuard guard(g);
+
+    static ProfileSite& rows_site = profile_site("backend", "graph_cartesian_product: rows");
+    ProfileScope rows(rows_site);
 
-    // Build Cartesian product graph using adjacency matrices
-    for (int u1 = 0; u1 < g1.n; u1++) {
-        for (int v1 = 0; v1 < g2.n; v1++) {
-            // Current vertex index
-            const int i = u1 * g2.n + v1;
+    // Build Cartesian product graph row by row, so no two threads write the same row.
+    // An edge is taken from either direction of the factor matrices, as if both (i, j) and (j, i) were set
+    parallel_for(g.n, [&](const int begin, const int end) {
+        for (int i = begin; i < end; i++) {
+            const int u1 = i / g2.n;
+            const int v1 = i % g2.n;
 
             // Case 1: Same u1, adjacent v's in g2
             for (int v2 = 0; v2 < g2.n; v2++) {
-                if (g2.adj_matrix[v1][v2] == 1) {  // v1 and v2 adjacent in g2
-                    const int j = u1 * g2.n + v2;
-                    if (i != j) {  // Avoid self-loops from this rule
-                        g.adj_matrix[i][j] = 1;
-                        g.adj_matrix[j][i] = 1;
-                    }
+                if (v2 != v1 && (g2.adj_matrix[v1][v2] == 1 || g2.adj_matrix[v2][v1] == 1)) {
+                    g.adj_matrix[i][u1 * g2.n + v2] = 1;
                 }
             }
 
             // Case 2: Same v1, adjacent u's in g1
             for (int u2 = 0; u2 < g1.n; u2++) {
-                if (g1.adj_matrix[u1][u2] == 1) {  // u1 and u2 adjacent in g1
-                    const int j = u2 * g2.n + v1;
-                    g.adj_matrix[i][j] = 1;
-                    g.adj_matrix[j][i] = 1;
+                if (g1.adj_matrix[u1][u2] == 1 || g1.adj_matrix[u2][u1] == 1) {
                     // Note: self-loops allowed here if u1 == u2 and there's a loop in g1
+                    g.adj_matrix[i][u2 * g2.n + v1] = 1;
                 }
             }
         }
-    }
+    }, row_grain(g1.n + g2.n));
 
-    // Build adjacency list from the final adjacency matrix
-    g.adj_list.resize(g.n);
-    for (int i = 0; i < g.n; i++) {
-        g.adj_list[i].clear();
-        for (int j = 0; j < g.n; j++) {
-            if (g.adj_matrix[i][j] == 1) {
-                g.adj_list[i].push_back(j);
+    rows.finish();
+
+    // Build adjacency list from the final adjacency matrix (row scans are sorted and unique)
+    rebuild_adj_list(g);
+
+    return g;
+}
+
+namespace {
+    // Neighbors in either direction of the matrix, ascending, like the product kernel reads them
+    std::vector<std::vector<int>> symmetric_lists(const Graph &g, const bool keep_loops) {
+        std::vector<std::vector<int>> lists(g.n);
+        parallel_for(g.n, [&](const int begin, const int end) {
+            for (int i = begin; i < end; i++) {
+                for (int j = 0; j < g.n; j++) {
+                    if ((i != j || keep_loops) && (g.adj_matrix[i][j] == 1 || g.adj_matrix[j][i] == 1)) {
+                        lists[i].push_back(j);
+                    }
+                }
             }
-        }
-        // Remove duplicates and sort
-        std::sort(g.adj_list[i].begin(), g.adj_list[i].end());
-        g.adj_list[i].erase(std::unique(g.adj_list[i].begin(), g.adj_list[i].end()), g.adj_list[i].end());
+        }, row_grain(g.n));
+        return lists;
     }
+}
 
-    return g;
-}
\ No newline at end of file
+ProductRows::ProductRows(const Graph &g1, const Graph &g2)
+    : first(symmetric_lists(g1, true)), second(symmetric_lists(g2, false)), n2(g2.n) {}
+
+std::size_t ProductRows::max_degree() const {
+    std::size_t total = 0;
+    for (const auto *lists : {&first, &second}) {
+        std::size_t longest = 0;
+        for (const auto &list : *lists) longest = std::max(longest, list.size());
+        total += longest;
+    }
+    return total;
+}
+
+int *ProductRows::fill(const std::uint64_t i, int *out) const {
+    // Row u1 * n2 + v1 lists (u2, v1) for u2 ~ u1 and (u1, v2) for v2 ~ v1, merged by column
+    const int u1 = static_cast<int>(i / n2);
+    const int v1 = static_cast<int>(i % n2);
+    const auto &a = first[u1];
+    const auto &b = second[v1];
+    auto a_split = std::ranges::lower_bound(a, u1);
+    const auto b_split = std::ranges::lower_bound(b, v1);
+    for (auto it = a.begin(); it != a_split; ++it) *out++ = *it * n2 + v1;
+    for (auto it = b.begin(); it != b_split; ++it) *out++ = u1 * n2 + *it;
+    if (a_split != a.end() && *a_split == u1) {
+        *out++ = u1 * n2 + v1;
+        ++a_split;
+    }
+    for (auto it = b_split; it != b.end(); ++it) *out++ = u1 * n2 + *it;
+    for (auto it = a_split; it != a.end(); ++it) *out++ = *it * n2 + v1;
+    return out;
+}
@@ -0,0 +1,142 @@
+#include "../../include/backend/matrix_memory.h"
+#include "../../include/backend/parallel.h"
+#include "../../include/core/profiler.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+
+namespace {
+    // Transparent huge page size on x86-64 and most arm64 kernels
+    constexpr std::size_t HUGE_PAGE = std::size_t{2} << 20;
+
+    std::atomic<bool> huge_pages{true};
+
+    struct Mapping {
+        void *base;
+        std::size_t bytes;
+    };
+
+    // Matrices whose rows live in a mapping, keyed by their row pointer array
+    std::mutex registry_mutex;
+    std::unordered_map<int**, Mapping> registry;
+    std::size_t registry_bytes = 0;
+
+    int** heap_rows(const int n, const bool zeroed) {
+        const auto matrix = new int*[n]();
+        try {
+            parallel_for(n, [&](const int begin, const int end) {
+                for (int i = begin; i < end; i++) {
+                    matrix[i] = zeroed ? new int[n]() : new int[n];
+                }
+            }, row_grain(n));
+        } catch (...) {
+            for (int i = 0; i < n; i++) {
+                delete[] matrix[i];
+            }
+            delete[] matrix;
+            throw;
+        }
+        return matrix;
+    }
+
+#ifndef _WIN32
+    // One 2 MB aligned region for all rows, nullptr if the kernel refuses it
+    int** mapped_rows(const int n, const bool zeroed) {
+        const std::size_t row_bytes = static_cast<std::size_t>(n) * sizeof(int);
+        const std::size_t bytes = (row_bytes * n + HUGE_PAGE - 1) / HUGE_PAGE * HUGE_PAGE;
+
+        // Over-map by one huge page and cut both ends so the region starts on a huge page boundary
+        void *raw = mmap(nullptr, bytes + HUGE_PAGE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED) return nullptr;
+        const auto address = reinterpret_cast<std::uintptr_t>(raw);
+        const std::uintptr_t aligned = (address + HUGE_PAGE - 1) / HUGE_PAGE * HUGE_PAGE;
+        if (aligned > address) munmap(raw, aligned - address);
+        if (const std::size_t tail = address + HUGE_PAGE - aligned; tail > 0) {
+            munmap(reinterpret_cast<void *>(aligned + bytes), tail);
+        }
+        auto *base = reinterpret_cast<char *>(aligned);
+#ifdef MADV_HUGEPAGE
+        // Only advice: with THP set to never the region simply stays on 4 KB pages
+        madvise(base, bytes, MADV_HUGEPAGE);
+#endif
+
+        int **matrix;
+        try {
+            matrix = new int*[n];
+        } catch (...) {
+            munmap(base, bytes);
+            throw;
+        }
+        for (int i = 0; i < n; i++) {
+            matrix[i] = reinterpret_cast<int *>(base + row_bytes * i);
+        }
+        // Anonymous pages read as zero already; writing them is the first touch that places them
+        if (zeroed) {
+            parallel_for(n, [&](const int begin, const int end) {
+                std::memset(matrix[begin], 0, row_bytes * (end - begin));
+            }, row_grain(n));
+        }
+
+        profiling::count_allocation(bytes);
+        const std::lock_guard lock(registry_mutex);
+        registry.emplace(matrix, Mapping{base, bytes});
+        registry_bytes += bytes;
+        return matrix;
+    }
+#endif
+}
+
+int** allocate_matrix(const int n, const bool zeroed) {
+    static ProfileSite& site = profile_site("backend", "allocate_matrix");
+    ProfileScope scope(site);
+
+#ifndef _WIN32
+    if (huge_pages.load() && static_cast<std::size_t>(n) * n * sizeof(int) >= LARGE_MATRIX_BYTES) {
+        if (int **matrix = mapped_rows(n, zeroed)) return matrix;
+    }
+#endif
+    return heap_rows(n, zeroed);
+}
+
+void free_matrix(int** matrix, const int n) {
+    if (matrix == nullptr) return;
+#ifndef _WIN32
+    {
+        std::unique_lock lock(registry_mutex);
+        if (const auto it = registry.find(matrix); it != registry.end()) {
+            const Mapping mapping = it->second;
+            registry.erase(it);
+            registry_bytes -= mapping.bytes;
+            lock.unlock();
+            munmap(mapping.base, mapping.bytes);
+            delete[] matrix;
+            return;
+        }
+    }
+#endif
+    for (int i = 0; i < n; i++) {
+        delete[] matrix[i];
+    }
+    delete[] matrix;
+}
+
+void set_huge_pages(const bool enabled) {
+    huge_pages.store(enabled);
+}
+
+bool huge_pages_enabled() {
+    return huge_pages.load();
+}
+
+std::size_t mapped_matrix_bytes() {
+    const std::lock_guard lock(registry_mutex);
+    return registry_bytes;
+}
@@ -0,0 +1,135 @@
+#include "../../include/backend/memory_budget.h"
+#include "../../include/backend/bit_matrix.h"
+
+#include <algorithm>
+#include <fstream>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+    struct Estimate {
+        std::size_t n = 0;
+        std::size_t entries = 0;    // adjacency list entries, an upper bound for computed nodes
+    };
+
+    Estimate estimate(const ExprPtr &node) {
+        if (node->leaf != nullptr) {
+            return {static_cast<std::size_t>(node->n), static_cast<std::size_t>(count_list_entries(*node->leaf))};
+        }
+
+        const Estimate lhs = estimate(node->lhs);
+        const Estimate rhs = estimate(node->rhs);
+        const auto n = static_cast<std::size_t>(node->n);
+        switch (node->op) {
+            case GraphOp::Intersection: return {n, std::min(lhs.entries, rhs.entries)};
+            case GraphOp::CartesianProduct: return {n, lhs.entries * rhs.n + rhs.entries * lhs.n};
+            default: return {n, std::min(n * n, lhs.entries + rhs.entries)};
+        }
+    }
+
+    GraphFootprint result_footprint(const Estimate &result) {
+        GraphFootprint footprint;
+        footprint.matrix = result.n * result.n * sizeof(int) + result.n * sizeof(int*);
+        footprint.lists = result.n * sizeof(std::vector<int>) + result.entries * sizeof(int);
+        return footprint;
+    }
+
+    GraphFootprint temporaries(const ExprPtr &node);
+
+    // Operands evaluate() materializes before a fused pass: everything below the union/intersection chain
+    GraphFootprint barriers(const ExprPtr &node) {
+        if (node->leaf != nullptr) return {};
+        if (node->op == GraphOp::Union || node->op == GraphOp::Intersection) {
+            GraphFootprint footprint = barriers(node->lhs);
+            footprint += barriers(node->rhs);
+            return footprint;
+        }
+        GraphFootprint footprint = result_footprint(estimate(node));
+        footprint += temporaries(node);
+        return footprint;
+    }
+
+    // Memory held next to the node's own result while it is computed
+    GraphFootprint temporaries(const ExprPtr &node) {
+        if (node->leaf != nullptr) return {};
+        if (node->op == GraphOp::CartesianProduct) {
+            GraphFootprint footprint;
+            for (const ExprPtr &operand : {node->lhs, node->rhs}) {
+                if (operand->leaf != nullptr) continue;
+                footprint += result_footprint(estimate(operand));
+                footprint += temporaries(operand);
+            }
+            return footprint;
+        }
+
+        GraphFootprint footprint = barriers(node->lhs);
+        footprint += barriers(node->rhs);
+        // Dropping isolated vertices copies the ring sum once more
+        if (node->op == GraphOp::RingSum) footprint += result_footprint(estimate(node));
+        return footprint;
+    }
+}
+
+GraphFootprint graph_footprint(const Graph &graph) {
+    const auto n = static_cast<std::size_t>(graph.n);
+    GraphFootprint footprint;
+    // Attached graphs keep only the row pointers on the heap
+    if (graph.read_only) {
+        footprint.mapped = n * n * sizeof(int);
+        footprint.matrix = n * sizeof(int*);
+    } else {
+        footprint.matrix = n * n * sizeof(int) + n * sizeof(int*);
+    }
+    for (const auto &neighbors : graph.adj_list) {
+        footprint.lists += sizeof(neighbors) + neighbors.capacity() * sizeof(int);
+    }
+    return footprint;
+}
+
+GraphFootprint predict_footprint(const ExprPtr &expr) {
+    if (expr->leaf != nullptr) return {};
+    GraphFootprint footprint = result_footprint(estimate(expr));
+    footprint += temporaries(expr);
+    return footprint;
+}
+
+std::size_t predict_entries(const ExprPtr &expr) {
+    return estimate(expr).entries;
+}
+
+GraphFootprint predict_create_footprint(const int n, const double edge_probability) {
+    const auto vertices = static_cast<std::size_t>(n);
+    return result_footprint({vertices, static_cast<std::size_t>(static_cast<double>(vertices * vertices) * edge_probability)});
+}
+
+std::size_t physical_memory_bytes() {
+#ifdef _WIN32
+    MEMORYSTATUSEX status{};
+    status.dwLength = sizeof(status);
+    return GlobalMemoryStatusEx(&status) ? static_cast<std::size_t>(status.ullTotalPhys) : 0;
+#else
+    const long pages = sysconf(_SC_PHYS_PAGES);
+    const long page_size = sysconf(_SC_PAGESIZE);
+    return pages > 0 && page_size > 0 ? static_cast<std::size_t>(pages) * static_cast<std::size_t>(page_size) : 0;
+#endif
+}
+
+std::size_t resident_bytes() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters{};
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+    return counters.WorkingSetSize;
+#else
+    // Second field of statm: resident pages; missing outside Linux
+    std::ifstream statm("/proc/self/statm");
+    std::size_t total = 0;
+    std::size_t resident = 0;
+    if (!(statm >> total >> resident)) return 0;
+    return resident * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
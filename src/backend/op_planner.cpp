@@ -0,0 +1,231 @@
+#include "../../include/backend/op_planner.h"
+#include "../../include/backend/parallel.h"
+#include "../../include/backend/process_workers.h"
+#include "../../include/core/profiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+
+namespace {
+    // Single-thread costs in ns, fitted to n = 512..2048 and densities 0.01..0.5 on one core;
+    // only their ratios matter for the choice, the absolute times are shown by explain
+    constexpr double DENSE_NS_PER_CELL = 3.0;        // union / intersection matrix scan
+    constexpr double DENSE_RING_NS_PER_CELL = 3.5;   // ring sum scan including drop_isolated_vertices
+    constexpr double DENSE_PRODUCT_NS_PER_CELL = 2.2;
+    constexpr double UNION_FIND_NS = 0.6;            // per pair compared by graph_union's list search
+    constexpr double REBUILD_NS_PER_ENTRY = 25.0;    // rebuild_adj_list of intersection, branchy on dense rows
+    constexpr double RING_REBUILD_NS_PER_ENTRY = 12.0;
+    constexpr double ZERO_NS_PER_CELL = 0.25;        // zeroed allocation, page faults included
+    constexpr double MERGE_NS_PER_ENTRY = 6.0;       // marking and scattering one operand list entry
+    constexpr double SORT_NS_PER_COMPARE = 5.0;
+    constexpr double DROP_NS_PER_CELL = 1.5;
+    constexpr double FUSED_NS_PER_CELL = 10.0;       // fused bit-row pass of a lazy expression
+    constexpr double FUSED_RING_NS_PER_CELL = 15.0;
+    constexpr double SPILL_NS_PER_ENTRY = 5.0;       // filling and writing one list entry of a block
+    constexpr double SPILL_NS_PER_ROW = 8.0;
+    constexpr double FACTOR_NS_PER_CELL = 3.0;       // symmetric lists of the factors
+    constexpr double PROCESS_START_NS = 300'000.0;   // fork and reaping of one worker process
+    // One block of rows in RAM when a product goes out of core, at most half of what is available
+    constexpr std::size_t SPILL_BLOCK_BYTES = std::size_t{64} << 20;
+
+    double cells(const ExprPtr &node) {
+        return static_cast<double>(node->n) * node->n;
+    }
+
+    // Result of the node alone, as create_graph would allocate it with the same entries
+    GraphFootprint result_bytes(const ExprPtr &node) {
+        const double total = cells(node);
+        return predict_create_footprint(node->n, total > 0 ? static_cast<double>(predict_entries(node)) / total : 0);
+    }
+
+    Graph run_dense(const Graph &a, const Graph &b, const GraphOp op) {
+        switch (op) {
+            case GraphOp::Union: return graph_union(a, b);
+            case GraphOp::Intersection: return graph_intersection(a, b);
+            case GraphOp::RingSum: return ring_sum(a, b);
+            case GraphOp::CartesianProduct: return graph_cartesian_product(a, b);
+        }
+        return {};
+    }
+}
+
+const StrategyCost &OpPlan::choice() const {
+    for (const StrategyCost &candidate : candidates) {
+        if (candidate.strategy == chosen) return candidate;
+    }
+    return candidates.front();
+}
+
+const char *strategy_name(const Strategy strategy) {
+    switch (strategy) {
+        case Strategy::DenseMatrix: return "dense matrix";
+        case Strategy::ListMerge: return "list merge";
+        case Strategy::LazyView: return "lazy view";
+        case Strategy::OutOfCore: return "out-of-core";
+        case Strategy::WorkerProcesses: return "worker processes";
+    }
+    return "?";
+}
+
+OpPlan plan_operation(const ExprPtr &expr, const std::size_t available, const std::size_t spill_space,
+                      const int processes) {
+    static ProfileSite& site = profile_site("backend", "plan_operation");
+    ProfileScope scope(site);
+
+    OpPlan plan;
+    plan.op = expr->op;
+    plan.n = expr->n;
+    plan.entries = predict_entries(expr);
+
+    const double n = cells(expr);
+    const double e1 = static_cast<double>(predict_entries(expr->lhs));
+    const double e2 = static_cast<double>(predict_entries(expr->rhs));
+    const double out = static_cast<double>(plan.entries);
+    const double threads = std::max(1, hardware_threads());
+
+    // Pending operands are evaluated into temporaries first, whatever the strategy
+    double operands_ns = 0;
+    GraphFootprint operands;
+    for (const ExprPtr &operand : {expr->lhs, expr->rhs}) {
+        if (operand->leaf != nullptr) continue;
+        operands_ns += FUSED_RING_NS_PER_CELL * cells(operand);
+        operands += predict_footprint(operand);
+    }
+
+    GraphFootprint result = result_bytes(expr);
+    // drop_isolated_vertices copies the ring sum once more
+    if (expr->op == GraphOp::RingSum) result += result_bytes(expr);
+    const std::size_t bytes = result.total() + operands.total();
+
+    StrategyCost dense;
+    StrategyCost merge;
+    merge.strategy = Strategy::ListMerge;
+    double lazy_ns = FUSED_NS_PER_CELL * n;
+    switch (expr->op) {
+        case GraphOp::Union: {
+            const double rows = std::max(1, std::min(expr->lhs->n, expr->rhs->n));
+            dense.seconds = DENSE_NS_PER_CELL * n + UNION_FIND_NS * e1 * e2 / rows;
+            merge.seconds = ZERO_NS_PER_CELL * n + MERGE_NS_PER_ENTRY * (e1 + e2);
+            break;
+        }
+        case GraphOp::Intersection:
+            dense.seconds = DENSE_NS_PER_CELL * n + REBUILD_NS_PER_ENTRY * out;
+            merge.seconds = ZERO_NS_PER_CELL * n + MERGE_NS_PER_ENTRY * (e1 + e2);
+            break;
+        case GraphOp::RingSum: {
+            const double degree = expr->n > 0 ? out / expr->n : 0;
+            dense.seconds = DENSE_RING_NS_PER_CELL * n + RING_REBUILD_NS_PER_ENTRY * out;
+            merge.seconds = (ZERO_NS_PER_CELL + DROP_NS_PER_CELL) * n + MERGE_NS_PER_ENTRY * (e1 + e2)
+                + SORT_NS_PER_COMPARE * out * std::log2(degree + 2);
+            lazy_ns = FUSED_RING_NS_PER_CELL * n;
+            break;
+        }
+        case GraphOp::CartesianProduct:
+            dense.seconds = DENSE_PRODUCT_NS_PER_CELL * n;
+            merge.available = false;
+            merge.note = "no list kernel, product rows come from the factor matrices";
+            lazy_ns = dense.seconds;
+            break;
+    }
+
+    // The dense scan again, its rows spread over processes; operands are still evaluated on threads
+    StrategyCost forked;
+    forked.strategy = Strategy::WorkerProcesses;
+    forked.bytes = bytes;
+    if (processes < 2) {
+        forked.available = false;
+        forked.note = "off (see 'processes')";
+    } else if (expr->op == GraphOp::Intersection) {
+        forked.available = false;
+        forked.note = "union, ring and product only";
+    } else {
+        plan.processes = processes;
+        forked.seconds = (dense.seconds / processes + operands_ns / threads + PROCESS_START_NS * processes) / 1e9;
+        forked.note = std::to_string(processes) + " processes replace the dense matrix threads";
+    }
+
+    for (StrategyCost *candidate : {&dense, &merge}) {
+        candidate->seconds = (candidate->seconds + operands_ns) / threads / 1e9;
+        candidate->bytes = bytes;
+    }
+
+    StrategyCost lazy;
+    lazy.strategy = Strategy::LazyView;
+    lazy.note = "defers about " + std::to_string(static_cast<long long>((lazy_ns + operands_ns) / threads / 1e6))
+        + " ms and " + std::to_string(bytes >> 20) + " MB to the first use";
+
+    // Only the factor lists and one block of rows stay in memory, the rest is written to the spill file
+    StrategyCost spill;
+    spill.strategy = Strategy::OutOfCore;
+    if (expr->op != GraphOp::CartesianProduct) {
+        spill.available = false;
+        spill.note = "products only, other results are no bigger than their operands";
+    } else {
+        plan.block_bytes = std::min(SPILL_BLOCK_BYTES, available == SIZE_MAX ? SIZE_MAX : available / 2);
+        spill.seconds = (FACTOR_NS_PER_CELL * (cells(expr->lhs) + cells(expr->rhs))
+            + SPILL_NS_PER_ENTRY * out + SPILL_NS_PER_ROW * expr->n + operands_ns) / threads / 1e9;
+        spill.bytes = plan.block_bytes + static_cast<std::size_t>(2 * (e1 + e2)) * sizeof(int) + operands.total();
+        spill.file_bytes = disk_graph_bytes(static_cast<std::uint64_t>(expr->n), plan.entries);
+        if (spill_space == 0) {
+            spill.available = false;
+            spill.note = "turned off (out_of_core in the config)";
+        } else if (spill.file_bytes > spill_space) {
+            spill.available = false;
+            spill.note = "needs " + std::to_string(spill.file_bytes >> 20) + " MB with "
+                + std::to_string(spill_space >> 20) + " MB free on disk";
+        } else {
+            spill.note = "writes " + std::to_string(spill.file_bytes >> 20) + " MB, only 'neighbors' reads the result";
+        }
+    }
+    plan.candidates = {dense, forked, merge, lazy, spill};
+
+    // Fastest in-memory strategy that fits; most commands need the matrix, so the disk is used only
+    // when nothing else fits, and keeping the expression costs nothing now.
+    // Worker processes are asked for explicitly, they stand in for the dense scan on threads
+    plan.chosen = Strategy::LazyView;
+    double best = 0;
+    for (const StrategyCost &candidate : plan.candidates) {
+        if (candidate.strategy == Strategy::LazyView || candidate.strategy == Strategy::OutOfCore
+            || (candidate.strategy == Strategy::DenseMatrix && forked.available)
+            || !candidate.available || candidate.bytes > available) continue;
+        if (plan.chosen == Strategy::LazyView || candidate.seconds < best) {
+            plan.chosen = candidate.strategy;
+            best = candidate.seconds;
+        }
+    }
+    if (plan.chosen == Strategy::LazyView && spill.available && spill.bytes <= available) {
+        plan.chosen = Strategy::OutOfCore;
+    }
+    return plan;
+}
+
+SharedGraph run_plan(const OpPlan &plan, const ExprPtr &expr) {
+    const EvaluatedOperand lhs(expr->lhs);
+    const EvaluatedOperand rhs(expr->rhs);
+    const Graph &a = lhs.graph();
+    const Graph &b = rhs.graph();
+
+    if (plan.chosen == Strategy::WorkerProcesses) return run_in_processes(a, b, expr->op, plan.processes);
+    if (plan.chosen == Strategy::ListMerge) return make_shared_graph(merge_lists(a, b, expr->op));
+    return make_shared_graph(run_dense(a, b, expr->op));
+}
+
+SharedDiskGraph run_plan_out_of_core(const OpPlan &plan, const ExprPtr &expr, const std::string &dir) {
+    EvaluatedOperand lhs(expr->lhs);
+    EvaluatedOperand rhs(expr->rhs);
+
+    const std::string path = spill_path(dir);
+    graph_cartesian_product_to_file(lhs.graph(), rhs.graph(), path, std::max<std::size_t>(plan.block_bytes, 1));
+    // Temporaries go before the result is mapped
+    lhs.release();
+    rhs.release();
+    try {
+        return open_disk_graph(path, true);
+    } catch (...) {
+        std::error_code ignored;
+        std::filesystem::remove(path, ignored);
+        throw;
+    }
+}
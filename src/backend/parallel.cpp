@@ -0,0 +1,275 @@
+#include "../../include/backend/parallel.h"
+#include "../../include/backend/jobs.h"
+#include "../../include/core/trace.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+    // Roughly how many simple operations one task should do to be worth scheduling
+    constexpr long long TASK_COST = 1 << 16;
+    // Chunks per thread, a few more than one lets fast threads steal from slow ones
+    constexpr int CHUNKS_PER_THREAD = 4;
+
+    // Innermost traced scope of the caller, its loop's chunks are named after it
+    const char *task_label() {
+        return tracing::current_span != nullptr ? tracing::current_span : "parallel_for";
+    }
+
+    // One parallel_for call: chunks left to finish and the first exception thrown by body
+    struct Batch {
+        const std::function<void(int, int)> *body = nullptr;
+        // Job of the caller, its chunks report progress and stop there when it is cancelled
+        JobState *job = nullptr;
+        // Span that started the loop, its chunks show up under this name in a trace
+        const char *label = nullptr;
+        std::atomic<int> remaining{0};
+        std::mutex error_mutex;
+        std::exception_ptr error;
+    };
+
+    struct Task {
+        Batch *batch = nullptr;
+        int begin = 0;
+        int end = 0;
+    };
+
+    /**
+     * Fixed set of workers, each with its own deque of tasks
+     * The owner pushes and pops at the back, idle threads steal from the front
+     */
+    class Executor {
+    public:
+        explicit Executor(const int threads) : queues(std::max(0, threads - 1)) {
+            for (auto &queue : queues) {
+                queue = std::make_unique<Queue>();
+            }
+            workers.reserve(queues.size());
+            for (size_t i = 0; i < queues.size(); i++) {
+                workers.emplace_back(&Executor::worker_loop, this, static_cast<int>(i));
+            }
+        }
+
+        ~Executor() {
+            {
+                std::lock_guard lock(sleep_mutex);
+                stopping = true;
+            }
+            wake.notify_all();
+            for (auto &worker : workers) {
+                worker.join();
+            }
+        }
+
+        Executor(const Executor &) = delete;
+        Executor &operator=(const Executor &) = delete;
+
+        // Executor whose worker runs the calling thread, nullptr on other threads
+        static Executor *current() {
+            return owner;
+        }
+
+        // Workers plus the thread that calls run()
+        int size() const {
+            return static_cast<int>(queues.size()) + 1;
+        }
+
+        void run(const int count, const int chunks, const std::function<void(int, int)> &body) {
+            Batch batch;
+            batch.body = &body;
+            batch.job = current_job();
+            batch.label = task_label();
+            batch.remaining.store(chunks, std::memory_order_relaxed);
+
+            // Nested calls keep their chunks on the worker's own deque, outside callers spread them
+            const int self = current_worker();
+            const int step = (count + chunks - 1) / chunks;
+            for (int c = 0; c < chunks; c++) {
+                const int begin = std::min(count, c * step);
+                const int end = std::min(count, begin + step);
+                const int target = self >= 0 ? self : c % static_cast<int>(queues.size());
+                std::lock_guard lock(queues[target]->mutex);
+                queues[target]->tasks.push_back({&batch, begin, end});
+            }
+            queued.fetch_add(chunks, std::memory_order_release);
+            {
+                std::lock_guard lock(sleep_mutex);
+            }
+            wake.notify_all();
+
+            // The caller works too instead of just waiting for its chunks
+            while (batch.remaining.load(std::memory_order_acquire) > 0) {
+                Task task;
+                if (take(self, task)) {
+                    execute(task);
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+
+            if (batch.error) {
+                std::rethrow_exception(batch.error);
+            }
+        }
+
+    private:
+        struct Queue {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        std::vector<std::unique_ptr<Queue>> queues;
+        std::vector<std::thread> workers;
+        std::atomic<int> queued{0};
+        std::mutex sleep_mutex;
+        std::condition_variable wake;
+        bool stopping = false;
+
+        static thread_local Executor *owner;
+        static thread_local int worker_index;
+
+        int current_worker() const {
+            return owner == this ? worker_index : -1;
+        }
+
+        bool pop_back(const int index, Task &task) {
+            auto &queue = *queues[index];
+            std::lock_guard lock(queue.mutex);
+            if (queue.tasks.empty()) return false;
+            task = queue.tasks.back();
+            queue.tasks.pop_back();
+            return true;
+        }
+
+        bool steal(const int index, Task &task) {
+            auto &queue = *queues[index];
+            std::lock_guard lock(queue.mutex);
+            if (queue.tasks.empty()) return false;
+            task = queue.tasks.front();
+            queue.tasks.pop_front();
+            return true;
+        }
+
+        // Own deque first (newest task, still warm in cache), then the oldest task of the others
+        bool take(const int self, Task &task) {
+            if (queued.load(std::memory_order_acquire) == 0) return false;
+
+            bool found = self >= 0 && pop_back(self, task);
+            const int count = static_cast<int>(queues.size());
+            const int start = self >= 0 ? self + 1 : 0;
+            for (int i = 0; i < count && !found; i++) {
+                const int victim = (start + i) % count;
+                if (victim != self) found = steal(victim, task);
+            }
+
+            if (found) queued.fetch_sub(1, std::memory_order_relaxed);
+            return found;
+        }
+
+        static void execute(const Task &task) {
+            JobScope scope(task.batch->job);
+            TraceSpan span(task.batch->label, "task", task.begin, task.end);
+            try {
+                // Chunks are the cancellation points, the ones not started yet are skipped
+                check_cancelled();
+                (*task.batch->body)(task.begin, task.end);
+                job_progress(task.end - task.begin);
+            } catch (...) {
+                std::lock_guard lock(task.batch->error_mutex);
+                if (!task.batch->error) task.batch->error = std::current_exception();
+            }
+            task.batch->remaining.fetch_sub(1, std::memory_order_acq_rel);
+        }
+
+        void worker_loop(const int index) {
+            owner = this;
+            worker_index = index;
+            tracing::name_thread("worker " + std::to_string(index + 1));
+
+            while (true) {
+                Task task;
+                if (take(index, task)) {
+                    execute(task);
+                    continue;
+                }
+
+                std::unique_lock lock(sleep_mutex);
+                wake.wait(lock, [this] { return stopping || queued.load(std::memory_order_acquire) > 0; });
+                if (stopping) return;
+            }
+        }
+    };
+
+    thread_local Executor *Executor::owner = nullptr;
+    thread_local int Executor::worker_index = -1;
+
+    std::mutex executor_mutex;
+    int configured_threads = 0;
+    // Every parallel_for outside the workers holds a reference for its whole run, so a resize only
+    // swaps the pointer; the old executor is joined by whichever caller lets go of it last
+    std::shared_ptr<Executor> shared_executor;
+
+    std::shared_ptr<Executor> executor() {
+        std::lock_guard lock(executor_mutex);
+        if (shared_executor == nullptr) {
+            const int threads = configured_threads > 0
+                ? configured_threads
+                : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+            shared_executor = std::make_shared<Executor>(threads);
+        }
+        return shared_executor;
+    }
+}
+
+int hardware_threads() {
+    return executor()->size();
+}
+
+void set_thread_count(const int threads) {
+    std::shared_ptr<Executor> previous;
+    {
+        std::lock_guard lock(executor_mutex);
+        configured_threads = std::max(0, threads);
+        previous.swap(shared_executor);
+    }
+    // Joins the old workers here unless a running parallel_for still holds them
+    previous.reset();
+}
+
+int row_grain(const long long cost_per_row) {
+    return static_cast<int>(std::max(1LL, TASK_COST / std::max(1LL, cost_per_row)));
+}
+
+void parallel_for(const int count, const std::function<void(int, int)> &body, const int grain) {
+    if (count <= 0) {
+        return;
+    }
+
+    check_cancelled();
+    job_start_items(count);
+
+    // Nested calls stay on the executor running them, which their caller keeps alive
+    std::shared_ptr<Executor> held;
+    Executor *current = Executor::current();
+    if (current == nullptr) {
+        held = executor();
+        current = held.get();
+    }
+    Executor &pool = *current;
+    const int chunks = std::min(pool.size() * CHUNKS_PER_THREAD, std::max(1, count / std::max(1, grain)));
+    if (chunks == 1 || pool.size() == 1) {
+        TraceSpan span(task_label(), "task", 0, count);
+        body(0, count);
+        job_progress(count);
+        return;
+    }
+
+    pool.run(count, chunks, body);
+}
@@ -0,0 +1,271 @@
+#include "../../include/backend/process_workers.h"
+#include "../../include/backend/mapped_layout.h"
+#include "../../include/backend/jobs.h"
+#include "../../include/backend/parallel.h"
+#include "../../include/core/profiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <csignal>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+SharedGraph run_in_processes(const Graph &, const Graph &, GraphOp, int) {
+    throw std::runtime_error("worker processes need POSIX fork");
+}
+
+#else
+
+namespace {
+    // How often the parent looks at the workers, their progress and the cancel flag
+    constexpr auto POLL_INTERVAL = std::chrono::milliseconds(2);
+
+    // Shared between the parent and the workers at the start of the mapping
+    struct WorkerControl {
+        std::atomic<long long> next_row{0};     // first row nobody has claimed yet
+        std::atomic<long long> rows_done{0};
+    };
+    static_assert(std::atomic<long long>::is_always_lock_free, "the row counter is shared across processes");
+
+    // Everything a worker needs; built before fork, so the workers inherit it without copying
+    struct RowTask {
+        const Graph &g1;
+        const Graph &g2;
+        GraphOp op;
+        int n;
+        long long grain;                              // rows claimed at once
+        const ProductRows *product;
+        const std::vector<std::uint64_t> &offsets;   // list area of row i starts at lists + offsets[i]
+
+        WorkerControl *control;
+        int *matrix;
+        int *counts;
+        int *lists;
+
+        // Row i of the result into row and its list into out; mirrors the matrix_gen kernels
+        int *compute(const int i, int *row, int *out) const {
+            switch (op) {
+                case GraphOp::Union: {
+                    const int common = std::min(g1.n, g2.n);
+                    const Graph &larger = g1.n > g2.n ? g1 : g2;
+                    for (int j = 0; j < n; j++) {
+                        row[j] = i < common && j < common
+                            ? g1.adj_matrix[i][j] || g2.adj_matrix[i][j]
+                            : larger.adj_matrix[i][j];
+                    }
+                    // Same order as graph_union: the neighbors of g1, then the new ones of g2
+                    if (i < g1.n) out = std::copy(g1.adj_list[i].begin(), g1.adj_list[i].end(), out);
+                    if (i < g2.n) {
+                        for (const int j : g2.adj_list[i]) {
+                            if (i >= g1.n || j >= g1.n || g1.adj_matrix[i][j] != 1) *out++ = j;
+                        }
+                    }
+                    return out;
+                }
+                case GraphOp::RingSum: {
+                    for (int j = 0; j < n; j++) {
+                        const int val1 = (i < g1.n && j < g1.n) ? g1.adj_matrix[i][j] : 0;
+                        const int val2 = (i < g2.n && j < g2.n) ? g2.adj_matrix[i][j] : 0;
+                        row[j] = val1 ^ val2;
+                        // The list area ends where the next row's begins, so only neighbors are written
+                        if (row[j] == 1) *out++ = j;
+                    }
+                    return out;
+                }
+                case GraphOp::CartesianProduct: {
+                    // The mapping starts zeroed, only the neighbors are set
+                    int *end = product->fill(static_cast<std::uint64_t>(i), out);
+                    for (const int *it = out; it != end; ++it) row[*it] = 1;
+                    return end;
+                }
+                case GraphOp::Intersection:
+                    break;
+            }
+            return out;
+        }
+
+        // Body of a worker process: no allocation, no locks, nothing shared with the parent's threads
+        void work() const {
+            for (;;) {
+                const long long begin = control->next_row.fetch_add(grain);
+                if (begin >= n) return;
+                const long long end = std::min<long long>(begin + grain, n);
+                for (long long i = begin; i < end; i++) {
+                    int *list = lists + offsets[i];
+                    int *list_end = compute(static_cast<int>(i), matrix + static_cast<std::uint64_t>(i) * n, list);
+                    counts[i] = static_cast<int>(list_end - list);
+                }
+                control->rows_done.fetch_add(end - begin);
+            }
+        }
+    };
+
+    // Stops and reaps every worker that is still running
+    void kill_workers(std::vector<pid_t> &workers) {
+        for (const pid_t pid : workers) kill(pid, SIGKILL);
+        for (const pid_t pid : workers) {
+            while (waitpid(pid, nullptr, 0) < 0 && errno == EINTR) {}
+        }
+        workers.clear();
+    }
+}
+
+SharedGraph run_in_processes(const Graph &g1, const Graph &g2, const GraphOp op, const int processes) {
+    static ProfileSite& site = profile_site("backend", "run_in_processes");
+    ProfileScope scope(site);
+
+    if (op == GraphOp::Intersection) {
+        throw std::invalid_argument("worker processes run union, ring sum and product only");
+    }
+    const int n = op == GraphOp::CartesianProduct ? product_vertex_count(g1.n, g2.n) : std::max(g1.n, g2.n);
+    const auto wide_n = static_cast<std::uint64_t>(n);
+    job_expect(2LL * n);
+
+    // List area per row: an upper bound known before any row is computed
+    std::unique_ptr<ProductRows> product;
+    if (op == GraphOp::CartesianProduct) product = std::make_unique<ProductRows>(g1, g2);
+    std::vector<std::uint64_t> offsets(static_cast<std::size_t>(n) + 1, 0);
+    for (int i = 0; i < n; i++) {
+        std::uint64_t capacity;
+        if (product != nullptr) capacity = product->degree(i);
+        else capacity = (i < g1.n ? g1.adj_list[i].size() : 0) + (i < g2.n ? g2.adj_list[i].size() : 0);
+        offsets[i + 1] = offsets[i] + capacity;
+    }
+
+    const std::uint64_t matrix_offset = align_section(sizeof(WorkerControl));
+    const std::uint64_t counts_offset = align_section(matrix_offset + wide_n * wide_n * sizeof(int));
+    const std::uint64_t lists_offset = align_section(counts_offset + wide_n * sizeof(int));
+    const std::uint64_t total_bytes = lists_offset + offsets[n] * sizeof(int);
+
+    // Anonymous shared pages start zeroed and stay shared across fork
+    void *base = mmap(nullptr, total_bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) {
+        throw std::runtime_error("cannot map " + std::to_string(total_bytes >> 20) + " MB for worker processes: "
+            + std::strerror(errno));
+    }
+    auto *bytes = static_cast<char *>(base);
+    auto *control = new (base) WorkerControl();
+    const long long grain = row_grain(n);
+    const RowTask task{g1, g2, op, n, grain, product.get(), offsets, control,
+        reinterpret_cast<int *>(bytes + matrix_offset), reinterpret_cast<int *>(bytes + counts_offset),
+        reinterpret_cast<int *>(bytes + lists_offset)};
+
+    static ProfileSite& workers_site = profile_site("backend", "run_in_processes: workers");
+    ProfileScope workers_scope(workers_site);
+
+    // Never more workers than claims, each one maps the output and faults in its own rows
+    const long long claims = (n + grain - 1) / grain;
+    const int count = static_cast<int>(std::clamp<long long>(claims, 1, std::max(1, processes)));
+    std::vector<pid_t> workers;
+    try {
+        job_start_items(n);
+        for (int k = 0; k < count; k++) {
+            const pid_t pid = fork();
+            if (pid == 0) {
+                // Only this thread exists in the child; _exit skips the parent's atexit handlers and stream buffers
+                task.work();
+                _exit(0);
+            }
+            if (pid < 0) {
+                throw std::runtime_error(std::string("cannot start a worker process: ") + std::strerror(errno));
+            }
+            workers.push_back(pid);
+        }
+
+        long long reported = 0;
+        std::string failure;
+        while (!workers.empty()) {
+            std::this_thread::sleep_for(POLL_INTERVAL);
+            const long long done = control->rows_done.load();
+            job_progress(done - reported);
+            reported = done;
+            check_cancelled();
+
+            for (auto it = workers.begin(); it != workers.end();) {
+                int status = 0;
+                const pid_t finished = waitpid(*it, &status, WNOHANG);
+                if (finished == 0 || (finished < 0 && errno == EINTR)) {
+                    ++it;
+                    continue;
+                }
+                if (finished > 0 && !(WIFEXITED(status) && WEXITSTATUS(status) == 0) && failure.empty()) {
+                    failure = WIFSIGNALED(status) ? "a worker process was killed by signal "
+                        + std::to_string(WTERMSIG(status)) : "a worker process failed";
+                }
+                it = workers.erase(it);
+            }
+            if (!failure.empty()) throw std::runtime_error(failure);
+        }
+    } catch (...) {
+        kill_workers(workers);
+        munmap(base, total_bytes);
+        throw;
+    }
+    workers_scope.finish();
+
+    static ProfileSite& lists_site = profile_site("backend", "run_in_processes: lists");
+    ProfileScope lists_scope(lists_site);
+
+    auto *graph = new Graph();
+    graph->n = n;
+    graph->read_only = true;
+    try {
+        // Rows stay in the mapping, only the row pointers and the list vectors are ours
+        graph->adj_matrix = new int*[n];
+        graph->adj_list.resize(n);
+        parallel_for(n, [&](const int begin, const int end) {
+            for (int i = begin; i < end; i++) {
+                graph->adj_matrix[i] = task.matrix + static_cast<std::uint64_t>(i) * n;
+                const int *list = task.lists + offsets[i];
+                graph->adj_list[i].assign(list, list + task.counts[i]);
+            }
+        }, row_grain(n / 8 + 1));
+    } catch (...) {
+        delete[] graph->adj_matrix;
+        delete graph;
+        munmap(base, total_bytes);
+        throw;
+    }
+    lists_scope.finish();
+
+    SharedGraph result(graph, [base, total_bytes](Graph *g) {
+        delete[] g->adj_matrix;
+        munmap(base, total_bytes);
+        delete g;
+    });
+    if (op != GraphOp::RingSum) {
+        return result;
+    }
+
+    // ring_sum drops vertices without edges to others; that renumbers everything, so it goes through a copy
+    std::vector<char> has_real_edges(n, 0);
+    for (int i = 0; i < n; i++) {
+        for (const int j : result->adj_list[i]) {
+            if (j != i) has_real_edges[i] = has_real_edges[j] = 1;
+        }
+    }
+    if (std::ranges::find(has_real_edges, 0) == has_real_edges.end()) {
+        return result;
+    }
+    Graph copy = copy_graph(*result);
+    result.reset();
+    GraphBuildGuard guard(copy);
+    return make_shared_graph(drop_isolated_vertices(copy));
+}
+
+#endif
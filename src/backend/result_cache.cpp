@@ -0,0 +1,116 @@
+#include "../../include/backend/result_cache.h"
+
+SharedGraph make_shared_graph(Graph &&graph) {
+    return {new Graph(std::move(graph)), [](Graph* g) {
+        delete_graph(*g, g->n);
+        delete g;
+    }};
+}
+
+std::size_t graph_bytes(const Graph &graph) {
+    const auto n = static_cast<std::size_t>(graph.n);
+    std::size_t bytes = n * n * sizeof(int) + n * sizeof(int*);
+    for (const auto &neighbors : graph.adj_list) {
+        bytes += sizeof(neighbors) + neighbors.capacity() * sizeof(int);
+    }
+    return bytes;
+}
+
+std::size_t ResultCache::KeyHash::operator()(const Key &key) const {
+    std::size_t h = std::hash<std::uint64_t>{}(key.v1);
+    h ^= std::hash<std::uint64_t>{}(key.v2) + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+    h ^= static_cast<std::size_t>(key.op) + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+    return h;
+}
+
+ResultCache::ResultCache(const std::size_t limit) : budget_bytes(limit) {}
+
+SharedGraph ResultCache::find(const GraphOp op, const std::uint64_t v1, const std::uint64_t v2) {
+    std::lock_guard lock(mutex);
+    const auto it = index.find(Key{op, v1, v2});
+    if (it == index.end()) {
+        misses++;
+        return nullptr;
+    }
+
+    hits++;
+    entries.splice(entries.begin(), entries, it->second);
+    return it->second->result;
+}
+
+void ResultCache::insert(const GraphOp op, const std::uint64_t v1, const std::uint64_t v2, const SharedGraph &result) {
+    const Key key{op, v1, v2};
+    std::lock_guard lock(mutex);
+    if (const auto it = index.find(key); it != index.end()) {
+        used_bytes -= it->second->bytes;
+        entries.erase(it->second);
+        index.erase(it);
+    }
+
+    // A result bigger than the whole budget would only flush everything else
+    const std::size_t bytes = graph_bytes(*result);
+    if (bytes > budget_bytes) {
+        return;
+    }
+
+    entries.push_front(Entry{key, result, bytes});
+    index[key] = entries.begin();
+    used_bytes += bytes;
+    evict();
+}
+
+void ResultCache::clear() {
+    std::lock_guard lock(mutex);
+    entries.clear();
+    index.clear();
+    used_bytes = 0;
+}
+
+void ResultCache::set_budget(const std::size_t limit) {
+    std::lock_guard lock(mutex);
+    budget_bytes = limit;
+    evict();
+}
+
+std::size_t ResultCache::budget() const {
+    std::lock_guard lock(mutex);
+    return budget_bytes;
+}
+
+std::size_t ResultCache::used() const {
+    std::lock_guard lock(mutex);
+    return used_bytes;
+}
+
+std::size_t ResultCache::exclusive() const {
+    std::lock_guard lock(mutex);
+    std::size_t bytes = 0;
+    for (const Entry &entry : entries) {
+        if (entry.result.use_count() == 1) bytes += entry.bytes;
+    }
+    return bytes;
+}
+
+std::size_t ResultCache::size() const {
+    std::lock_guard lock(mutex);
+    return entries.size();
+}
+
+std::size_t ResultCache::hit_count() const {
+    std::lock_guard lock(mutex);
+    return hits;
+}
+
+std::size_t ResultCache::miss_count() const {
+    std::lock_guard lock(mutex);
+    return misses;
+}
+
+// Called with the mutex held
+void ResultCache::evict() {
+    while (used_bytes > budget_bytes && !entries.empty()) {
+        used_bytes -= entries.back().bytes;
+        index.erase(entries.back().key);
+        entries.pop_back();
+    }
+}
@@ -0,0 +1,201 @@
+#include "../../include/backend/shared_store.h"
+#include "../../include/backend/mapped_layout.h"
+#include "../../include/backend/parallel.h"
+#include "../../include/core/profiler.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+std::string shared_object_name(const std::string &name) {
+    return !name.empty() && name[0] == '/' ? name : "/" + name;
+}
+
+#ifdef _WIN32
+
+std::size_t publish_graph(const Graph &, const std::string &) {
+    throw std::runtime_error("shared-memory graphs need POSIX shared memory");
+}
+
+SharedGraph attach_graph(const std::string &) {
+    throw std::runtime_error("shared-memory graphs need POSIX shared memory");
+}
+
+bool unpublish_graph(const std::string &) {
+    return false;
+}
+
+#else
+
+namespace {
+    constexpr char STORE_MAGIC[8] = {'L', 'A', 'B', '6', 'G', 'R', 'P', 'H'};
+    constexpr std::uint32_t STORE_LAYOUT = 1;
+
+    // Start of the object; every position is an offset from here, so any mapping address works
+    struct StoreHeader {
+        char magic[8];
+        std::uint32_t layout;
+        std::int32_t n;
+        std::uint64_t matrix_offset;        // n * n ints, row by row
+        std::uint64_t list_offsets_offset;  // n + 1 uint64, list i is neighbors[offsets[i] .. offsets[i + 1])
+        std::uint64_t neighbors_offset;     // neighbor_count ints
+        std::uint64_t neighbor_count;
+        std::uint64_t total_bytes;
+    };
+}
+
+std::size_t publish_graph(const Graph &graph, const std::string &name) {
+    static ProfileSite& site = profile_site("backend", "publish_graph");
+    ProfileScope scope(site);
+
+    const std::string object = shared_object_name(name);
+    const auto n = static_cast<std::uint64_t>(graph.n);
+
+    StoreHeader header{};
+    std::memcpy(header.magic, STORE_MAGIC, sizeof(STORE_MAGIC));
+    header.layout = STORE_LAYOUT;
+    header.n = graph.n;
+    for (const auto &neighbors : graph.adj_list) {
+        header.neighbor_count += neighbors.size();
+    }
+    header.matrix_offset = align_section(sizeof(StoreHeader));
+    header.list_offsets_offset = align_section(header.matrix_offset + n * n * sizeof(int));
+    header.neighbors_offset = align_section(header.list_offsets_offset + (n + 1) * sizeof(std::uint64_t));
+    header.total_bytes = header.neighbors_offset + header.neighbor_count * sizeof(int);
+
+    const int fd = shm_open(object.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        throw system_error("cannot create", object);
+    }
+
+    // Reserve the pages now: a full /dev/shm would otherwise show up as SIGBUS while filling
+    bool sized = ftruncate(fd, static_cast<off_t>(header.total_bytes)) == 0;
+#ifdef __linux__
+    if (sized && (errno = posix_fallocate(fd, 0, static_cast<off_t>(header.total_bytes))) != 0) sized = false;
+#endif
+    void *base = sized ? mmap(nullptr, header.total_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    if (base == MAP_FAILED) {
+        const std::runtime_error error = system_error("cannot allocate", object);
+        close(fd);
+        shm_unlink(object.c_str());
+        throw error;
+    }
+    close(fd);
+
+    auto *bytes = static_cast<char *>(base);
+    const auto matrix = reinterpret_cast<int *>(bytes + header.matrix_offset);
+    const auto offsets = reinterpret_cast<std::uint64_t *>(bytes + header.list_offsets_offset);
+    const auto neighbors = reinterpret_cast<int *>(bytes + header.neighbors_offset);
+
+    offsets[0] = 0;
+    for (std::uint64_t i = 0; i < n; i++) {
+        offsets[i + 1] = offsets[i] + graph.adj_list[i].size();
+    }
+
+    try {
+        parallel_for(graph.n, [&](const int begin, const int end) {
+            for (int i = begin; i < end; i++) {
+                std::copy_n(graph.adj_matrix[i], graph.n, matrix + static_cast<std::uint64_t>(i) * n);
+                std::copy(graph.adj_list[i].begin(), graph.adj_list[i].end(), neighbors + offsets[i]);
+            }
+        }, row_grain(graph.n));
+    } catch (...) {
+        munmap(base, header.total_bytes);
+        shm_unlink(object.c_str());
+        throw;
+    }
+
+    // The header goes in last, until then attach() sees no magic and refuses the object
+    std::memcpy(base, &header, sizeof(header));
+    munmap(base, header.total_bytes);
+    return header.total_bytes;
+}
+
+SharedGraph attach_graph(const std::string &name) {
+    static ProfileSite& site = profile_site("backend", "attach_graph");
+    ProfileScope scope(site);
+
+    const std::string object = shared_object_name(name);
+    const int fd = shm_open(object.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        throw system_error("cannot open", object);
+    }
+
+    struct stat info{};
+    if (fstat(fd, &info) != 0 || static_cast<std::uint64_t>(info.st_size) < sizeof(StoreHeader)) {
+        close(fd);
+        throw std::runtime_error(object + " is not a published graph");
+    }
+    const auto size = static_cast<std::uint64_t>(info.st_size);
+    void *base = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        throw system_error("cannot map", object);
+    }
+
+    const auto *bytes = static_cast<const char *>(base);
+    StoreHeader header{};
+    std::memcpy(&header, bytes, sizeof(header));
+
+    // Offsets come from another process, everything is checked against the object size
+    const auto n = static_cast<std::uint64_t>(header.n);
+    const bool valid = std::memcmp(header.magic, STORE_MAGIC, sizeof(STORE_MAGIC)) == 0
+        && header.layout == STORE_LAYOUT && header.n >= 0 && header.total_bytes <= size
+        && (n == 0 || size / sizeof(int) / n >= n)
+        && header.matrix_offset + n * n * sizeof(int) <= size
+        && header.list_offsets_offset + (n + 1) * sizeof(std::uint64_t) <= size
+        && header.neighbors_offset <= size
+        && header.neighbor_count <= (size - header.neighbors_offset) / sizeof(int);
+    if (!valid) {
+        munmap(base, size);
+        throw std::runtime_error(object + " is not a published graph");
+    }
+
+    const auto matrix = reinterpret_cast<const int *>(bytes + header.matrix_offset);
+    const auto offsets = reinterpret_cast<const std::uint64_t *>(bytes + header.list_offsets_offset);
+    const auto neighbors = reinterpret_cast<const int *>(bytes + header.neighbors_offset);
+
+    auto *graph = new Graph();
+    graph->n = header.n;
+    graph->read_only = true;
+    try {
+        graph->adj_list.resize(n);
+        for (std::uint64_t i = 0; i < n; i++) {
+            if (offsets[i] > offsets[i + 1] || offsets[i + 1] > header.neighbor_count) {
+                throw std::runtime_error(object + " has broken adjacency lists");
+            }
+            graph->adj_list[i].assign(neighbors + offsets[i], neighbors + offsets[i + 1]);
+        }
+
+        // Rows stay in the read-only mapping, only the row pointers are ours
+        graph->adj_matrix = new int*[n];
+        for (std::uint64_t i = 0; i < n; i++) {
+            graph->adj_matrix[i] = const_cast<int *>(matrix + i * n);
+        }
+    } catch (...) {
+        delete graph;
+        munmap(base, size);
+        throw;
+    }
+
+    return {graph, [base, size](Graph *g) {
+        delete[] g->adj_matrix;
+        munmap(base, size);
+        delete g;
+    }};
+}
+
+bool unpublish_graph(const std::string &name) {
+    return shm_unlink(shared_object_name(name).c_str()) == 0;
+}
+
+#endif
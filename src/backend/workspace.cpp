@@ -0,0 +1,173 @@
+#include "../../include/backend/workspace.h"
+
+#include <ranges>
+#include <unordered_set>
+
+bool Workspace::contains(const std::string &name) const {
+    std::lock_guard lock(mutex);
+    return slots.contains(name);
+}
+
+bool Workspace::is_pending(const std::string &name) const {
+    std::lock_guard lock(mutex);
+    const auto it = slots.find(name);
+    return it != slots.end() && it->second.pending != nullptr;
+}
+
+std::vector<std::string> Workspace::names() const {
+    std::lock_guard lock(mutex);
+    std::vector<std::string> result;
+    result.reserve(slots.size());
+    for (const auto &name : slots | std::views::keys) {
+        result.push_back(name);
+    }
+    return result;
+}
+
+Graph* Workspace::get(const std::string &name) {
+    std::unique_lock lock(mutex);
+    auto it = slots.find(name);
+    if (it == slots.end()) {
+        return nullptr;
+    }
+
+    // Evaluated without the lock, other slots stay usable meanwhile
+    if (const ExprPtr pending = it->second.pending) {
+        lock.unlock();
+        SharedGraph graph = make_shared_graph(evaluate(pending));
+        lock.lock();
+
+        it = slots.find(name);
+        if (it == slots.end()) {
+            return nullptr;
+        }
+        // Another reader may have materialized it first, its graph is kept
+        if (GraphSlot &slot = it->second; slot.pending == pending) {
+            slot.graph = std::move(graph);
+            slot.pending.reset();
+            invalidate(slot.cache);
+        }
+    }
+    return it->second.graph.get();
+}
+
+Graph* Workspace::get_for_write(const std::string &name) {
+    Graph* graph = get(name);
+    if (graph == nullptr) {
+        return nullptr;
+    }
+
+    // Someone else (result cache, expression leaf, another process) still sees the old contents
+    std::lock_guard lock(mutex);
+    GraphSlot &slot = slots.at(name);
+    if (slot.graph.use_count() > 1 || graph->read_only) {
+        slot.graph = make_shared_graph(copy_graph(*graph));
+    }
+    return slot.graph.get();
+}
+
+ExprPtr Workspace::operand(const std::string &name) const {
+    std::lock_guard lock(mutex);
+    const auto it = slots.find(name);
+    if (it == slots.end()) {
+        return nullptr;
+    }
+    if (it->second.pending != nullptr) {
+        return it->second.pending;
+    }
+    if (it->second.graph == nullptr) {
+        return nullptr;
+    }
+    return expr_leaf(it->second.graph.get(), name, it->second.graph);
+}
+
+ConnectivityCache* Workspace::cache(const std::string &name) {
+    std::lock_guard lock(mutex);
+    const auto it = slots.find(name);
+    return it != slots.end() ? &it->second.cache : nullptr;
+}
+
+std::vector<int>* Workspace::labels(const std::string &name) {
+    std::lock_guard lock(mutex);
+    const auto it = slots.find(name);
+    return it != slots.end() ? &it->second.labels : nullptr;
+}
+
+void Workspace::put(const std::string &name, SharedGraph graph) {
+    // The old graph is released after unlocking, freeing a big matrix takes a while
+    std::lock_guard lock(mutex);
+    GraphSlot &slot = slots[name];
+    slot.graph.swap(graph);
+    slot.pending.reset();
+    slot.disk.reset();
+    invalidate(slot.cache);
+    slot.labels.clear();
+}
+
+void Workspace::put_pending(const std::string &name, ExprPtr expr) {
+    std::lock_guard lock(mutex);
+    GraphSlot &slot = slots[name];
+    slot.graph.reset();
+    slot.pending = std::move(expr);
+    slot.disk.reset();
+    invalidate(slot.cache);
+    slot.labels.clear();
+}
+
+void Workspace::put_disk(const std::string &name, SharedDiskGraph graph) {
+    std::lock_guard lock(mutex);
+    GraphSlot &slot = slots[name];
+    slot.graph.reset();
+    slot.pending.reset();
+    slot.disk.swap(graph);
+    invalidate(slot.cache);
+    slot.labels.clear();
+}
+
+SharedDiskGraph Workspace::disk(const std::string &name) const {
+    std::lock_guard lock(mutex);
+    const auto it = slots.find(name);
+    return it != slots.end() ? it->second.disk : nullptr;
+}
+
+bool Workspace::erase(const std::string &name) {
+    std::lock_guard lock(mutex);
+    return slots.erase(name) > 0;
+}
+
+void Workspace::clear() {
+    std::lock_guard lock(mutex);
+    slots.clear();
+}
+
+std::size_t Workspace::bytes(const std::string &name) const {
+    std::lock_guard lock(mutex);
+    return bytes_locked(name);
+}
+
+GraphFootprint Workspace::footprint(const std::string &name) const {
+    std::lock_guard lock(mutex);
+    const auto it = slots.find(name);
+    if (it == slots.end() || it->second.graph == nullptr) {
+        return {};
+    }
+    return graph_footprint(*it->second.graph);
+}
+
+std::size_t Workspace::total_bytes() const {
+    std::lock_guard lock(mutex);
+    std::size_t total = 0;
+    std::unordered_set<const Graph*> counted;
+    for (const auto &[name, slot] : slots) {
+        if (counted.insert(slot.graph.get()).second) total += bytes_locked(name);
+    }
+    return total;
+}
+
+std::size_t Workspace::bytes_locked(const std::string &name) const {
+    const auto it = slots.find(name);
+    if (it == slots.end() || it->second.graph == nullptr) {
+        return 0;
+    }
+    return graph_bytes(*it->second.graph);
+}
@@ -120,6 +120,15 @@ ConsoleConfig ConfigLoader::load_from_file(const std::string &filename) {
             else if (key == "show_help_on_unknown") config.show_help_on_unknown = parse_bool(value);
             else if (key == "clear_screen_on_start") config.clear_screen_on_start = parse_bool(value);
             else if (key == "history_size") config.history_size = std::stoi(value);
+            else if (key == "cache_budget_mb") config.cache_budget_mb = std::stoi(value);
+            else if (key == "memory_budget_mb") config.memory_budget_mb = std::stoi(value);
+            else if (key == "out_of_core") config.out_of_core = parse_bool(value);
+            else if (key == "spill_dir") config.spill_dir = value;
+            else if (key == "threads") config.threads = std::stoi(value);
+            else if (key == "worker_processes") config.worker_processes = std::stoi(value);
+            else if (key == "huge_pages") config.huge_pages = parse_bool(value);
+            else if (key == "server_connections") config.server_connections = std::stoi(value);
+            else if (key == "profiling") config.profiling = parse_bool(value);
         }
     }
 
@@ -140,7 +149,16 @@ bool ConfigLoader::save_config(const ConsoleConfig &config, const std::string &f
     file << "enable_colors = " << (config.colors_enabled ? "true" : "false") << "\n";
     file << "show_help_on_unknown = " << (config.show_help_on_unknown ? "true" : "false") << "\n";
     file << "clear_screen_on_start = " << (config.clear_screen_on_start ? "true" : "false") << "\n";
-    file << "history_size = " << config.history_size << "\n\n";
+    file << "history_size = " << config.history_size << "\n";
+    file << "cache_budget_mb = " << config.cache_budget_mb << "\n";
+    file << "memory_budget_mb = " << config.memory_budget_mb << "\n";
+    file << "out_of_core = " << (config.out_of_core ? "true" : "false") << "\n";
+    if (!config.spill_dir.empty()) file << "spill_dir = " << config.spill_dir << "\n";
+    file << "threads = " << config.threads << "\n";
+    file << "worker_processes = " << config.worker_processes << "\n";
+    file << "huge_pages = " << (config.huge_pages ? "true" : "false") << "\n";
+    file << "server_connections = " << config.server_connections << "\n";
+    file << "profiling = " << (config.profiling ? "true" : "false") << "\n\n";
 
     for (const auto& cmd : config.commands) {
         file << "[command]\n";
@@ -1,9 +1,106 @@
 #include "../include/adapters/console_adapter.h"
+#include "../include/adapters/graph_server.h"
+
+#include <fstream>
+
+#ifdef _WIN32
+#include <io.h>
+#define stdin_is_terminal() (_isatty(_fileno(stdin)) != 0)
+#else
+#include <unistd.h>
+#define stdin_is_terminal() (isatty(STDIN_FILENO) != 0)
+#endif
+
+static void print_usage(const char* program) {
+    std::cerr << "Usage: " << program << " [--script <file>] [--fail-fast] [--parallel] [--interactive] [--trace <file>]\n"
+              << "       " << program << " --serve <socket>\n"
+              << "       " << program << " --connect <socket> [--script <file>] [--fail-fast]\n"
+              << "  --script <file>  Run commands from file without prompts and colors\n"
+              << "  --fail-fast      Stop a script at the first failing command\n"
+              << "  --parallel       Run script lines on different graphs at the same time\n"
+              << "  --interactive    Prompt for commands even if stdin is not a terminal\n"
+              << "  --serve <socket> Keep one workspace and serve commands on a Unix-domain socket\n"
+              << "  --connect <socket> Send commands to a server and print its responses\n"
+              << "  --trace <file>   Record a Chrome/Perfetto trace of the whole run into file\n"
+              << "Piped stdin is run like a script.\n";
+}
 
 int main(int argc, char* argv[]) {
+    std::string script;
+    bool interactive = stdin_is_terminal();
+    bool stop_on_error = false;
+    bool parallel = false;
+    std::string serve_path;
+    std::string connect_path;
+    std::string trace_path;
+
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (arg == "--script" && i + 1 < argc) {
+            script = argv[++i];
+            interactive = false;
+        } else if (arg == "--fail-fast") {
+            stop_on_error = true;
+        } else if (arg == "--serve" && i + 1 < argc) {
+            serve_path = argv[++i];
+        } else if (arg == "--connect" && i + 1 < argc) {
+            connect_path = argv[++i];
+            interactive = false;
+        } else if (arg == "--parallel") {
+            parallel = true;
+        } else if (arg == "--trace" && i + 1 < argc) {
+            trace_path = argv[++i];
+        } else if (arg == "--interactive") {
+            interactive = true;
+        } else {
+            print_usage(argv[0]);
+            return 2;
+        }
+    }
+
+    // Batch output is block buffered and reading input no longer flushes it
+    if (!interactive || !serve_path.empty()) {
+        std::ios::sync_with_stdio(false);
+        std::cin.tie(nullptr);
+    }
+
     try {
+        std::ifstream file;
+        if (!script.empty()) {
+            file.open(script);
+            if (!file.is_open()) {
+                std::cerr << "Error: cannot open script " << script << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        std::istream& input = script.empty() ? std::cin : file;
+
+        // The client only forwards lines, the graphs live in the server process
+        if (!connect_path.empty()) {
+            return run_client(connect_path, input, stop_on_error);
+        }
+
         GraphConsoleAdapter console;
-        console.run();
+        if (!trace_path.empty()) {
+            tracing::start();
+        }
+
+        int status;
+        if (!serve_path.empty()) {
+            status = console.serve(serve_path);
+        } else if (interactive) {
+            console.run();
+            status = 0;
+        } else {
+            status = console.run_script(input, stop_on_error, parallel);
+        }
+
+        std::uint64_t events = 0;
+        if (!trace_path.empty() && !tracing::save(trace_path, events)) {
+            std::cerr << "Error: cannot write trace to " << trace_path << std::endl;
+            status = EXIT_FAILURE;
+        }
+        return status;
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
         return EXIT_FAILURE;
@@ -11,5 +108,4 @@ int main(int argc, char* argv[]) {
         std::cerr << "Unknown exception" << std::endl;
         return EXIT_FAILURE;
     }
-    return 0;
 }
@@ -0,0 +1,183 @@
+#include "adapters/console_adapter.h"
+#include "backend/shared_store.h"
+#include "test_graphs.h"
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+
+using namespace test_graphs;
+
+namespace {
+    // Console with a few commands that record what ran, output captured per test
+    class BatchConsole : public testing::Test {
+    protected:
+        Console console;
+        std::ostringstream output;
+        std::vector<std::string> ran;
+
+        void SetUp() override {
+            console.register_command("note", [this](const std::vector<std::string>& args) {
+                ran.push_back(args.empty() ? "" : args[0]);
+                Console::out() << "noted " << ran.back() << '\n';
+            });
+            console.register_command("fail", [this](const std::vector<std::string>&) {
+                ran.push_back("fail");
+                console.mark_failed();
+            });
+            console.register_command("throw", [](const std::vector<std::string>&) {
+                throw std::runtime_error("broken");
+            });
+            console.register_alias("n", "note");
+            Console::redirect_output(&output);
+        }
+
+        void TearDown() override {
+            Console::redirect_output(nullptr);
+        }
+
+        int run(const std::string& script, const bool stop_on_error = false) {
+            std::istringstream in(script);
+            return console.run_batch(in, stop_on_error);
+        }
+    };
+
+    std::string object_name(const std::string& suffix) {
+        return "/lab6_test_" + std::to_string(getpid()) + "_" + suffix;
+    }
+
+    // Publishes the operands, runs the script through the adapter and attaches what it published as R
+    SharedGraph run_adapter_script(const Graph& a, const Graph& b, const std::string& commands, const bool parallel) {
+        const std::string name_a = object_name("a");
+        const std::string name_b = object_name("b");
+        const std::string name_r = object_name("r");
+        publish_graph(a, name_a);
+        publish_graph(b, name_b);
+
+        const std::string script = "# operands\nattach " + name_a + " -> A\n\nattach " + name_b + " -> B\n"
+                                   + commands + "publish R " + name_r + "\n";
+        std::istringstream in(script);
+        std::ostringstream output;
+        int status;
+        {
+            GraphConsoleAdapter adapter(RESOURCES_PATH "/config_files/graph_console.conf",
+                                        RESOURCES_PATH "/config_files/aliases.conf");
+            Console::redirect_output(&output);
+            status = adapter.run_script(in, true, parallel);
+            Console::redirect_output(nullptr);
+        }
+
+        unpublish_graph(name_a);
+        unpublish_graph(name_b);
+        EXPECT_EQ(status, EXIT_SUCCESS) << output.str();
+        SharedGraph result = status == EXIT_SUCCESS ? attach_graph(name_r) : nullptr;
+        unpublish_graph(name_r);
+        return result;
+    }
+}
+
+TEST_F(BatchConsole, SkipsCommentsAndBlankLines) {
+    EXPECT_EQ(run("# header\n\nnote a\n   \n  # indented comment\n\tnote b\r\n"), 0);
+    EXPECT_EQ(ran, (std::vector<std::string>{"a", "b"}));
+    EXPECT_EQ(output.str(), "noted a\nnoted b\n");
+}
+
+TEST_F(BatchConsole, AliasesResolve) {
+    EXPECT_EQ(run("n x\nnote y\n"), 0);
+    EXPECT_EQ(ran, (std::vector<std::string>{"x", "y"}));
+}
+
+TEST_F(BatchConsole, CountsFailuresAndKeepsGoing) {
+    EXPECT_EQ(run("fail\nnote a\nmissing\nthrow\nnote b\n"), 3);
+    EXPECT_EQ(ran, (std::vector<std::string>{"fail", "a", "b"}));
+    EXPECT_NE(output.str().find("broken"), std::string::npos);
+    EXPECT_FALSE(console.is_running());
+}
+
+TEST_F(BatchConsole, StopOnErrorStopsAtFirstFailure) {
+    EXPECT_EQ(run("note a\nmissing\nnote b\n", true), 1);
+    EXPECT_EQ(ran, (std::vector<std::string>{"a"}));
+}
+
+TEST_F(BatchConsole, ExitEndsTheScript) {
+    EXPECT_EQ(run("note a\nexit\nnote b\n"), 0);
+    EXPECT_EQ(ran, (std::vector<std::string>{"a"}));
+    // Batch mode prints no goodbye
+    EXPECT_EQ(output.str(), "noted a\n");
+}
+
+TEST_F(BatchConsole, ExecuteReportsTheLine) {
+    console.start_batch();
+    EXPECT_FALSE(console.execute("note a"));
+    EXPECT_TRUE(console.execute("fail"));
+    EXPECT_FALSE(console.execute("note b"));
+    EXPECT_EQ(console.failure_count(), 1);
+}
+
+TEST(BatchHelpers, BlankOrComment) {
+    EXPECT_TRUE(Console::is_blank_or_comment(""));
+    EXPECT_TRUE(Console::is_blank_or_comment(" \t\r"));
+    EXPECT_TRUE(Console::is_blank_or_comment("  # note"));
+    EXPECT_FALSE(Console::is_blank_or_comment("note # trailing"));
+}
+
+TEST(BatchScript, AdapterMatchesEagerKernels) {
+    for (const unsigned int seed : SEEDS) {
+        for (const auto &[n1, n2] : SIZE_PAIRS) {
+            SCOPED_TRACE(testing::Message() << "seed " << seed << ", sizes " << n1 << " and " << n2);
+            const SharedGraph a = random_graph(n1, seed);
+            const SharedGraph b = random_graph(n2, seed + 100);
+            const SharedGraph both = make_shared_graph(graph_union(*a, *b));
+            const SharedGraph common = make_shared_graph(graph_intersection(*a, *b));
+            const SharedGraph expected = make_shared_graph(ring_sum(*both, *common));
+
+            // Union minus intersection in three steps, each reading what the one before wrote
+            const SharedGraph result = run_adapter_script(*a, *b,
+                "union A B -> U\nintersect A B -> I\nring U I -> R\n", false);
+            ASSERT_NE(result, nullptr);
+            expect_same_graph(*expected, *result);
+        }
+    }
+}
+
+TEST(BatchScript, ParallelRunMatchesSequentialRun) {
+    // Union and intersection are independent and may overlap, the ring waits for both
+    for (const unsigned int seed : SEEDS) {
+        for (const auto &[n1, n2] : SIZE_PAIRS) {
+            SCOPED_TRACE(testing::Message() << "seed " << seed << ", sizes " << n1 << " and " << n2);
+            const SharedGraph a = random_graph(n1, seed);
+            const SharedGraph b = random_graph(n2, seed + 100);
+            const std::string commands = "union A B -> U\nintersect A B -> I\nring U I -> R\n";
+            const SharedGraph sequential = run_adapter_script(*a, *b, commands, false);
+            const SharedGraph parallel = run_adapter_script(*a, *b, commands, true);
+            ASSERT_NE(sequential, nullptr);
+            ASSERT_NE(parallel, nullptr);
+            expect_same_graph(*sequential, *parallel);
+        }
+    }
+}
+
+TEST(BatchScript, MissingGraphFailsTheScript) {
+    std::istringstream in("union A B -> C\nprint C\n");
+    std::ostringstream output;
+    GraphConsoleAdapter adapter(RESOURCES_PATH "/config_files/graph_console.conf",
+                                RESOURCES_PATH "/config_files/aliases.conf");
+    Console::redirect_output(&output);
+    const int status = adapter.run_script(in, true, false);
+    Console::redirect_output(nullptr);
+    EXPECT_EQ(status, EXIT_FAILURE);
+}
+
+TEST(BatchScript, ContractWithoutAnEdgeFails) {
+    // Practically no edges, so vertices 0 and 1 are not adjacent
+    std::istringstream in("create 4 0.000000001 0.5 -> A\ncontract A 0 1\n");
+    std::ostringstream output;
+    GraphConsoleAdapter adapter(RESOURCES_PATH "/config_files/graph_console.conf",
+                                RESOURCES_PATH "/config_files/aliases.conf");
+    Console::redirect_output(&output);
+    const int status = adapter.run_script(in, false, false);
+    Console::redirect_output(nullptr);
+    EXPECT_EQ(status, EXIT_FAILURE);
+    EXPECT_NE(output.str().find("No such edge"), std::string::npos) << output.str();
+}
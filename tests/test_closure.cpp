@@ -0,0 +1,133 @@
+#include "backend/graph_closure.h"
+#include "test_graphs.h"
+
+#include <queue>
+#include <random>
+
+using namespace test_graphs;
+
+namespace {
+    // Warshall over the matrix: reachability by paths of one edge or more
+    std::vector<std::vector<char>> reference_closure(const Graph &graph) {
+        const int n = graph.n;
+        std::vector reach(n, std::vector<char>(n, 0));
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < n; j++) reach[i][j] = graph.adj_matrix[i][j] != 0;
+        }
+        for (int k = 0; k < n; k++) {
+            for (int i = 0; i < n; i++) {
+                if (!reach[i][k]) continue;
+                for (int j = 0; j < n; j++) {
+                    if (reach[k][j]) reach[i][j] = 1;
+                }
+            }
+        }
+        return reach;
+    }
+
+    std::vector<int> reference_distances(const Graph &graph) {
+        const int n = graph.n;
+        std::vector<int> dist(static_cast<size_t>(n) * n, -1);
+        for (int s = 0; s < n; s++) {
+            int *row = dist.data() + static_cast<size_t>(s) * n;
+            std::queue<int> queue;
+            row[s] = 0;
+            queue.push(s);
+            while (!queue.empty()) {
+                const int u = queue.front();
+                queue.pop();
+                for (int v = 0; v < n; v++) {
+                    if (graph.adj_matrix[u][v] && row[v] == -1) {
+                        row[v] = row[u] + 1;
+                        queue.push(v);
+                    }
+                }
+            }
+        }
+        return dist;
+    }
+
+    BitMatrix random_bits(const int n, const unsigned int seed, const double density) {
+        BitMatrix m = make_bit_matrix(n);
+        std::mt19937 random(seed);
+        std::bernoulli_distribution bit(density);
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < n; j++) {
+                if (bit(random)) m.set(i, j);
+            }
+        }
+        return m;
+    }
+}
+
+TEST(Closure, BoolMultiplyMatchesNaiveProduct) {
+    for (const unsigned int seed : SEEDS) {
+        // Directed, non-symmetric operands; sizes around the word and table boundaries
+        for (const int n : {1, 7, 8, 63, 64, 65, 130}) {
+            const BitMatrix a = random_bits(n, seed, 0.05);
+            const BitMatrix b = random_bits(n, seed + 1, 0.05);
+            const BitMatrix c = bool_multiply(a, b);
+            for (int i = 0; i < n; i++) {
+                for (int j = 0; j < n; j++) {
+                    bool expected = false;
+                    for (int k = 0; k < n && !expected; k++) expected = a.test(i, k) && b.test(k, j);
+                    ASSERT_EQ(c.test(i, j), expected) << "seed " << seed << ", n " << n << ", cell " << i << ", " << j;
+                }
+            }
+        }
+    }
+}
+
+TEST(Closure, TransitiveClosureMatchesWarshall) {
+    for (const unsigned int seed : SEEDS) {
+        for (const double density : {0.005, 0.02, 0.2}) {
+            for (const int n : {1, 40, 129}) {
+                const SharedGraph g = random_graph(n, seed, density, 0.05);
+                const auto expected = reference_closure(*g);
+                const SharedGraph closure = make_shared_graph(transitive_closure(*g));
+                ASSERT_EQ(closure->n, n);
+                for (int i = 0; i < n; i++) {
+                    for (int j = 0; j < n; j++) {
+                        ASSERT_EQ(closure->adj_matrix[i][j], expected[i][j])
+                            << "seed " << seed << ", density " << density << ", n " << n << ", cell " << i << ", " << j;
+                    }
+                }
+                const auto lists = sorted_lists(*closure);
+                for (int i = 0; i < n; i++) {
+                    EXPECT_EQ(static_cast<int>(lists[i].size()), std::ranges::count(expected[i], 1));
+                }
+            }
+        }
+    }
+}
+
+TEST(Closure, AllPairsDistancesMatchBfs) {
+    for (const unsigned int seed : SEEDS) {
+        for (const double density : {0.01, 0.05, 0.4}) {
+            for (const int n : {1, 33, 100}) {
+                const SharedGraph g = random_graph(n, seed, density);
+                EXPECT_EQ(all_pairs_distances(*g), reference_distances(*g))
+                    << "seed " << seed << ", density " << density << ", n " << n;
+            }
+        }
+    }
+}
+
+TEST(Closure, PathAndEmptyGraph) {
+    // 0 - 1 - 2 and a lone vertex 3: only the lone vertex has no cycle back to itself
+    const SharedGraph g = graph_from_edges(4, {{0, 1}, {1, 2}});
+    Graph closure = transitive_closure(*g);
+    EXPECT_EQ(closure.adj_matrix[0][2], 1);
+    EXPECT_EQ(closure.adj_matrix[0][0], 1);
+    EXPECT_EQ(closure.adj_matrix[3][3], 0);
+    EXPECT_TRUE(closure.adj_list[3].empty());
+    delete_graph(closure, closure.n);
+    EXPECT_EQ(all_pairs_distances(*g)[0 * 4 + 2], 2);
+    EXPECT_EQ(all_pairs_distances(*g)[3 * 4 + 0], -1);
+
+    const SharedGraph empty = random_graph(0, SEEDS[0]);
+    Graph empty_closure = transitive_closure(*empty);
+    EXPECT_EQ(empty_closure.n, 0);
+    delete_graph(empty_closure, 0);
+    EXPECT_TRUE(all_pairs_distances(*empty).empty());
+}
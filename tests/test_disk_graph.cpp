@@ -0,0 +1,128 @@
+#include "backend/bit_matrix.h"
+#include "backend/disk_graph.h"
+#include "backend/op_planner.h"
+#include "test_graphs.h"
+
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+using namespace test_graphs;
+
+namespace {
+    // Factor sizes: empty, single vertex, unequal, and a product of a few thousand vertices
+    const std::vector<std::pair<int, int>> FACTOR_SIZES{{0, 0}, {0, 7}, {5, 0}, {1, 1}, {12, 30}, {30, 12}, {40, 65}};
+
+    std::string temp_file(const std::string &name) {
+        return (std::filesystem::temp_directory_path() / name).string();
+    }
+
+    // Rows of the mapped file against the sorted lists of the in-memory result
+    void expect_same_lists(const Graph &expected, const DiskGraph &actual) {
+        ASSERT_EQ(expected.n, actual.n);
+        const auto lists = sorted_lists(expected);
+        std::uint64_t entries = 0;
+        for (int v = 0; v < actual.n; v++) {
+            const auto row = actual.row(v);
+            ASSERT_EQ(std::vector<int>(row.begin(), row.end()), lists[v]) << "row " << v;
+            entries += row.size();
+        }
+        EXPECT_EQ(actual.entries, entries);
+    }
+}
+
+TEST(DiskGraph, ProductFileMatchesInMemoryProduct) {
+    const std::string path = temp_file("lab6_test_product.graph");
+    for (const unsigned int seed : SEEDS) {
+        for (const auto &[n1, n2] : FACTOR_SIZES) {
+            // One row per block, a few rows per block, everything in one block
+            for (const std::size_t limit : {std::size_t{1}, std::size_t{4096}, std::size_t{64} << 20}) {
+                SCOPED_TRACE(testing::Message() << "seed " << seed << ", sizes " << n1 << " and " << n2
+                             << ", block limit " << limit);
+                const SharedGraph a = random_graph(n1, seed);
+                const SharedGraph b = random_graph(n2, seed + 100);
+                const SharedGraph expected = make_shared_graph(graph_cartesian_product(*a, *b));
+
+                const std::size_t bytes = graph_cartesian_product_to_file(*a, *b, path, limit);
+                EXPECT_EQ(bytes, std::filesystem::file_size(path));
+                EXPECT_EQ(bytes, disk_graph_bytes(static_cast<std::uint64_t>(expected->n),
+                                                  static_cast<std::uint64_t>(count_list_entries(*expected))));
+
+                const SharedDiskGraph disk = open_disk_graph(path);
+                EXPECT_EQ(disk->file_bytes, bytes);
+                expect_same_lists(*expected, *disk);
+            }
+        }
+    }
+    std::filesystem::remove(path);
+}
+
+TEST(DiskGraph, ExistingFileIsReplaced) {
+    const std::string path = temp_file("lab6_test_replaced.graph");
+    const SharedGraph big = random_graph(30, SEEDS[0]);
+    const SharedGraph small = random_graph(3, SEEDS[1]);
+    graph_cartesian_product_to_file(*big, *big, path, 1 << 20);
+    graph_cartesian_product_to_file(*small, *small, path, 1 << 20);
+    expect_same_lists(*make_shared_graph(graph_cartesian_product(*small, *small)), *open_disk_graph(path));
+    std::filesystem::remove(path);
+}
+
+TEST(DiskGraph, TemporaryFileGoesWithTheLastOwner) {
+    const std::string path = spill_path("");
+    const SharedGraph a = random_graph(10, SEEDS[0]);
+    graph_cartesian_product_to_file(*a, *a, path, 1 << 20);
+    {
+        const SharedDiskGraph disk = open_disk_graph(path, true);
+        const SharedDiskGraph copy = disk;
+        EXPECT_TRUE(std::filesystem::exists(path));
+    }
+    EXPECT_FALSE(std::filesystem::exists(path));
+}
+
+TEST(DiskGraph, SpillPathsAreUnique) {
+    const std::string dir = std::filesystem::temp_directory_path().string();
+    const std::string first = spill_path(dir);
+    EXPECT_NE(first, spill_path(dir));
+    EXPECT_EQ(std::filesystem::path(first).parent_path(), std::filesystem::path(dir));
+}
+
+TEST(DiskGraph, RefusesFilesThatAreNotGraphs) {
+    EXPECT_THROW(open_disk_graph(temp_file("lab6_test_missing.graph")), std::runtime_error);
+
+    const std::string path = temp_file("lab6_test_garbage.graph");
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << std::string(4096, 'x');
+    }
+    EXPECT_THROW(open_disk_graph(path), std::runtime_error);
+
+    // A valid file cut short looks unfinished
+    const SharedGraph a = random_graph(20, SEEDS[0]);
+    const std::size_t bytes = graph_cartesian_product_to_file(*a, *a, path, 1 << 20);
+    std::filesystem::resize_file(path, bytes / 2);
+    EXPECT_THROW(open_disk_graph(path), std::runtime_error);
+    std::filesystem::remove(path);
+}
+
+TEST(DiskGraph, OutOfCorePlanEvaluatesPendingOperands) {
+    const SharedGraph a = random_graph(20, SEEDS[0]);
+    const SharedGraph b = random_graph(15, SEEDS[1]);
+    const SharedGraph c = random_graph(9, SEEDS[2]);
+    const ExprPtr ring = expr_binary(GraphOp::RingSum, expr_leaf(a.get(), "A"), expr_leaf(b.get(), "B"));
+    const ExprPtr expr = expr_binary(GraphOp::CartesianProduct, ring, expr_leaf(c.get(), "C"));
+    const SharedGraph expected = make_shared_graph(evaluate(expr));
+
+    // Forced to disk with blocks of a few rows
+    OpPlan plan = plan_operation(expr, SIZE_MAX, std::size_t{1} << 40);
+    plan.chosen = Strategy::OutOfCore;
+    plan.block_bytes = 256;
+
+    std::string path;
+    {
+        const SharedDiskGraph disk = run_plan_out_of_core(plan, expr, "");
+        path = disk->path;
+        EXPECT_TRUE(disk->temporary);
+        expect_same_lists(*expected, *disk);
+    }
+    EXPECT_FALSE(std::filesystem::exists(path));
+}
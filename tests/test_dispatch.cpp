@@ -0,0 +1,118 @@
+#include "core/console.h"
+#include "core/dispatch_table.h"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+TEST(DispatchTable, EmptyTableFindsNothing) {
+    DispatchTable<int> table;
+    EXPECT_EQ(table.find("anything"), nullptr);
+    table.build({});
+    EXPECT_EQ(table.find(""), nullptr);
+}
+
+TEST(DispatchTable, FindsEveryNameAndMissesOthers) {
+    for (const int count : {1, 5, 40, 300}) {
+        SCOPED_TRACE(count);
+        std::vector<DispatchTable<int>::Entry> entries;
+        for (int i = 0; i < count; i++) {
+            entries.push_back({"command" + std::to_string(i), i});
+        }
+        DispatchTable<int> table;
+        table.build(entries);
+
+        for (int i = 0; i < count; i++) {
+            const int* value = table.find("command" + std::to_string(i));
+            ASSERT_NE(value, nullptr) << i;
+            EXPECT_EQ(*value, i);
+        }
+        EXPECT_EQ(table.find("command" + std::to_string(count)), nullptr);
+        EXPECT_EQ(table.find("command"), nullptr);
+        EXPECT_EQ(table.find(""), nullptr);
+        EXPECT_EQ(table.find("COMMAND0"), nullptr);
+    }
+}
+
+TEST(DispatchTable, RebuildReplacesTheNames) {
+    DispatchTable<int> table;
+    table.build({{"old", 1}});
+    table.build({{"new", 2}});
+    EXPECT_EQ(table.find("old"), nullptr);
+    ASSERT_NE(table.find("new"), nullptr);
+    EXPECT_EQ(*table.find("new"), 2);
+}
+
+TEST(ConsoleTokens, SplitsOnAnyWhitespace) {
+    EXPECT_EQ(Console::tokenize("  union\tA  B ->\r\nC  "),
+              (std::vector<std::string>{"union", "A", "B", "->", "C"}));
+    EXPECT_TRUE(Console::tokenize(" \t ").empty());
+
+    // Views point into the input and the vector is reused
+    const std::string line = "a bb ccc";
+    std::vector<std::string_view> tokens{"stale"};
+    Console::split_tokens(line, tokens);
+    ASSERT_EQ(tokens.size(), 3u);
+    EXPECT_EQ(tokens[2], "ccc");
+    EXPECT_EQ(tokens[1].data(), line.data() + 2);
+}
+
+TEST(ConsoleTokens, ParsesWholeNumbersOnly) {
+    int count = 0;
+    EXPECT_TRUE(Console::parse_number("42", count));
+    EXPECT_EQ(count, 42);
+    EXPECT_TRUE(Console::parse_number("-7", count));
+    EXPECT_EQ(count, -7);
+    EXPECT_FALSE(Console::parse_number("", count));
+    EXPECT_FALSE(Console::parse_number("12x", count));
+    EXPECT_FALSE(Console::parse_number("1.5", count));
+    EXPECT_FALSE(Console::parse_number("99999999999", count));
+
+    double probability = 0;
+    EXPECT_TRUE(Console::parse_number("0.25", probability));
+    EXPECT_DOUBLE_EQ(probability, 0.25);
+    EXPECT_TRUE(Console::parse_number("1e-3", probability));
+    EXPECT_DOUBLE_EQ(probability, 1e-3);
+    EXPECT_FALSE(Console::parse_number("0.5.1", probability));
+    EXPECT_FALSE(Console::parse_number(" 1", probability));
+}
+
+TEST(ConsoleDispatch, BuiltinsWinOverAliasesAndAliasesOverCommands) {
+    Console console;
+    std::vector<std::string> ran;
+    console.register_command("first", [&ran](const std::vector<std::string>&) { ran.push_back("first"); });
+    console.register_command("second", [&ran](const std::vector<std::string>&) { ran.push_back("second"); });
+    console.register_alias("second", "first");
+    console.register_alias("exit", "first");
+    console.register_alias("broken", "nowhere");
+
+    std::ostringstream output;
+    Console::redirect_output(&output);
+    console.start_batch();
+    EXPECT_FALSE(console.execute("second"));
+    // The failing alias reports the command it stands for
+    EXPECT_TRUE(console.execute("broken"));
+    EXPECT_NE(output.str().find("nowhere"), std::string::npos);
+    EXPECT_FALSE(console.execute("exit"));
+    Console::redirect_output(nullptr);
+
+    EXPECT_EQ(ran, (std::vector<std::string>{"first"}));
+    EXPECT_FALSE(console.is_running());
+}
+
+TEST(ConsoleDispatch, CommandsAddedLaterAreFound) {
+    Console console;
+    int calls = 0;
+    console.start_batch();
+    std::ostringstream output;
+    Console::redirect_output(&output);
+    EXPECT_TRUE(console.execute("late"));
+    console.register_command("late", [&calls](const std::vector<std::string>& args) {
+        calls += static_cast<int>(args.size());
+    });
+    EXPECT_FALSE(console.execute("late 1 2 3"));
+    Console::redirect_output(nullptr);
+    EXPECT_EQ(calls, 3);
+}
@@ -0,0 +1,132 @@
+#include "backend/graph_expr.h"
+#include "test_graphs.h"
+
+#include <limits>
+#include <stdexcept>
+
+using namespace test_graphs;
+
+namespace {
+    const std::vector<GraphOp> SET_OPS{GraphOp::Union, GraphOp::Intersection, GraphOp::RingSum};
+
+    void expect_evaluates_to(const ExprPtr &expr, const Graph &expected) {
+        Graph result = evaluate(expr);
+        expect_same_graph(expected, result);
+        delete_graph(result, result.n);
+    }
+}
+
+TEST(GraphExpr, SingleOperationMatchesEagerKernel) {
+    for (const unsigned int seed : SEEDS) {
+        for (const auto &[n1, n2] : SIZE_PAIRS) {
+            const SharedGraph a = random_graph(n1, seed);
+            const SharedGraph b = random_graph(n2, seed + 100);
+            for (const GraphOp op : SET_OPS) {
+                SCOPED_TRACE(testing::Message() << "seed " << seed << ", sizes " << n1 << " and " << n2
+                             << ", op " << static_cast<int>(op));
+                const ExprPtr expr = expr_binary(op, expr_leaf(a.get(), "A"), expr_leaf(b.get(), "B"));
+                const SharedGraph expected = make_shared_graph(eager_op(op, *a, *b));
+                EXPECT_EQ(expr->n, op == GraphOp::RingSum ? std::max(n1, n2) : expected->n);
+                expect_evaluates_to(expr, *expected);
+            }
+        }
+    }
+}
+
+TEST(GraphExpr, WiderOperandsAreCutToTheResult) {
+    // The fused pass packs rows at the result width; a wider operand must not write past it
+    for (const unsigned int seed : SEEDS) {
+        const SharedGraph narrow = random_graph(40, seed);
+        const SharedGraph wide = random_graph(300, seed + 1);
+        const SharedGraph other = random_graph(20, seed + 2);
+        for (const bool narrow_first : {true, false}) {
+            const ExprPtr lhs = expr_leaf(narrow_first ? narrow.get() : wide.get(), "L");
+            const ExprPtr rhs = expr_leaf(narrow_first ? wide.get() : narrow.get(), "R");
+            const SharedGraph meet = make_shared_graph(graph_intersection(*lhs->leaf, *rhs->leaf));
+            expect_evaluates_to(expr_binary(GraphOp::Intersection, lhs, rhs), *meet);
+
+            // Nested: (L & R) | O, the wide leaf sits two levels below a 40-vertex result
+            const SharedGraph joined = make_shared_graph(graph_union(*meet, *other));
+            expect_evaluates_to(expr_binary(GraphOp::Union, expr_binary(GraphOp::Intersection, lhs, rhs),
+                                            expr_leaf(other.get(), "O")), *joined);
+        }
+    }
+}
+
+TEST(GraphExpr, ChainsMatchEagerComposition) {
+    for (const unsigned int seed : SEEDS) {
+        const SharedGraph a = random_graph(70, seed);
+        const SharedGraph b = random_graph(50, seed + 1, 0.1);
+        const SharedGraph c = random_graph(90, seed + 2, 0.5);
+        const ExprPtr la = expr_leaf(a.get(), "A");
+        const ExprPtr lb = expr_leaf(b.get(), "B");
+        const ExprPtr lc = expr_leaf(c.get(), "C");
+
+        for (const GraphOp inner : SET_OPS) {
+            for (const GraphOp outer : SET_OPS) {
+                SCOPED_TRACE(testing::Message() << "seed " << seed << ", inner " << static_cast<int>(inner)
+                             << ", outer " << static_cast<int>(outer));
+                // (A op B) op C: fused when both are union/intersection, a ring sum below goes to a temporary
+                const SharedGraph ab = make_shared_graph(eager_op(inner, *a, *b));
+                const SharedGraph expected = make_shared_graph(eager_op(outer, *ab, *c));
+                const ExprPtr expr = expr_binary(outer, expr_binary(inner, la, lb), lc);
+                EXPECT_EQ(describe(expr), "((A " + std::string(inner == GraphOp::Union ? "|" : inner == GraphOp::Intersection ? "&" : "^")
+                          + " B) " + (outer == GraphOp::Union ? "|" : outer == GraphOp::Intersection ? "&" : "^") + " C)");
+                expect_evaluates_to(expr, *expected);
+            }
+        }
+    }
+}
+
+TEST(GraphExpr, ProductsOfPendingOperands) {
+    for (const unsigned int seed : SEEDS) {
+        const SharedGraph a = random_graph(9, seed);
+        const SharedGraph b = random_graph(6, seed + 1);
+        const SharedGraph c = random_graph(7, seed + 2);
+        const ExprPtr ab = expr_binary(GraphOp::RingSum, expr_leaf(a.get(), "A"), expr_leaf(b.get(), "B"));
+        const ExprPtr expr = expr_binary(GraphOp::CartesianProduct, ab, expr_leaf(c.get(), "C"));
+
+        const SharedGraph sum = make_shared_graph(ring_sum(*a, *b));
+        const SharedGraph expected = make_shared_graph(graph_cartesian_product(*sum, *c));
+        EXPECT_EQ(expr->n, std::max(a->n, b->n) * c->n);
+        expect_evaluates_to(expr, *expected);
+
+        // A product under a union is evaluated into a temporary first
+        const SharedGraph wide = random_graph(40, seed + 3);
+        const ExprPtr joined = expr_binary(GraphOp::Union, expr_binary(GraphOp::CartesianProduct,
+            expr_leaf(b.get(), "B"), expr_leaf(c.get(), "C")), expr_leaf(wide.get(), "W"));
+        const SharedGraph bc = make_shared_graph(graph_cartesian_product(*b, *c));
+        expect_evaluates_to(joined, *make_shared_graph(graph_union(*bc, *wide)));
+    }
+}
+
+TEST(GraphExpr, EmptyOperands) {
+    const SharedGraph empty = random_graph(0, SEEDS[0]);
+    const SharedGraph g = random_graph(12, SEEDS[0]);
+    for (const GraphOp op : {GraphOp::Union, GraphOp::Intersection, GraphOp::RingSum, GraphOp::CartesianProduct}) {
+        const SharedGraph expected = make_shared_graph(eager_op(op, *empty, *g));
+        expect_evaluates_to(expr_binary(op, expr_leaf(empty.get(), "E"), expr_leaf(g.get(), "G")), *expected);
+    }
+}
+
+TEST(GraphExpr, ProductTooLargeToNumberIsRejected) {
+    // Only the vertex counts are read while the expression is built
+    Graph big;
+    big.n = 100000;
+    const ExprPtr leaf = expr_leaf(&big, "BIG");
+    EXPECT_THROW(expr_binary(GraphOp::CartesianProduct, leaf, leaf), std::runtime_error);
+    EXPECT_EQ(expr_binary(GraphOp::Union, leaf, leaf)->n, 100000);
+
+    Graph edge;
+    edge.n = std::numeric_limits<int>::max() / 100000;
+    EXPECT_EQ(expr_binary(GraphOp::CartesianProduct, leaf, expr_leaf(&edge, "E"))->n, 100000 * edge.n);
+}
+
+TEST(GraphExpr, EagerProductTooLargeToNumberThrows) {
+    // The eager kernel checks the count before it allocates or reads a row
+    Graph big;
+    big.n = 100000;
+    EXPECT_THROW(graph_cartesian_product(big, big), std::runtime_error);
+    EXPECT_EQ(product_vertex_count(300, 400), 120000);
+    EXPECT_EQ(product_vertex_count(0, 100000), 0);
+}
@@ -0,0 +1,77 @@
+#include "backend/graph_hash.h"
+#include "test_graphs.h"
+
+#include <numeric>
+#include <random>
+
+using namespace test_graphs;
+
+namespace {
+    // Vertex k of the result is vertex order[k] of graph
+    SharedGraph renumbered(const Graph &graph, const std::vector<int> &order) {
+        std::vector<int> position(graph.n);
+        for (int k = 0; k < graph.n; k++) position[order[k]] = k;
+        std::vector<std::pair<int, int>> edges;
+        for (int i = 0; i < graph.n; i++) {
+            for (const int j : graph.adj_list[i]) {
+                if (i <= j) edges.emplace_back(position[i], position[j]);
+            }
+        }
+        return graph_from_edges(graph.n, edges);
+    }
+
+    std::vector<int> shuffled(const int n, const unsigned int seed) {
+        std::vector<int> order(n);
+        std::iota(order.begin(), order.end(), 0);
+        std::ranges::shuffle(order, std::mt19937(seed));
+        return order;
+    }
+}
+
+TEST(GraphHash, WlHashIgnoresNumbering) {
+    for (const unsigned int seed : SEEDS) {
+        for (const int n : {1, 20, 150}) {
+            const SharedGraph g = random_graph(n, seed, 0.1, 0.2);
+            const SharedGraph h = renumbered(*g, shuffled(n, seed));
+            EXPECT_EQ(wl_hash(*g), wl_hash(*h)) << "seed " << seed << ", n " << n;
+            if (n > 1) {
+                EXPECT_NE(matrix_fingerprint(*g), matrix_fingerprint(*h)) << "seed " << seed << ", n " << n;
+            }
+        }
+    }
+}
+
+TEST(GraphHash, FingerprintFollowsTheMatrix) {
+    for (const unsigned int seed : SEEDS) {
+        const SharedGraph g = random_graph(80, seed);
+        // The same seed builds the same matrix again
+        Graph copy = create_graph(80, 0.3, 0.1, seed);
+        EXPECT_EQ(matrix_fingerprint(*g), matrix_fingerprint(copy));
+        EXPECT_EQ(wl_hash(*g), wl_hash(copy));
+
+        // A union with itself is the same graph
+        Graph same = graph_union(*g, copy);
+        EXPECT_EQ(matrix_fingerprint(*g), matrix_fingerprint(same));
+        delete_graph(same, same.n);
+
+        // Any structural edit changes the bits
+        identify_vertices(copy, 0, 1);
+        EXPECT_NE(matrix_fingerprint(*g), matrix_fingerprint(copy));
+        delete_graph(copy, copy.n);
+    }
+}
+
+TEST(GraphHash, SeparatesNonIsomorphicGraphs) {
+    // Path and star on four vertices: three edges each, different degrees
+    const SharedGraph path = graph_from_edges(4, {{0, 1}, {1, 2}, {2, 3}});
+    const SharedGraph star = graph_from_edges(4, {{0, 1}, {0, 2}, {0, 3}});
+    EXPECT_NE(wl_hash(*path), wl_hash(*star));
+
+    // A self-loop is part of the structure
+    const SharedGraph looped = graph_from_edges(4, {{0, 1}, {1, 2}, {2, 3}, {0, 0}});
+    EXPECT_NE(wl_hash(*path), wl_hash(*looped));
+
+    const SharedGraph empty = random_graph(0, SEEDS[0]);
+    const SharedGraph single = random_graph(1, SEEDS[0], 0.0, 0.0);
+    EXPECT_NE(wl_hash(*empty), wl_hash(*single));
+}
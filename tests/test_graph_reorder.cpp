@@ -0,0 +1,201 @@
+#include "adapters/console_adapter.h"
+#include "backend/graph_reorder.h"
+#include "test_graphs.h"
+
+#include <numeric>
+#include <random>
+#include <sstream>
+
+using namespace test_graphs;
+
+namespace {
+    const std::vector<VertexOrder> ORDERS{VertexOrder::ReverseCuthillMcKee, VertexOrder::Degree, VertexOrder::Bfs};
+
+    bool is_permutation_of_vertices(const std::vector<int> &order, const int n) {
+        std::vector<int> sorted = order;
+        std::ranges::sort(sorted);
+        std::vector<int> identity(n);
+        std::iota(identity.begin(), identity.end(), 0);
+        return sorted == identity;
+    }
+
+    // Runs the script through the adapter and returns the original numbers the last 'reorder <graph>' printed
+    std::vector<int> labels_after_script(const std::string &script) {
+        std::istringstream in(script);
+        std::ostringstream output;
+        GraphConsoleAdapter adapter(RESOURCES_PATH "/config_files/graph_console.conf",
+                                    RESOURCES_PATH "/config_files/aliases.conf");
+        Console::redirect_output(&output);
+        const int status = adapter.run_script(in, true, false);
+        Console::redirect_output(nullptr);
+        EXPECT_EQ(status, EXIT_SUCCESS) << output.str();
+
+        const std::string text = output.str();
+        const std::string marker = "Original numbers (-1 = added later):";
+        const std::size_t at = text.rfind(marker);
+        if (at == std::string::npos) return {};
+        std::istringstream numbers(text.substr(at + marker.size(), text.find('\n', at) - at - marker.size()));
+        std::vector<int> labels;
+        for (int label; numbers >> label;) labels.push_back(label);
+        return labels;
+    }
+
+    int degree(const Graph &graph, const int v) {
+        return static_cast<int>(std::ranges::count_if(graph.adj_list[v], [v](const int u) { return u != v; }));
+    }
+
+    // rows x columns grid, numbered row by row: bandwidth equals columns
+    SharedGraph grid(const int rows, const int columns) {
+        std::vector<std::pair<int, int>> edges;
+        for (int r = 0; r < rows; r++) {
+            for (int c = 0; c < columns; c++) {
+                const int v = r * columns + c;
+                if (c + 1 < columns) edges.emplace_back(v, v + 1);
+                if (r + 1 < rows) edges.emplace_back(v, v + columns);
+            }
+        }
+        return graph_from_edges(rows * columns, edges);
+    }
+}
+
+TEST(GraphReorder, OrdersArePermutations) {
+    for (const unsigned int seed : SEEDS) {
+        for (const int n : {0, 1, 50, 300}) {
+            for (const double density : {0.005, 0.3}) {
+                const SharedGraph graph = random_graph(n, seed, density);
+                for (const VertexOrder order : ORDERS) {
+                    SCOPED_TRACE(testing::Message() << "seed " << seed << ", n " << n << ", density " << density
+                                 << ", " << vertex_order_name(order));
+                    EXPECT_TRUE(is_permutation_of_vertices(vertex_order(*graph, order), n));
+                }
+            }
+        }
+    }
+}
+
+TEST(GraphReorder, PermutedGraphFollowsTheOrder) {
+    for (const unsigned int seed : SEEDS) {
+        const SharedGraph graph = random_graph(120, seed, 0.05);
+        for (const VertexOrder method : ORDERS) {
+            SCOPED_TRACE(testing::Message() << "seed " << seed << ", " << vertex_order_name(method));
+            const std::vector<int> order = vertex_order(*graph, method);
+            const SharedGraph permuted = make_shared_graph(permute_graph(*graph, order));
+
+            // Expected: new cell (i, j) is old cell (order[i], order[j])
+            std::vector<std::pair<int, int>> edges;
+            for (int i = 0; i < graph->n; i++) {
+                for (int j = i; j < graph->n; j++) {
+                    if (graph->adj_matrix[order[i]][order[j]]) edges.emplace_back(i, j);
+                }
+            }
+            expect_same_graph(*graph_from_edges(graph->n, edges), *permuted);
+        }
+    }
+}
+
+TEST(GraphReorder, RestoreUndoesRepeatedReorders) {
+    for (const unsigned int seed : SEEDS) {
+        const SharedGraph graph = random_graph(90, seed, 0.1);
+        std::vector<int> labels;
+        SharedGraph current = graph;
+        for (const VertexOrder method : {VertexOrder::Degree, VertexOrder::ReverseCuthillMcKee, VertexOrder::Bfs}) {
+            const std::vector<int> order = vertex_order(*current, method, 5);
+            labels = compose_labels(labels, order);
+            current = make_shared_graph(permute_graph(*current, order));
+        }
+        ASSERT_TRUE(is_permutation_of_vertices(labels, graph->n));
+        for (int v = 0; v < graph->n; v++) {
+            EXPECT_EQ(sorted_lists(*current)[v].size(), sorted_lists(*graph)[labels[v]].size()) << v;
+        }
+
+        const SharedGraph restored = make_shared_graph(permute_graph(*current, restore_order(labels)));
+        expect_same_graph(*graph, *restored);
+    }
+}
+
+TEST(GraphReorder, LabelsFollowMergesAndSplits) {
+    std::vector<int> labels{4, 2, 0, 3, 1};
+    labels_after_merge(labels, 1);
+    EXPECT_EQ(labels, (std::vector<int>{4, 0, 3, 1}));
+    labels_after_split(labels);
+    EXPECT_EQ(labels, (std::vector<int>{4, 0, 3, 1, -1}));
+    // Unlabelled vertices go last, the rest by original number
+    EXPECT_EQ(restore_order(labels), (std::vector<int>{1, 3, 2, 0, 4}));
+
+    // A graph that was never reordered keeps no labels
+    std::vector<int> none;
+    labels_after_split(none);
+    labels_after_merge(none, 0);
+    EXPECT_TRUE(none.empty());
+}
+
+TEST(ReorderCommand, RestoreAfterAMergeKeepsTheLabels) {
+    // BFS from 5 makes original 5 vertex 0 of r, so merging 0 and 2 drops an original below 5:
+    // the survivors are back in ascending order but can no longer all sit at their own numbers
+    const std::vector<int> labels = labels_after_script(
+        "create 6 0.5 0.1 -> a\nreorder a bfs 5 -> r\nidentify r 0 2\nreorder r restore\nreorder r\n");
+    ASSERT_EQ(labels.size(), 5u);
+    EXPECT_TRUE(std::ranges::is_sorted(labels));
+    EXPECT_EQ(std::ranges::adjacent_find(labels), labels.end());
+    EXPECT_GE(labels.front(), 0);
+    EXPECT_EQ(labels.back(), 5);
+}
+
+TEST(ReorderCommand, RestoreAfterASplitKeepsTheAddedVertex) {
+    const std::vector<int> labels = labels_after_script(
+        "create 6 0.5 0.1 -> a\nreorder a degree -> r\nsplit r 0\nreorder r restore\nreorder r\n");
+    EXPECT_EQ(labels, (std::vector<int>{0, 1, 2, 3, 4, 5, -1}));
+}
+
+TEST(ReorderCommand, RestoreWithoutEditsGivesTheOriginalNumbering) {
+    const std::vector<int> labels = labels_after_script(
+        "create 6 0.5 0.1 -> a\nreorder a degree -> r\nreorder r bfs 3\nreorder r restore\nreorder r\n");
+    EXPECT_TRUE(labels.empty());
+}
+
+TEST(GraphReorder, DegreeOrderPutsHubsFirst) {
+    const SharedGraph graph = random_graph(200, SEEDS[1], 0.05);
+    const std::vector<int> order = vertex_order(*graph, VertexOrder::Degree);
+    for (size_t k = 1; k < order.size(); k++) {
+        EXPECT_GE(degree(*graph, order[k - 1]), degree(*graph, order[k])) << "position " << k;
+    }
+}
+
+TEST(GraphReorder, BfsStartsAtTheSource) {
+    const SharedGraph graph = random_graph(60, SEEDS[2], 0.05);
+    for (const int source : {0, 17, 59}) {
+        EXPECT_EQ(vertex_order(*graph, VertexOrder::Bfs, source).front(), source);
+    }
+}
+
+TEST(GraphReorder, RcmNarrowsAShuffledGrid) {
+    const SharedGraph plain = grid(20, 8);
+    EXPECT_EQ(graph_bandwidth(*plain), 8);
+
+    std::vector<int> shuffle(plain->n);
+    std::iota(shuffle.begin(), shuffle.end(), 0);
+    std::ranges::shuffle(shuffle, std::mt19937(SEEDS[0]));
+    const SharedGraph shuffled = make_shared_graph(permute_graph(*plain, shuffle));
+    ASSERT_GT(graph_bandwidth(*shuffled), 40);
+
+    const SharedGraph narrowed = make_shared_graph(
+        permute_graph(*shuffled, vertex_order(*shuffled, VertexOrder::ReverseCuthillMcKee)));
+    // The level structure of a grid gives at most about twice the short side
+    EXPECT_LE(graph_bandwidth(*narrowed), 16);
+}
+
+TEST(GraphReorder, BandwidthOfSmallGraphs) {
+    EXPECT_EQ(graph_bandwidth(*graph_from_edges(0, {})), 0);
+    EXPECT_EQ(graph_bandwidth(*graph_from_edges(4, {{2, 2}})), 0);
+    EXPECT_EQ(graph_bandwidth(*graph_from_edges(6, {{0, 5}, {1, 2}})), 5);
+}
+
+TEST(GraphReorder, OrderNames) {
+    for (const VertexOrder order : ORDERS) {
+        VertexOrder parsed{};
+        ASSERT_TRUE(parse_vertex_order(vertex_order_name(order), parsed));
+        EXPECT_EQ(parsed, order);
+    }
+    VertexOrder ignored{};
+    EXPECT_FALSE(parse_vertex_order("random", ignored));
+}
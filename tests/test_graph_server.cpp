@@ -0,0 +1,187 @@
+#include "adapters/console_adapter.h"
+#include "adapters/graph_server.h"
+#include "backend/shared_store.h"
+#include "test_graphs.h"
+
+#include <atomic>
+#include <csignal>
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+
+using namespace test_graphs;
+
+namespace {
+    std::string socket_file() {
+        return "/tmp/lab6_test_" + std::to_string(getpid()) + ".sock";
+    }
+
+    // Sends the lines as one client, returns the exit status and what the client printed
+    int send(const std::string& path, const std::string& lines, std::string& printed) {
+        std::istringstream in(lines);
+        std::ostringstream captured;
+        std::streambuf* previous = std::cout.rdbuf(captured.rdbuf());
+        const int status = run_client(path, in);
+        std::cout.rdbuf(previous);
+        printed = captured.str();
+        return status;
+    }
+
+    /**
+     * Runs a server on its own thread for the life of the object
+     * Once a request is answered the stop handler is installed, so stopping by signal is safe
+     */
+    class RunningServer {
+    public:
+        explicit RunningServer(std::function<int()> serve)
+            : thread([this, serve = std::move(serve)] { status = serve(); }) {}
+
+        // Waits until a probe line gets a response header, without going through std::cout
+        static bool ready(const std::string& path, const std::string& probe) {
+            for (int attempt = 0; attempt < 250; attempt++) {
+                sockaddr_un address{};
+                address.sun_family = AF_UNIX;
+                std::snprintf(address.sun_path, sizeof(address.sun_path), "%s", path.c_str());
+                const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+                bool answered = false;
+                if (fd >= 0 && ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0
+                    && ::write(fd, probe.data(), probe.size()) == static_cast<ssize_t>(probe.size())) {
+                    char header[64];
+                    answered = ::read(fd, header, sizeof(header)) > 0;
+                }
+                if (fd >= 0) ::close(fd);
+                if (answered) return true;
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            }
+            return false;
+        }
+
+        int stop() {
+            std::raise(SIGTERM);
+            thread.join();
+            return status;
+        }
+
+    private:
+        int status = -1;
+        std::thread thread;
+    };
+}
+
+TEST(GraphServer, AnswersInRequestOrderAndCountsErrors) {
+    const std::string path = socket_file();
+    GraphServer server(path, [](const std::string& line, std::string& output) {
+        output = "echo " + line + "\n";
+        return line.rfind("bad", 0) == 0;
+    }, 4);
+    RunningServer running([&server] { return server.run(); });
+    ASSERT_TRUE(running.ready(path, "probe\n"));
+
+    std::string printed;
+    EXPECT_EQ(send(path, "one\n# skipped\n\ntwo\n", printed), EXIT_SUCCESS);
+    EXPECT_EQ(printed, "echo one\necho two\n");
+
+    EXPECT_EQ(send(path, "one\nbad\ntwo\n", printed), EXIT_FAILURE);
+    EXPECT_EQ(printed, "echo one\necho bad\necho two\n");
+
+    // exit closes the connection, later lines are not sent
+    EXPECT_EQ(send(path, "one\nexit\ntwo\n", printed), EXIT_SUCCESS);
+    EXPECT_EQ(printed, "echo one\n");
+
+    EXPECT_EQ(running.stop(), EXIT_SUCCESS);
+    EXPECT_NE(access(path.c_str(), F_OK), 0) << "socket file left behind";
+}
+
+TEST(GraphServer, ServesClientsAtTheSameTime) {
+    const std::string path = socket_file();
+    std::atomic<int> handled{0};
+    GraphServer server(path, [&handled](const std::string& line, std::string& output) {
+        handled++;
+        output = line + "\n";
+        return false;
+    }, 4);
+    RunningServer running([&server] { return server.run(); });
+    ASSERT_TRUE(running.ready(path, "probe\n"));
+    handled = 0;
+
+    constexpr int CLIENTS = 8;
+    constexpr int LINES = 200;
+    std::vector<int> status(CLIENTS, -1);
+    std::ostringstream printed;
+    std::streambuf* previous = std::cout.rdbuf(printed.rdbuf());
+    std::vector<std::thread> clients;
+    for (int c = 0; c < CLIENTS; c++) {
+        clients.emplace_back([&, c] {
+            std::string lines;
+            for (int i = 0; i < LINES; i++) lines += std::to_string(c) + ":" + std::to_string(i) + "\n";
+            std::istringstream in(lines);
+            status[c] = run_client(path, in);
+        });
+    }
+    for (auto& client : clients) client.join();
+    std::cout.rdbuf(previous);
+
+    for (int c = 0; c < CLIENTS; c++) {
+        EXPECT_EQ(status[c], EXIT_SUCCESS) << "client " << c;
+    }
+    EXPECT_EQ(handled.load(), CLIENTS * LINES);
+    EXPECT_EQ(running.stop(), EXIT_SUCCESS);
+}
+
+TEST(GraphServer, RefusesASecondServerOnTheSameSocket) {
+    const std::string path = socket_file();
+    GraphServer server(path, [](const std::string&, std::string& output) {
+        output = "ok\n";
+        return false;
+    }, 1);
+    RunningServer running([&server] { return server.run(); });
+    ASSERT_TRUE(running.ready(path, "probe\n"));
+
+    GraphServer second(path, [](const std::string&, std::string&) { return false; }, 1);
+    std::ostringstream ignored;
+    std::streambuf* previous = std::cerr.rdbuf(ignored.rdbuf());
+    EXPECT_EQ(second.run(), EXIT_FAILURE);
+    std::cerr.rdbuf(previous);
+
+    EXPECT_EQ(running.stop(), EXIT_SUCCESS);
+}
+
+TEST(GraphServer, AdapterResultsMatchEagerKernels) {
+    const std::string path = socket_file();
+    const std::string prefix = "/lab6_test_" + std::to_string(getpid()) + "_";
+    GraphConsoleAdapter adapter(RESOURCES_PATH "/config_files/graph_console.conf",
+                                RESOURCES_PATH "/config_files/aliases.conf");
+    RunningServer running([&] { return adapter.serve(path); });
+    ASSERT_TRUE(running.ready(path, "graphs\n"));
+
+    for (const unsigned int seed : SEEDS) {
+        for (const auto &[n1, n2] : SIZE_PAIRS) {
+            SCOPED_TRACE(testing::Message() << "seed " << seed << ", sizes " << n1 << " and " << n2);
+            const SharedGraph a = random_graph(n1, seed);
+            const SharedGraph b = random_graph(n2, seed + 100);
+            publish_graph(*a, prefix + "a");
+            publish_graph(*b, prefix + "b");
+
+            // Slots outlive the connection: the second client reads what the first one attached
+            std::string printed;
+            ASSERT_EQ(send(path, "attach " + prefix + "a -> A\nattach " + prefix + "b -> B\n"
+                                 "union A B -> U\npublish U " + prefix + "u\n", printed), EXIT_SUCCESS) << printed;
+            ASSERT_EQ(send(path, "ring A B -> R\npublish R " + prefix + "r\n", printed), EXIT_SUCCESS) << printed;
+
+            const SharedGraph both = make_shared_graph(graph_union(*a, *b));
+            const SharedGraph ring = make_shared_graph(ring_sum(*a, *b));
+            expect_same_graph(*both, *attach_graph(prefix + "u"));
+            expect_same_graph(*ring, *attach_graph(prefix + "r"));
+
+            for (const char *suffix : {"a", "b", "u", "r"}) {
+                unpublish_graph(prefix + suffix);
+            }
+        }
+    }
+
+    EXPECT_EQ(running.stop(), EXIT_SUCCESS);
+}
@@ -0,0 +1,93 @@
+#ifndef TEST_GRAPHS_H
+#define TEST_GRAPHS_H
+
+// Fixtures shared by the backend tests: small hand-made graphs, fixed-seed random ones
+// and comparisons against the dense reference kernels
+
+#include "backend/matrix_gen.h"
+#include "backend/result_cache.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace test_graphs {
+    // Seeds every randomized test runs with, so a failure reproduces
+    inline const std::vector<unsigned int> SEEDS{11, 23, 47};
+
+    // Operand sizes for binary operations: empty, equal, one much wider than the other
+    inline const std::vector<std::pair<int, int>> SIZE_PAIRS{
+        {0, 0}, {0, 7}, {5, 0}, {1, 1}, {40, 300}, {300, 40}, {64, 65}, {97, 97}};
+
+    inline SharedGraph random_graph(const int n, const unsigned int seed, const double edge_prob = 0.3,
+                                    const double loop_prob = 0.1) {
+        return make_shared_graph(create_graph(n, edge_prob, loop_prob, seed));
+    }
+
+    /**
+     * Undirected graph from an edge list, (v, v) is a self-loop
+     * @param n Vertex count
+     * @param edges Pairs of vertex numbers 0 - n-1
+     * @return Graph with ascending adjacency lists, like create_graph makes them
+     */
+    inline SharedGraph graph_from_edges(const int n, const std::vector<std::pair<int, int>> &edges) {
+        Graph graph;
+        graph.n = n;
+        graph.adj_matrix = new int*[n];
+        for (int i = 0; i < n; i++) {
+            graph.adj_matrix[i] = new int[n]();
+        }
+        for (const auto &[u, v] : edges) {
+            graph.adj_matrix[u][v] = graph.adj_matrix[v][u] = 1;
+        }
+        graph.adj_list.resize(n);
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < n; j++) {
+                if (graph.adj_matrix[i][j]) graph.adj_list[i].push_back(j);
+            }
+        }
+        return make_shared_graph(std::move(graph));
+    }
+
+    // Adjacency lists with each list sorted: kernels agree on the neighbors, not always on their order
+    inline std::vector<std::vector<int>> sorted_lists(const Graph &graph) {
+        std::vector<std::vector<int>> lists = graph.adj_list;
+        for (auto &list : lists) std::ranges::sort(list);
+        return lists;
+    }
+
+    // Result of a binary operation from the dense reference kernel
+    inline Graph eager_op(const GraphOp op, const Graph &a, const Graph &b) {
+        switch (op) {
+            case GraphOp::Union: return graph_union(a, b);
+            case GraphOp::Intersection: return graph_intersection(a, b);
+            case GraphOp::RingSum: return ring_sum(a, b);
+            case GraphOp::CartesianProduct: return graph_cartesian_product(a, b);
+        }
+        return {};
+    }
+
+    // Same vertex count, same matrix, same neighbors; the lists must also match the matrix
+    inline void expect_same_graph(const Graph &expected, const Graph &actual) {
+        ASSERT_EQ(expected.n, actual.n);
+        ASSERT_EQ(static_cast<int>(actual.adj_list.size()), actual.n);
+        for (int i = 0; i < actual.n; i++) {
+            for (int j = 0; j < actual.n; j++) {
+                ASSERT_EQ(expected.adj_matrix[i][j], actual.adj_matrix[i][j]) << "cell " << i << ", " << j;
+            }
+        }
+        const auto lists = sorted_lists(actual);
+        EXPECT_EQ(sorted_lists(expected), lists);
+        for (int i = 0; i < actual.n; i++) {
+            std::vector<int> row;
+            for (int j = 0; j < actual.n; j++) {
+                if (actual.adj_matrix[i][j]) row.push_back(j);
+            }
+            EXPECT_EQ(row, lists[i]) << "list of vertex " << i;
+        }
+    }
+}
+
+#endif //TEST_GRAPHS_H
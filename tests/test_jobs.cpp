@@ -0,0 +1,116 @@
+#include "backend/jobs.h"
+#include "backend/parallel.h"
+#include "test_graphs.h"
+
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+using namespace test_graphs;
+
+namespace {
+    // Waits until every job of the table has finished and returns them
+    std::vector<std::shared_ptr<Job>> reap_all(JobTable &jobs, const std::size_t expected) {
+        std::vector<std::shared_ptr<Job>> done;
+        while (done.size() < expected) {
+            for (auto &job : jobs.reap_finished()) done.push_back(std::move(job));
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return done;
+    }
+}
+
+TEST(Jobs, ResultMatchesForegroundRun) {
+    const SharedGraph a = random_graph(120, SEEDS[0]);
+    const SharedGraph b = random_graph(80, SEEDS[1]);
+    JobTable jobs;
+    SharedGraph committed;
+    const int id = jobs.start("union", [a, b] { return make_shared_graph(graph_union(*a, *b)); },
+                              [&](const SharedGraph &result) { committed = result; });
+    ASSERT_NE(jobs.find(id), nullptr);
+
+    const auto done = reap_all(jobs, 1);
+    ASSERT_EQ(done[0]->id, id);
+    EXPECT_TRUE(done[0]->error.empty());
+    EXPECT_FALSE(done[0]->cancelled);
+    // Commit is left to the caller, on its own thread
+    EXPECT_EQ(committed, nullptr);
+    done[0]->commit(done[0]->result);
+    ASSERT_NE(committed, nullptr);
+    expect_same_graph(*make_shared_graph(graph_union(*a, *b)), *committed);
+    EXPECT_EQ(jobs.find(id), nullptr);
+    EXPECT_GE(done[0]->state.done.load(), 200);
+}
+
+TEST(Jobs, CancelStopsAtTheNextChunk) {
+    JobTable jobs;
+    std::atomic<bool> started{false};
+    const int id = jobs.start("spin", [&started] {
+        started.store(true);
+        // Endless rows of work; parallel_for chunks are the cancellation points
+        for (;;) parallel_for(1024, [](int, int) { std::this_thread::yield(); }, 1);
+        return SharedGraph{};
+    }, [](const SharedGraph &) {});
+    while (!started.load()) std::this_thread::yield();
+    EXPECT_TRUE(jobs.cancel(id));
+    EXPECT_FALSE(jobs.cancel(id + 1));
+
+    const auto done = reap_all(jobs, 1);
+    EXPECT_TRUE(done[0]->cancelled);
+    EXPECT_EQ(done[0]->result, nullptr);
+}
+
+TEST(Jobs, ErrorsAreReported) {
+    JobTable jobs;
+    jobs.start("fail", []() -> SharedGraph { throw std::runtime_error("no memory left"); }, [](const SharedGraph &) {});
+    const auto done = reap_all(jobs, 1);
+    EXPECT_EQ(done[0]->error, "no memory left");
+    EXPECT_FALSE(done[0]->cancelled);
+}
+
+TEST(Jobs, TableIsSafeFromSeveralThreads) {
+    JobTable jobs;
+    constexpr int STARTERS = 4;
+    constexpr int PER_STARTER = 25;
+    std::vector<std::thread> starters;
+    std::atomic<int> reaped{0};
+    for (int t = 0; t < STARTERS; t++) {
+        starters.emplace_back([&jobs, t] {
+            for (int k = 0; k < PER_STARTER; k++) {
+                jobs.start("small", [t] { return random_graph(8, SEEDS[t % SEEDS.size()]); }, [](const SharedGraph &) {});
+                jobs.list();
+            }
+        });
+    }
+    std::thread reaper([&] {
+        while (reaped.load() < STARTERS * PER_STARTER) {
+            reaped.fetch_add(static_cast<int>(jobs.reap_finished().size()));
+            std::this_thread::yield();
+        }
+    });
+    for (auto &starter : starters) starter.join();
+    reaper.join();
+    EXPECT_EQ(reaped.load(), STARTERS * PER_STARTER);
+    EXPECT_TRUE(jobs.list().empty());
+}
+
+TEST(Jobs, ProgressAccounting) {
+    JobState state;
+    {
+        JobScope scope(&state);
+        EXPECT_EQ(current_job(), &state);
+        job_expect(100);
+        job_start_items(60);    // announced work is used first
+        job_start_items(60);    // 20 more than announced
+        job_progress(90);
+    }
+    EXPECT_EQ(current_job(), nullptr);
+    EXPECT_EQ(state.total.load(), 120);
+    EXPECT_EQ(state.done.load(), 90);
+    EXPECT_EQ(state.percent(), 75);
+
+    // Outside a job every call is a no-op
+    job_expect(10);
+    job_progress(10);
+    EXPECT_NO_THROW(check_cancelled());
+}
@@ -0,0 +1,121 @@
+#include "backend/matrix_memory.h"
+#include "test_graphs.h"
+
+#include <cstdint>
+
+using namespace test_graphs;
+
+namespace {
+    // Smallest n whose matrix is mapped: 1449 x 1449 ints are just over 8 MB
+    constexpr int LARGE_N = 1449;
+
+    // Restores the process-wide setting whatever a test left behind
+    class HugePagesSetting {
+    public:
+        explicit HugePagesSetting(const bool enabled) : previous(huge_pages_enabled()) { set_huge_pages(enabled); }
+        ~HugePagesSetting() { set_huge_pages(previous); }
+
+    private:
+        bool previous;
+    };
+
+    bool all_zero(int** matrix, const int n) {
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < n; j++) {
+                if (matrix[i][j] != 0) return false;
+            }
+        }
+        return true;
+    }
+
+    // Distinct value per cell, read back after every row was written so overlapping rows would show
+    void expect_cells_hold_their_values(int** matrix, const int n) {
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < n; j++) {
+                matrix[i][j] = i * n + j;
+            }
+        }
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < n; j++) {
+                ASSERT_EQ(matrix[i][j], i * n + j) << "cell " << i << ", " << j;
+            }
+        }
+    }
+}
+
+TEST(MatrixMemory, ZeroedAndWritableWithAndWithoutHugePages) {
+    for (const bool huge : {false, true}) {
+        const HugePagesSetting setting(huge);
+        for (const int n : {0, 1, 64, LARGE_N}) {
+            SCOPED_TRACE(testing::Message() << "huge pages " << huge << ", n " << n);
+            int **matrix = allocate_matrix(n);
+            EXPECT_TRUE(all_zero(matrix, n));
+            expect_cells_hold_their_values(matrix, n);
+            free_matrix(matrix, n);
+        }
+    }
+}
+
+TEST(MatrixMemory, UnzeroedMatrixTakesEveryWrite) {
+    const HugePagesSetting setting(true);
+    for (const int n : {3, LARGE_N}) {
+        int **matrix = allocate_matrix(n, false);
+        expect_cells_hold_their_values(matrix, n);
+        free_matrix(matrix, n);
+    }
+}
+
+TEST(MatrixMemory, LargeMatricesAreMappedAndReleased) {
+    const HugePagesSetting setting(true);
+    const std::size_t before = mapped_matrix_bytes();
+
+    // Just below the threshold stays on the heap
+    int **small = allocate_matrix(LARGE_N - 1);
+    EXPECT_EQ(mapped_matrix_bytes(), before);
+
+    int **large = allocate_matrix(LARGE_N);
+    const std::size_t bytes = static_cast<std::size_t>(LARGE_N) * LARGE_N * sizeof(int);
+    EXPECT_GE(mapped_matrix_bytes(), before + bytes);
+    // One region starting on a huge page boundary, rows back to back
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(large[0]) % (std::uintptr_t{2} << 20), 0u);
+    EXPECT_EQ(large[LARGE_N - 1] - large[0], static_cast<std::ptrdiff_t>(LARGE_N - 1) * LARGE_N);
+
+    free_matrix(large, LARGE_N);
+    free_matrix(small, LARGE_N - 1);
+    EXPECT_EQ(mapped_matrix_bytes(), before);
+}
+
+TEST(MatrixMemory, SwitchedOffKeepsLargeMatricesOnTheHeap) {
+    const HugePagesSetting setting(false);
+    EXPECT_FALSE(huge_pages_enabled());
+    const std::size_t before = mapped_matrix_bytes();
+    int **matrix = allocate_matrix(LARGE_N);
+    EXPECT_EQ(mapped_matrix_bytes(), before);
+    free_matrix(matrix, LARGE_N);
+}
+
+TEST(MatrixMemory, FreeIgnoresNull) {
+    free_matrix(nullptr, 0);
+    free_matrix(nullptr, LARGE_N);
+}
+
+TEST(MatrixMemory, GraphsAreTheSameEitherWay) {
+    for (const unsigned int seed : SEEDS) {
+        for (const int n : {0, 1, 97, LARGE_N}) {
+            SCOPED_TRACE(testing::Message() << "seed " << seed << ", n " << n);
+            SharedGraph heap;
+            SharedGraph heap_union;
+            {
+                const HugePagesSetting setting(false);
+                heap = random_graph(n, seed, 0.01);
+                heap_union = make_shared_graph(graph_union(*heap, *heap));
+            }
+            const HugePagesSetting setting(true);
+            const SharedGraph mapped = random_graph(n, seed, 0.01);
+            expect_same_graph(*heap, *mapped);
+
+            // Binary kernels write their results into mapped rows as well
+            expect_same_graph(*heap_union, *make_shared_graph(graph_union(*mapped, *mapped)));
+        }
+    }
+}
@@ -0,0 +1,113 @@
+#include "backend/bit_matrix.h"
+#include "backend/memory_budget.h"
+#include "backend/shared_store.h"
+#include "test_graphs.h"
+
+#include <string>
+#include <unistd.h>
+
+using namespace test_graphs;
+
+namespace {
+    const std::vector<GraphOp> ALL_OPS{GraphOp::Union, GraphOp::Intersection, GraphOp::RingSum,
+                                       GraphOp::CartesianProduct};
+
+    // Size pairs small enough that products stay cheap
+    const std::vector<std::pair<int, int>> PRODUCT_SIZES{{0, 0}, {0, 7}, {5, 0}, {1, 1}, {12, 30}, {30, 12}, {20, 21}};
+
+    std::size_t heap_matrix_bytes(const std::size_t n) {
+        return n * n * sizeof(int) + n * sizeof(int*);
+    }
+}
+
+TEST(MemoryBudget, FootprintOfAHeapGraph) {
+    const SharedGraph graph = graph_from_edges(3, {{0, 1}, {1, 2}, {2, 2}});
+    const GraphFootprint footprint = graph_footprint(*graph);
+    EXPECT_EQ(footprint.matrix, heap_matrix_bytes(3));
+    EXPECT_EQ(footprint.mapped, 0u);
+    EXPECT_GE(footprint.lists, 3 * sizeof(std::vector<int>) + 5 * sizeof(int));
+    EXPECT_EQ(footprint.total(), footprint.matrix + footprint.lists);
+
+    const GraphFootprint empty = graph_footprint(*graph_from_edges(0, {}));
+    EXPECT_EQ(empty.total(), 0u);
+}
+
+TEST(MemoryBudget, AttachedMatrixCountsAsMapped) {
+    const SharedGraph graph = random_graph(40, SEEDS[0]);
+    const std::string name = "/lab6_test_" + std::to_string(getpid()) + "_footprint";
+    publish_graph(*graph, name);
+    const SharedGraph attached = attach_graph(name);
+    unpublish_graph(name);
+
+    const GraphFootprint footprint = graph_footprint(*attached);
+    EXPECT_EQ(footprint.mapped, 40u * 40 * sizeof(int));
+    EXPECT_EQ(footprint.matrix, 40 * sizeof(int*));
+    EXPECT_EQ(footprint.matrix + footprint.mapped, graph_footprint(*graph).matrix);
+}
+
+TEST(MemoryBudget, LeavesCostNothing) {
+    const SharedGraph graph = random_graph(30, SEEDS[0]);
+    const ExprPtr leaf = expr_leaf(graph.get(), "A");
+    EXPECT_EQ(predict_footprint(leaf).total(), 0u);
+    EXPECT_EQ(predict_entries(leaf), static_cast<std::size_t>(count_list_entries(*graph)));
+}
+
+TEST(MemoryBudget, PredictionCoversTheResult) {
+    for (const unsigned int seed : SEEDS) {
+        for (const GraphOp op : ALL_OPS) {
+            for (const auto &[n1, n2] : op == GraphOp::CartesianProduct ? PRODUCT_SIZES : SIZE_PAIRS) {
+                SCOPED_TRACE(testing::Message() << "seed " << seed << ", sizes " << n1 << " and " << n2
+                             << ", op " << static_cast<int>(op));
+                const SharedGraph a = random_graph(n1, seed);
+                const SharedGraph b = random_graph(n2, seed + 100);
+                const ExprPtr expr = expr_binary(op, expr_leaf(a.get(), "A"), expr_leaf(b.get(), "B"));
+                const SharedGraph result = make_shared_graph(evaluate(expr));
+
+                const GraphFootprint predicted = predict_footprint(expr);
+                EXPECT_GE(predicted.matrix, graph_footprint(*result).matrix);
+                EXPECT_GE(predict_entries(expr), static_cast<std::size_t>(count_list_entries(*result)));
+                EXPECT_EQ(predicted.mapped, 0u);
+            }
+        }
+    }
+}
+
+TEST(MemoryBudget, NestedExpressionsCostAtLeastTheirParts) {
+    const SharedGraph a = random_graph(60, SEEDS[0]);
+    const SharedGraph b = random_graph(80, SEEDS[1]);
+    const SharedGraph c = random_graph(10, SEEDS[2]);
+    const ExprPtr ring = expr_binary(GraphOp::RingSum, expr_leaf(a.get(), "A"), expr_leaf(b.get(), "B"));
+    const ExprPtr product = expr_binary(GraphOp::CartesianProduct, ring, expr_leaf(c.get(), "C"));
+
+    // The product keeps its materialized ring sum operand alive next to its own result
+    EXPECT_GE(predict_footprint(product).total(), predict_footprint(ring).total());
+    EXPECT_GE(predict_footprint(product).total(), heap_matrix_bytes(80 * 10) + heap_matrix_bytes(80));
+
+    const SharedGraph result = make_shared_graph(evaluate(product));
+    EXPECT_GE(predict_footprint(product).matrix, graph_footprint(*result).matrix);
+    EXPECT_GE(predict_entries(product), static_cast<std::size_t>(count_list_entries(*result)));
+}
+
+TEST(MemoryBudget, CreatePredictionMatchesCreatedGraph) {
+    for (const unsigned int seed : SEEDS) {
+        for (const int n : {0, 1, 50, 400}) {
+            SCOPED_TRACE(testing::Message() << "seed " << seed << ", n " << n);
+            const SharedGraph graph = random_graph(n, seed, 0.3, 0.0);
+            const GraphFootprint predicted = predict_create_footprint(n, 0.3);
+            const GraphFootprint actual = graph_footprint(*graph);
+            EXPECT_EQ(predicted.matrix, actual.matrix);
+            // Expected entries, the sample lands within a few percent of them for the larger graphs
+            const auto entries = static_cast<double>(count_list_entries(*graph));
+            const double expected = 0.3 * n * n;
+            EXPECT_NEAR(entries, expected, expected * 0.1 + 10);
+        }
+    }
+}
+
+TEST(MemoryBudget, MachineMemoryIsKnown) {
+    const std::size_t physical = physical_memory_bytes();
+    const std::size_t resident = resident_bytes();
+    EXPECT_GT(physical, 0u);
+    EXPECT_GT(resident, 0u);
+    EXPECT_LT(resident, physical);
+}
@@ -0,0 +1,160 @@
+#include "backend/op_planner.h"
+#include "test_graphs.h"
+
+#include <cstdint>
+
+using namespace test_graphs;
+
+namespace {
+    const std::vector<GraphOp> SET_OPS{GraphOp::Union, GraphOp::Intersection, GraphOp::RingSum};
+
+    const StrategyCost &candidate(const OpPlan &plan, const Strategy strategy) {
+        for (const StrategyCost &cost : plan.candidates) {
+            if (cost.strategy == strategy) return cost;
+        }
+        ADD_FAILURE() << "no candidate " << strategy_name(strategy);
+        return plan.candidates.front();
+    }
+
+    // Plan with the strategy forced, as if the estimator had picked it
+    OpPlan forced(const ExprPtr &expr, const Strategy strategy) {
+        OpPlan plan = plan_operation(expr, SIZE_MAX, 0, strategy == Strategy::WorkerProcesses ? 3 : 0);
+        plan.chosen = strategy;
+        return plan;
+    }
+}
+
+TEST(MergeLists, MatchesDenseKernels) {
+    for (const unsigned int seed : SEEDS) {
+        for (const auto &[n1, n2] : SIZE_PAIRS) {
+            for (const double density : {0.02, 0.3}) {
+                const SharedGraph a = random_graph(n1, seed, density);
+                const SharedGraph b = random_graph(n2, seed + 100, density);
+                for (const GraphOp op : SET_OPS) {
+                    SCOPED_TRACE(testing::Message() << "seed " << seed << ", sizes " << n1 << " and " << n2
+                                 << ", density " << density << ", op " << static_cast<int>(op));
+                    const SharedGraph expected = make_shared_graph(eager_op(op, *a, *b));
+                    const SharedGraph merged = make_shared_graph(merge_lists(*a, *b, op));
+                    expect_same_graph(*expected, *merged);
+                }
+            }
+        }
+    }
+}
+
+TEST(MergeLists, OperandWithItself) {
+    const SharedGraph a = random_graph(80, SEEDS[0]);
+    expect_same_graph(*a, *make_shared_graph(merge_lists(*a, *a, GraphOp::Union)));
+    expect_same_graph(*a, *make_shared_graph(merge_lists(*a, *a, GraphOp::Intersection)));
+    // Every edge cancels, the ring sum drops the vertices left isolated
+    expect_same_graph(*make_shared_graph(ring_sum(*a, *a)), *make_shared_graph(merge_lists(*a, *a, GraphOp::RingSum)));
+}
+
+TEST(OpPlanner, EveryStrategyIsEstimated) {
+    const SharedGraph a = random_graph(200, SEEDS[0]);
+    const SharedGraph b = random_graph(150, SEEDS[1]);
+    for (const GraphOp op : {GraphOp::Union, GraphOp::Intersection, GraphOp::RingSum, GraphOp::CartesianProduct}) {
+        SCOPED_TRACE(static_cast<int>(op));
+        const ExprPtr expr = expr_binary(op, expr_leaf(a.get(), "A"), expr_leaf(b.get(), "B"));
+        const OpPlan plan = plan_operation(expr, SIZE_MAX, std::size_t{1} << 40, 0);
+        EXPECT_EQ(plan.n, expr->n);
+        EXPECT_EQ(plan.entries, predict_entries(expr));
+        EXPECT_EQ(plan.candidates.size(), 5u);
+        EXPECT_EQ(plan.choice().strategy, plan.chosen);
+        for (const StrategyCost &cost : plan.candidates) {
+            EXPECT_GE(cost.seconds, 0) << strategy_name(cost.strategy);
+        }
+        EXPECT_FALSE(candidate(plan, Strategy::WorkerProcesses).available);
+        EXPECT_EQ(candidate(plan, Strategy::ListMerge).available, op != GraphOp::CartesianProduct);
+        EXPECT_EQ(candidate(plan, Strategy::OutOfCore).available, op == GraphOp::CartesianProduct);
+    }
+}
+
+TEST(OpPlanner, WithoutLimitsTheFastestInMemoryStrategyWins) {
+    for (const double density : {0.01, 0.5}) {
+        const SharedGraph a = random_graph(300, SEEDS[0], density);
+        const SharedGraph b = random_graph(300, SEEDS[1], density);
+        for (const GraphOp op : SET_OPS) {
+            SCOPED_TRACE(testing::Message() << "density " << density << ", op " << static_cast<int>(op));
+            const ExprPtr expr = expr_binary(op, expr_leaf(a.get(), "A"), expr_leaf(b.get(), "B"));
+            const OpPlan plan = plan_operation(expr, SIZE_MAX);
+            ASSERT_TRUE(plan.chosen == Strategy::DenseMatrix || plan.chosen == Strategy::ListMerge);
+            const double dense = candidate(plan, Strategy::DenseMatrix).seconds;
+            const double merge = candidate(plan, Strategy::ListMerge).seconds;
+            EXPECT_EQ(plan.chosen, dense <= merge ? Strategy::DenseMatrix : Strategy::ListMerge);
+        }
+    }
+}
+
+TEST(OpPlanner, NoMemoryKeepsTheExpressionLazy) {
+    const SharedGraph a = random_graph(100, SEEDS[0]);
+    const SharedGraph b = random_graph(100, SEEDS[1]);
+    for (const GraphOp op : SET_OPS) {
+        const ExprPtr expr = expr_binary(op, expr_leaf(a.get(), "A"), expr_leaf(b.get(), "B"));
+        EXPECT_EQ(plan_operation(expr, 0, std::size_t{1} << 40).chosen, Strategy::LazyView);
+    }
+}
+
+TEST(OpPlanner, ProductThatFitsNowhereGoesToDisk) {
+    const SharedGraph a = random_graph(100, SEEDS[0]);
+    const SharedGraph b = random_graph(100, SEEDS[1]);
+    const ExprPtr expr = expr_binary(GraphOp::CartesianProduct, expr_leaf(a.get(), "A"), expr_leaf(b.get(), "B"));
+    const std::size_t in_memory = candidate(plan_operation(expr, SIZE_MAX), Strategy::DenseMatrix).bytes;
+
+    // A budget below the matrix but above one block of rows and the factor lists
+    const OpPlan plan = plan_operation(expr, in_memory / 4, std::size_t{1} << 40);
+    EXPECT_EQ(plan.chosen, Strategy::OutOfCore);
+    EXPECT_LE(plan.block_bytes, in_memory / 8);
+    EXPECT_EQ(candidate(plan, Strategy::OutOfCore).file_bytes, disk_graph_bytes(10'000, plan.entries));
+
+    // Without spill space, or with too little of it, the product stays lazy
+    EXPECT_EQ(plan_operation(expr, in_memory / 4, 0).chosen, Strategy::LazyView);
+    EXPECT_EQ(plan_operation(expr, in_memory / 4, 1024).chosen, Strategy::LazyView);
+}
+
+TEST(OpPlanner, WorkerProcessesReplaceTheDenseScan) {
+    const SharedGraph a = random_graph(200, SEEDS[0], 0.5);
+    const SharedGraph b = random_graph(200, SEEDS[1], 0.5);
+    const ExprPtr ring = expr_binary(GraphOp::RingSum, expr_leaf(a.get(), "A"), expr_leaf(b.get(), "B"));
+    const OpPlan plan = plan_operation(ring, SIZE_MAX, 0, 4);
+    EXPECT_TRUE(candidate(plan, Strategy::WorkerProcesses).available);
+    EXPECT_NE(plan.chosen, Strategy::DenseMatrix);
+    EXPECT_EQ(plan.processes, 4);
+
+    const ExprPtr common = expr_binary(GraphOp::Intersection, expr_leaf(a.get(), "A"), expr_leaf(b.get(), "B"));
+    EXPECT_FALSE(candidate(plan_operation(common, SIZE_MAX, 0, 4), Strategy::WorkerProcesses).available);
+}
+
+TEST(OpPlanner, RunPlanMatchesEagerKernels) {
+    for (const unsigned int seed : SEEDS) {
+        for (const auto &[n1, n2] : SIZE_PAIRS) {
+            const SharedGraph a = random_graph(n1, seed);
+            const SharedGraph b = random_graph(n2, seed + 100);
+            for (const GraphOp op : SET_OPS) {
+                const ExprPtr expr = expr_binary(op, expr_leaf(a.get(), "A"), expr_leaf(b.get(), "B"));
+                const SharedGraph expected = make_shared_graph(eager_op(op, *a, *b));
+                for (const Strategy strategy : {Strategy::DenseMatrix, Strategy::ListMerge, Strategy::WorkerProcesses}) {
+                    if (strategy == Strategy::WorkerProcesses && op == GraphOp::Intersection) continue;
+                    SCOPED_TRACE(testing::Message() << "seed " << seed << ", sizes " << n1 << " and " << n2
+                                 << ", op " << static_cast<int>(op) << ", " << strategy_name(strategy));
+                    expect_same_graph(*expected, *run_plan(forced(expr, strategy), expr));
+                }
+            }
+        }
+    }
+}
+
+TEST(OpPlanner, RunPlanEvaluatesPendingOperands) {
+    const SharedGraph a = random_graph(60, SEEDS[0]);
+    const SharedGraph b = random_graph(45, SEEDS[1]);
+    const SharedGraph c = random_graph(70, SEEDS[2]);
+    const ExprPtr ring = expr_binary(GraphOp::RingSum, expr_leaf(a.get(), "A"), expr_leaf(b.get(), "B"));
+    const ExprPtr expr = expr_binary(GraphOp::Union, ring, expr_leaf(c.get(), "C"));
+
+    const SharedGraph ring_ab = make_shared_graph(ring_sum(*a, *b));
+    const SharedGraph expected = make_shared_graph(graph_union(*ring_ab, *c));
+    for (const Strategy strategy : {Strategy::DenseMatrix, Strategy::ListMerge, Strategy::WorkerProcesses}) {
+        SCOPED_TRACE(strategy_name(strategy));
+        expect_same_graph(*expected, *run_plan(forced(expr, strategy), expr));
+    }
+}
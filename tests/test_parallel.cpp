@@ -0,0 +1,103 @@
+#include "backend/parallel.h"
+#include "test_graphs.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+
+using namespace test_graphs;
+
+namespace {
+    // Restores the default thread count when a test changes it
+    struct ThreadCountGuard {
+        ~ThreadCountGuard() { set_thread_count(0); }
+    };
+}
+
+TEST(Parallel, EveryIndexRunsOnce) {
+    ThreadCountGuard guard;
+    for (const int threads : {1, 2, 4}) {
+        set_thread_count(threads);
+        EXPECT_EQ(hardware_threads(), threads);
+        for (const int count : {0, 1, 7, 1000, 100000}) {
+            for (const int grain : {1, 64, 1 << 20}) {
+                std::vector<std::atomic<int>> hits(count);
+                parallel_for(count, [&](const int begin, const int end) {
+                    ASSERT_LE(0, begin);
+                    ASSERT_LE(begin, end);
+                    ASSERT_LE(end, count);
+                    for (int i = begin; i < end; i++) hits[i].fetch_add(1);
+                }, grain);
+                for (int i = 0; i < count; i++) {
+                    ASSERT_EQ(hits[i].load(), 1) << "threads " << threads << ", count " << count << ", index " << i;
+                }
+            }
+        }
+    }
+}
+
+TEST(Parallel, NestedLoopsComplete) {
+    ThreadCountGuard guard;
+    set_thread_count(4);
+    std::atomic<long long> total{0};
+    parallel_for(64, [&](const int begin, const int end) {
+        for (int i = begin; i < end; i++) {
+            parallel_for(256, [&](const int b, const int e) { total.fetch_add(e - b); }, 8);
+        }
+    }, 1);
+    EXPECT_EQ(total.load(), 64LL * 256);
+}
+
+TEST(Parallel, ExceptionsReachTheCaller) {
+    ThreadCountGuard guard;
+    set_thread_count(3);
+    EXPECT_THROW(parallel_for(1000, [](const int begin, const int) {
+        if (begin > 0) throw std::runtime_error("chunk failed");
+    }, 10), std::runtime_error);
+
+    // The executor is still usable afterwards
+    std::atomic<int> done{0};
+    parallel_for(1000, [&](const int begin, const int end) { done.fetch_add(end - begin); }, 10);
+    EXPECT_EQ(done.load(), 1000);
+}
+
+TEST(Parallel, ResizeWhileLoopsRun) {
+    ThreadCountGuard guard;
+    set_thread_count(4);
+    std::atomic<bool> stop{false};
+    std::atomic<long long> covered{0};
+    std::thread resizer([&] {
+        for (int k = 0; k < 50 && !stop.load(); k++) {
+            set_thread_count(1 + k % 4);
+            std::this_thread::yield();
+        }
+    });
+    for (int round = 0; round < 200; round++) {
+        parallel_for(4096, [&](const int begin, const int end) {
+            for (int i = begin; i < end; i++) covered.fetch_add(1, std::memory_order_relaxed);
+        }, 16);
+    }
+    stop.store(true);
+    resizer.join();
+    EXPECT_EQ(covered.load(), 200LL * 4096);
+}
+
+TEST(Parallel, KernelsAgreeAcrossThreadCounts) {
+    ThreadCountGuard guard;
+    const SharedGraph a = random_graph(300, SEEDS[0]);
+    const SharedGraph b = random_graph(200, SEEDS[1]);
+    set_thread_count(1);
+    const SharedGraph single = make_shared_graph(graph_union(*a, *b));
+    const SharedGraph created = random_graph(300, SEEDS[0]);
+    set_thread_count(4);
+    const SharedGraph many = make_shared_graph(graph_union(*a, *b));
+    expect_same_graph(*single, *many);
+    // Generation is seeded per row, the thread count does not change the graph
+    expect_same_graph(*created, *a);
+}
+
+TEST(Parallel, RowGrain) {
+    EXPECT_GE(row_grain(1), row_grain(1000));
+    EXPECT_EQ(row_grain(1LL << 40), 1);
+    EXPECT_EQ(row_grain(0), row_grain(1));
+}
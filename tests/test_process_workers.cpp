@@ -0,0 +1,73 @@
+#include "backend/jobs.h"
+#include "backend/process_workers.h"
+#include "test_graphs.h"
+
+#include <stdexcept>
+
+using namespace test_graphs;
+
+namespace {
+    // Products stay below a few thousand vertices
+    const std::vector<std::pair<int, int>> PRODUCT_SIZES{{0, 0}, {0, 7}, {5, 0}, {1, 1}, {12, 30}, {30, 12}, {40, 65}};
+}
+
+TEST(ProcessWorkers, MatchDenseKernels) {
+    for (const unsigned int seed : SEEDS) {
+        for (const GraphOp op : {GraphOp::Union, GraphOp::RingSum, GraphOp::CartesianProduct}) {
+            for (const auto &[n1, n2] : op == GraphOp::CartesianProduct ? PRODUCT_SIZES : SIZE_PAIRS) {
+                const SharedGraph a = random_graph(n1, seed);
+                const SharedGraph b = random_graph(n2, seed + 100);
+                const SharedGraph expected = make_shared_graph(eager_op(op, *a, *b));
+                for (const int processes : {1, 2, 5}) {
+                    SCOPED_TRACE(testing::Message() << "seed " << seed << ", sizes " << n1 << " and " << n2
+                                 << ", op " << static_cast<int>(op) << ", processes " << processes);
+                    const SharedGraph result = run_in_processes(*a, *b, op, processes);
+                    // A ring sum that dropped isolated vertices was renumbered into a heap copy
+                    if (op != GraphOp::RingSum || result->n == std::max(n1, n2)) {
+                        EXPECT_TRUE(result->read_only);
+                    }
+                    expect_same_graph(*expected, *result);
+                }
+            }
+        }
+    }
+}
+
+TEST(ProcessWorkers, MoreProcessesThanRows) {
+    const SharedGraph a = random_graph(3, SEEDS[0]);
+    const SharedGraph b = random_graph(2, SEEDS[1]);
+    const SharedGraph expected = make_shared_graph(graph_union(*a, *b));
+    expect_same_graph(*expected, *run_in_processes(*a, *b, GraphOp::Union, 16));
+}
+
+TEST(ProcessWorkers, RefuseIntersectionAndHugeProducts) {
+    const SharedGraph a = random_graph(10, SEEDS[0]);
+    EXPECT_THROW(run_in_processes(*a, *a, GraphOp::Intersection, 2), std::invalid_argument);
+
+    // Only the vertex counts are read before the size check
+    Graph wide;
+    wide.n = 70'000;
+    EXPECT_THROW(run_in_processes(wide, wide, GraphOp::CartesianProduct, 2), std::runtime_error);
+}
+
+TEST(ProcessWorkers, CancelledJobStopsTheWorkers) {
+    const SharedGraph a = random_graph(60, SEEDS[0]);
+    const SharedGraph b = random_graph(60, SEEDS[1]);
+    JobState state;
+    state.cancel_requested = true;
+    JobScope scope(&state);
+    EXPECT_THROW(run_in_processes(*a, *b, GraphOp::CartesianProduct, 2), JobCancelled);
+}
+
+TEST(ProcessWorkers, ProgressIsReportedToTheJob) {
+    const SharedGraph a = random_graph(40, SEEDS[0]);
+    const SharedGraph b = random_graph(50, SEEDS[1]);
+    JobState state;
+    {
+        JobScope scope(&state);
+        run_in_processes(*a, *b, GraphOp::CartesianProduct, 2);
+    }
+    EXPECT_GT(state.total.load(), 0);
+    EXPECT_LE(state.done.load(), state.total.load());
+    EXPECT_GT(state.done.load(), 0);
+}
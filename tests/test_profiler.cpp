@@ -0,0 +1,163 @@
+#include "core/profiler.h"
+#include "test_graphs.h"
+
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+using namespace test_graphs;
+
+namespace {
+    // Profiling on for one test, off again afterwards
+    class ProfilerTest : public testing::Test {
+    protected:
+        void SetUp() override { profiling::enabled = true; }
+        void TearDown() override { profiling::enabled = false; }
+    };
+
+    // Quarter-octave buckets report the middle of the bucket, at most about 12.5% off
+    void expect_close(const std::uint64_t expected, const std::uint64_t actual) {
+        EXPECT_NEAR(static_cast<double>(actual), static_cast<double>(expected), expected * 0.13 + 1)
+            << "expected about " << expected;
+    }
+}
+
+TEST(ProfileSite, SummaryOfRecordedCalls) {
+    ProfileSite site("test", "summary");
+    EXPECT_EQ(site.summary().calls, 0u);
+    EXPECT_EQ(site.summary().p50_ns, 0u);
+
+    // 1..1000 us: the median is 500 us, p99 990 us
+    for (std::uint64_t us = 1; us <= 1000; us++) {
+        site.record(us * 1000, 2, 64);
+    }
+    const auto summary = site.summary();
+    EXPECT_EQ(summary.calls, 1000u);
+    EXPECT_EQ(summary.total_ns, 500500u * 1000);
+    EXPECT_EQ(summary.max_ns, 1000u * 1000);
+    EXPECT_EQ(summary.allocations, 2000u);
+    EXPECT_EQ(summary.allocated_bytes, 64000u);
+    expect_close(500'000, summary.p50_ns);
+    expect_close(990'000, summary.p99_ns);
+    EXPECT_LE(summary.p99_ns, summary.max_ns);
+
+    site.reset();
+    EXPECT_EQ(site.summary().calls, 0u);
+    EXPECT_EQ(site.summary().max_ns, 0u);
+}
+
+TEST(ProfileSite, SmallAndSingleDurations) {
+    ProfileSite site("test", "small");
+    for (const std::uint64_t ns : {0u, 1u, 2u, 3u}) {
+        site.record(ns, 0, 0);
+    }
+    EXPECT_LE(site.summary().p50_ns, 2u);
+    EXPECT_EQ(site.summary().max_ns, 3u);
+
+    // A lone call is reported exactly
+    ProfileSite single("test", "single");
+    single.record(123'456'789, 0, 0);
+    EXPECT_EQ(single.summary().p50_ns, 123'456'789u);
+    EXPECT_EQ(single.summary().p99_ns, 123'456'789u);
+}
+
+TEST(ProfileSite, ConcurrentRecordsAreAllCounted) {
+    ProfileSite site("test", "concurrent");
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&site, t] {
+            for (int i = 0; i < 10'000; i++) site.record(static_cast<std::uint64_t>(t * 1000 + i), 1, 8);
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    EXPECT_EQ(site.summary().calls, 40'000u);
+    EXPECT_EQ(site.summary().allocations, 40'000u);
+    EXPECT_EQ(site.summary().max_ns, 3000u + 9'999);
+}
+
+TEST(ProfileRegistry, SitesAreSharedByName) {
+    ProfileSite& first = profile_site("test", "shared");
+    ProfileSite& again = profile_site("test", "shared");
+    ProfileSite& other = profile_site("other", "shared");
+    EXPECT_EQ(&first, &again);
+    EXPECT_NE(&first, &other);
+
+    const auto sites = profile_sites();
+    EXPECT_NE(std::ranges::find(sites, &first), sites.end());
+    // Ordered by category, then name
+    for (size_t i = 1; i < sites.size(); i++) {
+        EXPECT_LE(std::pair(sites[i - 1]->category, sites[i - 1]->name), std::pair(sites[i]->category, sites[i]->name));
+    }
+}
+
+TEST_F(ProfilerTest, ScopeRecordsTimeAndAllocations) {
+    ProfileSite& site = profile_site("test", "scope");
+    site.reset();
+    {
+        ProfileScope scope(site);
+        const auto block = std::make_unique<char[]>(10'000);
+        block[0] = 1;
+    }
+    const auto summary = site.summary();
+    EXPECT_EQ(summary.calls, 1u);
+    EXPECT_GE(summary.allocations, 1u);
+    EXPECT_GE(summary.allocated_bytes, 10'000u);
+}
+
+TEST_F(ProfilerTest, AlignedAllocationsAreCounted) {
+    struct alignas(128) Padded {
+        char bytes[128];
+    };
+    const auto before = profiling::allocation_totals();
+    const auto block = std::make_unique<Padded[]>(4);
+    block[0].bytes[0] = 1;
+    const auto after = profiling::allocation_totals();
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(block.get()) % alignof(Padded), 0u);
+    EXPECT_EQ(after.count - before.count, 1u);
+    EXPECT_GE(after.bytes - before.bytes, 4 * sizeof(Padded));
+}
+
+TEST(Profiler, DisabledProfilingCountsNoAllocations) {
+    profiling::enabled = false;
+    const auto before = profiling::allocation_totals();
+    const auto block = std::make_unique<char[]>(10'000);
+    block[0] = 1;
+    const auto after = profiling::allocation_totals();
+    EXPECT_EQ(after.count, before.count);
+    EXPECT_EQ(after.bytes, before.bytes);
+}
+
+TEST_F(ProfilerTest, FinishEndsTheScopeOnce) {
+    ProfileSite& site = profile_site("test", "finish");
+    site.reset();
+    {
+        ProfileScope scope(site);
+        scope.finish();
+        scope.finish();
+    }
+    EXPECT_EQ(site.summary().calls, 1u);
+}
+
+TEST(Profiler, DisabledScopeRecordsNothing) {
+    profiling::enabled = false;
+    ProfileSite& site = profile_site("test", "disabled");
+    site.reset();
+    {
+        ProfileScope scope(site);
+    }
+    EXPECT_EQ(site.summary().calls, 0u);
+}
+
+TEST_F(ProfilerTest, KernelsReportTheirSites) {
+    reset_profile();
+    const SharedGraph a = random_graph(50, SEEDS[0]);
+    const SharedGraph b = random_graph(60, SEEDS[1]);
+    const SharedGraph both = make_shared_graph(graph_union(*a, *b));
+
+    EXPECT_EQ(profile_site("backend", "create_graph").summary().calls, 2u);
+    EXPECT_GE(profile_site("backend", "graph_union").summary().calls, 1u);
+    EXPECT_GT(profile_site("backend", "create_graph").summary().allocated_bytes, 50u * 50 * sizeof(int));
+
+    reset_profile();
+    EXPECT_EQ(profile_site("backend", "create_graph").summary().calls, 0u);
+}
@@ -0,0 +1,95 @@
+#include "backend/result_cache.h"
+#include "test_graphs.h"
+
+using namespace test_graphs;
+
+namespace {
+    SharedGraph union_of(const SharedGraph &a, const SharedGraph &b) {
+        return make_shared_graph(graph_union(*a, *b));
+    }
+}
+
+TEST(ResultCache, HitsOnlyTheSameOperationAndVersions) {
+    const SharedGraph a = random_graph(30, SEEDS[0]);
+    const SharedGraph b = random_graph(30, SEEDS[1]);
+    ResultCache cache;
+    EXPECT_EQ(cache.find(GraphOp::Union, a->version, b->version), nullptr);
+
+    const SharedGraph result = union_of(a, b);
+    cache.insert(GraphOp::Union, a->version, b->version, result);
+    EXPECT_EQ(cache.find(GraphOp::Union, a->version, b->version), result);
+    EXPECT_EQ(cache.find(GraphOp::Union, b->version, a->version), nullptr);
+    EXPECT_EQ(cache.find(GraphOp::Intersection, a->version, b->version), nullptr);
+
+    // An edit gives the operand a new version, the old result is no longer found
+    Graph edited = create_graph(30, 0.3, 0.1, SEEDS[0]);
+    identify_vertices(edited, 0, 1);
+    EXPECT_EQ(cache.find(GraphOp::Union, edited.version, b->version), nullptr);
+    delete_graph(edited, edited.n);
+
+    EXPECT_EQ(cache.hit_count(), 1u);
+    EXPECT_EQ(cache.miss_count(), 4u);
+    EXPECT_EQ(cache.used(), graph_bytes(*result));
+}
+
+TEST(ResultCache, EvictsLeastRecentlyUsedWithinBudget) {
+    const SharedGraph a = random_graph(50, SEEDS[0]);
+    const SharedGraph b = random_graph(50, SEEDS[1]);
+    const SharedGraph c = random_graph(50, SEEDS[2]);
+    const SharedGraph ab = union_of(a, b);
+    const SharedGraph bc = union_of(b, c);
+    const SharedGraph ca = union_of(c, a);
+
+    // Room for two of the three results
+    ResultCache cache(graph_bytes(*ab) + graph_bytes(*bc) + graph_bytes(*ca) / 2);
+    cache.insert(GraphOp::Union, a->version, b->version, ab);
+    cache.insert(GraphOp::Union, b->version, c->version, bc);
+    ASSERT_NE(cache.find(GraphOp::Union, a->version, b->version), nullptr);   // ab is now the most recent
+    cache.insert(GraphOp::Union, c->version, a->version, ca);
+
+    EXPECT_EQ(cache.size(), 2u);
+    EXPECT_EQ(cache.find(GraphOp::Union, b->version, c->version), nullptr);
+    EXPECT_EQ(cache.find(GraphOp::Union, a->version, b->version), ab);
+    EXPECT_EQ(cache.find(GraphOp::Union, c->version, a->version), ca);
+    EXPECT_LE(cache.used(), cache.budget());
+
+    cache.set_budget(graph_bytes(*ca));
+    EXPECT_EQ(cache.size(), 1u);
+    EXPECT_EQ(cache.find(GraphOp::Union, c->version, a->version), ca);
+
+    cache.clear();
+    EXPECT_EQ(cache.size(), 0u);
+    EXPECT_EQ(cache.used(), 0u);
+}
+
+TEST(ResultCache, SkipsResultsLargerThanTheBudget) {
+    const SharedGraph a = random_graph(64, SEEDS[0]);
+    const SharedGraph result = union_of(a, a);
+    ResultCache cache(graph_bytes(*result) - 1);
+    cache.insert(GraphOp::Union, a->version, a->version, result);
+    EXPECT_EQ(cache.size(), 0u);
+    EXPECT_EQ(cache.find(GraphOp::Union, a->version, a->version), nullptr);
+}
+
+TEST(ResultCache, ExclusiveCountsOnlyUnsharedEntries) {
+    const SharedGraph a = random_graph(20, SEEDS[0]);
+    const SharedGraph b = random_graph(20, SEEDS[1]);
+    ResultCache cache;
+    SharedGraph held = union_of(a, b);
+    const std::size_t bytes = graph_bytes(*held);
+    cache.insert(GraphOp::Union, a->version, b->version, held);
+    cache.insert(GraphOp::Intersection, a->version, b->version,
+                 make_shared_graph(graph_intersection(*a, *b)));
+    EXPECT_EQ(cache.exclusive(), cache.used() - bytes);
+    held.reset();
+    EXPECT_EQ(cache.exclusive(), cache.used());
+}
+
+TEST(ResultCache, GraphBytesCountsMatrixAndLists) {
+    const SharedGraph empty = random_graph(0, SEEDS[0]);
+    EXPECT_EQ(graph_bytes(*empty), 0u);
+    const SharedGraph g = random_graph(10, SEEDS[0]);
+    std::size_t entries = 0;
+    for (const auto &list : g->adj_list) entries += list.size();
+    EXPECT_GE(graph_bytes(*g), 10u * 10u * sizeof(int) + 10u * sizeof(int*) + entries * sizeof(int));
+}
@@ -0,0 +1,168 @@
+#include "core/script_scheduler.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <sstream>
+#include <string>
+
+namespace {
+    /**
+     * Commands over named values:
+     *   set <name> <value> [ms]  waits ms, then writes name
+     *   get <name>               prints name=value
+     *   meet <name>              waits until another meet runs next to it
+     *   all                      touches everything, checks it runs alone
+     */
+    class SchedulerTest : public testing::Test {
+    protected:
+        Console console;
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::map<std::string, std::string> values;
+        std::atomic<int> active{0};
+        int meeting = 0;
+        bool overlapped_barrier = false;
+        std::atomic<int> barriers_run{0};
+
+        void SetUp() override {
+            console.register_command("set", [this](const std::vector<std::string>& args) {
+                Running running(active);
+                if (args.size() > 2) std::this_thread::sleep_for(std::chrono::milliseconds(std::stoi(args[2])));
+                std::lock_guard lock(mutex);
+                values[args[0]] = args[1];
+            });
+            console.register_command("get", [this](const std::vector<std::string>& args) {
+                Running running(active);
+                std::lock_guard lock(mutex);
+                const auto it = values.find(args[0]);
+                if (it == values.end()) {
+                    console.mark_failed();
+                    Console::out() << args[0] << " is not set" << '\n';
+                    return;
+                }
+                Console::out() << args[0] << "=" << it->second << '\n';
+            });
+            console.register_command("meet", [this](const std::vector<std::string>& args) {
+                Running running(active);
+                std::unique_lock lock(mutex);
+                meeting++;
+                changed.notify_all();
+                const bool met = changed.wait_for(lock, std::chrono::seconds(5), [this] { return meeting >= 2; });
+                Console::out() << args[0] << (met ? " met" : " alone") << '\n';
+            });
+            console.register_command("all", [this](const std::vector<std::string>&) {
+                Running running(active);
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                if (active.load() != 1) overlapped_barrier = true;
+                barriers_run++;
+                Console::out() << "all" << '\n';
+            });
+        }
+
+        static CommandAccess access(const std::vector<std::string>& tokens) {
+            CommandAccess result;
+            if (tokens.empty()) return result;
+            if (tokens[0] == "set" && tokens.size() > 1) {
+                result.writes.push_back(tokens[1]);
+            } else if ((tokens[0] == "get" || tokens[0] == "meet") && tokens.size() > 1) {
+                result.reads.push_back(tokens[1]);
+            } else {
+                result.barrier = true;
+            }
+            return result;
+        }
+
+        // Runs the script on lines_at_once threads, returns what it printed
+        std::string run(const std::string& script, const int lines_at_once, const bool stop_on_error = false,
+                        int* failures = nullptr) {
+            std::istringstream in(script);
+            std::ostringstream printed;
+            std::streambuf* previous = std::cout.rdbuf(printed.rdbuf());
+            ScriptScheduler scheduler(console, access, lines_at_once);
+            const int count = scheduler.run(in, stop_on_error);
+            std::cout.rdbuf(previous);
+            if (failures != nullptr) *failures = count;
+            return printed.str();
+        }
+
+    private:
+        struct Running {
+            std::atomic<int>& counter;
+            explicit Running(std::atomic<int>& target) : counter(target) { counter++; }
+            ~Running() { counter--; }
+        };
+    };
+}
+
+TEST_F(SchedulerTest, ReadsSeeEarlierWrites) {
+    // The slow first write must still land before the read after it, the late write after that read
+    const std::string script = "set a 1 50\nget a\nset b 2\nget b\nset a 3\nget a\n";
+    for (const int threads : {1, 2, 4}) {
+        SCOPED_TRACE(threads);
+        values.clear();
+        EXPECT_EQ(run(script, threads), "a=1\nb=2\na=3\n");
+    }
+}
+
+TEST_F(SchedulerTest, OutputKeepsInputOrder) {
+    // Later lines on other names finish first, output still follows the script
+    std::string script = "set slow x 40\nget slow\n";
+    std::string expected = "slow=x\n";
+    for (int i = 0; i < 20; i++) {
+        script += "set v" + std::to_string(i) + " " + std::to_string(i) + "\nget v" + std::to_string(i) + "\n";
+        expected += "v" + std::to_string(i) + "=" + std::to_string(i) + "\n";
+    }
+    EXPECT_EQ(run(script, 4), expected);
+}
+
+TEST_F(SchedulerTest, IndependentLinesRunTogether) {
+    EXPECT_EQ(run("meet x\nmeet y\n", 2), "x met\ny met\n");
+}
+
+TEST_F(SchedulerTest, BarrierRunsAlone) {
+    std::string script;
+    for (int i = 0; i < 8; i++) {
+        script += "set v" + std::to_string(i) + " 1 5\nall\n";
+    }
+    run(script, 4);
+    EXPECT_FALSE(overlapped_barrier);
+}
+
+TEST_F(SchedulerTest, StopOnErrorCutsTheOutput) {
+    int failures = 0;
+    EXPECT_EQ(run("set a 1\nget a\nget missing\nget a\nset b 2\n", 4, true, &failures), "a=1\nmissing is not set\n");
+    EXPECT_EQ(failures, 1);
+}
+
+TEST_F(SchedulerTest, StopOnErrorNeverRunsALaterBarrier) {
+    // The barrier waits for the failing line, so it is cut before it can start, however many threads run
+    for (const int threads : {1, 4}) {
+        SCOPED_TRACE(threads);
+        barriers_run = 0;
+        EXPECT_EQ(run("set a 1 30\nget missing\nset b 2\nall\nget a\n", threads, true), "missing is not set\n");
+        EXPECT_EQ(barriers_run.load(), 0);
+    }
+}
+
+TEST_F(SchedulerTest, FailuresAreCountedWithoutStopping) {
+    int failures = 0;
+    EXPECT_EQ(run("get x\nset x 1\nget x\nget y\n", 2, false, &failures), "x is not set\nx=1\ny is not set\n");
+    EXPECT_EQ(failures, 2);
+}
+
+TEST_F(SchedulerTest, ExitStopsLaterLines) {
+    EXPECT_EQ(run("set a 1\nget a\nexit\nget a\n", 4), "a=1\n");
+}
+
+TEST_F(SchedulerTest, LongScriptsSpanWindows) {
+    std::string script;
+    std::string expected;
+    for (int i = 0; i < 2500; i++) {
+        script += "set v " + std::to_string(i) + "\nget v\n";
+        expected += "v=" + std::to_string(i) + "\n";
+    }
+    EXPECT_EQ(run(script, 4), expected);
+}
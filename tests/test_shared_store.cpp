@@ -0,0 +1,82 @@
+#include "backend/shared_store.h"
+#include "test_graphs.h"
+
+#include <fcntl.h>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <unistd.h>
+
+using namespace test_graphs;
+
+namespace {
+    std::string object_name(const std::string& suffix) {
+        return "/lab6_test_" + std::to_string(getpid()) + "_" + suffix;
+    }
+
+    // Removes the object when the test ends, also after a failed assertion
+    struct Published {
+        std::string name;
+        ~Published() { unpublish_graph(name); }
+    };
+}
+
+TEST(SharedStore, ObjectNamesStartWithSlash) {
+    EXPECT_EQ(shared_object_name("graph"), "/graph");
+    EXPECT_EQ(shared_object_name("/graph"), "/graph");
+}
+
+TEST(SharedStore, AttachedGraphEqualsPublishedOne) {
+    for (const unsigned int seed : SEEDS) {
+        for (const int n : {0, 1, 7, 64, 65, 300}) {
+            SCOPED_TRACE(testing::Message() << "seed " << seed << ", n " << n);
+            const SharedGraph graph = random_graph(n, seed);
+            const Published object{object_name("roundtrip")};
+            EXPECT_GT(publish_graph(*graph, object.name), 0u);
+
+            const SharedGraph attached = attach_graph(object.name);
+            EXPECT_TRUE(attached->read_only);
+            expect_same_graph(*graph, *attached);
+        }
+    }
+}
+
+TEST(SharedStore, NamesWithoutSlashAreTheSameObject) {
+    const SharedGraph graph = random_graph(20, SEEDS[0]);
+    const std::string name = object_name("plain").substr(1);
+    const Published object{name};
+    publish_graph(*graph, name);
+    expect_same_graph(*graph, *attach_graph("/" + name));
+}
+
+TEST(SharedStore, PublishingOverAnObjectFails) {
+    const SharedGraph first = random_graph(10, SEEDS[0]);
+    const SharedGraph second = random_graph(12, SEEDS[1]);
+    const Published object{object_name("twice")};
+    publish_graph(*first, object.name);
+    EXPECT_THROW(publish_graph(*second, object.name), std::runtime_error);
+    expect_same_graph(*first, *attach_graph(object.name));
+}
+
+TEST(SharedStore, AttachedGraphOutlivesUnpublish) {
+    const SharedGraph graph = random_graph(50, SEEDS[2]);
+    const std::string name = object_name("gone");
+    publish_graph(*graph, name);
+    const SharedGraph attached = attach_graph(name);
+
+    EXPECT_TRUE(unpublish_graph(name));
+    EXPECT_FALSE(unpublish_graph(name));
+    EXPECT_THROW(attach_graph(name), std::runtime_error);
+    expect_same_graph(*graph, *attached);
+}
+
+TEST(SharedStore, RefusesObjectsThatAreNotGraphs) {
+    const Published object{object_name("foreign")};
+    const int fd = shm_open(object.name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(ftruncate(fd, 4096), 0);
+    close(fd);
+
+    EXPECT_THROW(attach_graph(object.name), std::runtime_error);
+    EXPECT_THROW(attach_graph(object_name("missing")), std::runtime_error);
+}
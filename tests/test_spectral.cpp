@@ -0,0 +1,148 @@
+#include "backend/graph_spectral.h"
+#include "test_graphs.h"
+
+#include <cmath>
+#include <functional>
+#include <numeric>
+
+using namespace test_graphs;
+
+namespace {
+    // Every eigenvalue of the symmetric adjacency matrix by cyclic Jacobi rotations, descending
+    std::vector<double> reference_eigenvalues(const Graph &graph) {
+        const int n = graph.n;
+        std::vector a(n, std::vector<double>(n));
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < n; j++) a[i][j] = graph.adj_matrix[i][j];
+        }
+        for (int sweep = 0; sweep < 100; sweep++) {
+            double off = 0.0;
+            for (int p = 0; p < n; p++) {
+                for (int q = p + 1; q < n; q++) off += a[p][q] * a[p][q];
+            }
+            if (off < 1e-22) break;
+            for (int p = 0; p < n; p++) {
+                for (int q = p + 1; q < n; q++) {
+                    if (std::abs(a[p][q]) < 1e-300) continue;
+                    const double theta = (a[q][q] - a[p][p]) / (2.0 * a[p][q]);
+                    const double t = (theta >= 0 ? 1.0 : -1.0) / (std::abs(theta) + std::sqrt(theta * theta + 1.0));
+                    const double c = 1.0 / std::sqrt(t * t + 1.0);
+                    const double s = t * c;
+                    for (int k = 0; k < n; k++) {
+                        const double kp = a[k][p];
+                        const double kq = a[k][q];
+                        a[k][p] = c * kp - s * kq;
+                        a[k][q] = s * kp + c * kq;
+                    }
+                    for (int k = 0; k < n; k++) {
+                        const double pk = a[p][k];
+                        const double qk = a[q][k];
+                        a[p][k] = c * pk - s * qk;
+                        a[q][k] = s * pk + c * qk;
+                    }
+                }
+            }
+        }
+        std::vector<double> values(n);
+        for (int i = 0; i < n; i++) values[i] = a[i][i];
+        std::ranges::sort(values, std::greater<>());
+        return values;
+    }
+
+    // Same power iteration as the kernel, straight over the matrix
+    std::vector<double> reference_pagerank(const Graph &graph, const double damping) {
+        const int n = graph.n;
+        std::vector<double> score(n, 1.0 / n), next(n);
+        for (int iter = 0; iter < 500; iter++) {
+            double dangling = 0.0;
+            for (int i = 0; i < n; i++) {
+                if (graph.adj_list[i].empty()) dangling += score[i];
+            }
+            for (int i = 0; i < n; i++) {
+                double pulled = 0.0;
+                for (int j = 0; j < n; j++) {
+                    if (graph.adj_matrix[i][j]) pulled += score[j] / static_cast<double>(graph.adj_list[j].size());
+                }
+                next[i] = (1.0 - damping) / n + damping * dangling / n + damping * pulled;
+            }
+            score.swap(next);
+        }
+        return score;
+    }
+}
+
+TEST(Spectral, AdjacencyMultiplyMatchesMatrix) {
+    for (const unsigned int seed : SEEDS) {
+        // Sparse graphs go through CSR, dense ones read the matrix rows
+        for (const double density : {0.01, 0.5}) {
+            const SharedGraph g = random_graph(120, seed, density);
+            const CsrMatrix csr = to_csr(*g);
+            std::vector<double> x(g->n);
+            std::iota(x.begin(), x.end(), 1.0);
+            std::vector<double> y;
+            adjacency_multiply(*g, csr, x, y);
+            ASSERT_EQ(static_cast<int>(y.size()), g->n);
+            for (int i = 0; i < g->n; i++) {
+                double expected = 0.0;
+                for (int j = 0; j < g->n; j++) expected += g->adj_matrix[i][j] * x[j];
+                EXPECT_DOUBLE_EQ(y[i], expected) << "row " << i;
+            }
+        }
+    }
+}
+
+TEST(Spectral, SmallSpectrumIsExact) {
+    // Up to 40 vertices the Lanczos basis spans the whole space
+    for (const unsigned int seed : SEEDS) {
+        for (const double density : {0.05, 0.3}) {
+            const SharedGraph g = random_graph(30, seed, density, 0.2);
+            const auto expected = reference_eigenvalues(*g);
+            const auto values = adjacency_spectrum(*g, 5);
+            ASSERT_EQ(values.size(), 5u);
+            for (int k = 0; k < 5; k++) {
+                EXPECT_NEAR(values[k], expected[k], 1e-8) << "seed " << seed << ", density " << density << ", k " << k;
+            }
+        }
+    }
+}
+
+TEST(Spectral, LargestEigenvalueOfLargerGraphs) {
+    for (const unsigned int seed : SEEDS) {
+        const SharedGraph g = random_graph(150, seed, 0.2);
+        const auto values = adjacency_spectrum(*g, 1);
+        ASSERT_EQ(values.size(), 1u);
+        EXPECT_NEAR(values[0], reference_eigenvalues(*g)[0], 1e-6) << "seed " << seed;
+    }
+
+    // Complete graph K_n: n - 1 once, then -1
+    std::vector<std::pair<int, int>> edges;
+    for (int i = 0; i < 12; i++) {
+        for (int j = i + 1; j < 12; j++) edges.emplace_back(i, j);
+    }
+    const auto values = adjacency_spectrum(*graph_from_edges(12, edges), 2);
+    ASSERT_EQ(values.size(), 2u);
+    EXPECT_NEAR(values[0], 11.0, 1e-9);
+    EXPECT_NEAR(values[1], -1.0, 1e-9);
+}
+
+TEST(Spectral, PageRankMatchesPowerIteration) {
+    for (const unsigned int seed : SEEDS) {
+        for (const double density : {0.01, 0.3}) {
+            const SharedGraph g = random_graph(90, seed, density);
+            const PageRankResult result = pagerank(*g, 0.85, 500, 1e-13);
+            const auto expected = reference_pagerank(*g, 0.85);
+            ASSERT_EQ(result.score.size(), expected.size());
+            EXPECT_NEAR(std::accumulate(result.score.begin(), result.score.end(), 0.0), 1.0, 1e-9);
+            for (int i = 0; i < g->n; i++) {
+                EXPECT_NEAR(result.score[i], expected[i], 1e-9) << "seed " << seed << ", vertex " << i;
+            }
+            EXPECT_LT(result.residual, 1e-13);
+        }
+    }
+}
+
+TEST(Spectral, EmptyGraph) {
+    const SharedGraph empty = random_graph(0, SEEDS[0]);
+    EXPECT_TRUE(adjacency_spectrum(*empty, 3).empty());
+    EXPECT_TRUE(pagerank(*empty).score.empty());
+}
@@ -0,0 +1,188 @@
+#include "backend/parallel.h"
+#include "core/profiler.h"
+#include "core/trace.h"
+#include "test_graphs.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+using namespace test_graphs;
+
+namespace {
+    // Tracing on for one test, off again afterwards
+    class TraceTest : public testing::Test {
+    protected:
+        void SetUp() override { tracing::start(); }
+        void TearDown() override { tracing::stop(); }
+    };
+
+    /**
+     * Structural JSON check: strings, escapes, balanced brackets, nothing after the top-level value
+     * Enough to catch an unbalanced bracket or an unescaped quote in a name
+     */
+    bool well_formed_json(const std::string& text) {
+        std::string stack;
+        bool in_string = false;
+        bool closed = false;
+        for (size_t i = 0; i < text.size(); i++) {
+            const char c = text[i];
+            if (in_string) {
+                if (c == '\\') i++;
+                else if (c == '"') in_string = false;
+                else if (static_cast<unsigned char>(c) < 0x20) return false;
+                continue;
+            }
+            if (closed && c != '\n' && c != ' ') return false;
+            if (c == '"') in_string = true;
+            else if (c == '{' || c == '[') stack.push_back(c);
+            else if (c == '}' || c == ']') {
+                if (stack.empty() || stack.back() != (c == '}' ? '{' : '[')) return false;
+                stack.pop_back();
+                closed = stack.empty();
+            }
+        }
+        return !in_string && stack.empty() && closed;
+    }
+
+    size_t count_of(const std::string& text, const std::string& part) {
+        size_t count = 0;
+        for (size_t at = text.find(part); at != std::string::npos; at = text.find(part, at + 1)) count++;
+        return count;
+    }
+}
+
+TEST_F(TraceTest, SpansAndScopesBecomeCompleteEvents) {
+    ProfileSite& site = profile_site("test", "traced scope");
+    {
+        ProfileScope scope(site);
+        TraceSpan span("inner span", "test", 3, 9);
+    }
+
+    std::ostringstream out;
+    const std::uint64_t written = tracing::write_chrome_trace(out);
+    const std::string json = out.str();
+    EXPECT_TRUE(well_formed_json(json)) << json;
+    EXPECT_EQ(written, 2u);
+    EXPECT_EQ(count_of(json, "\"ph\": \"X\""), written);
+    EXPECT_NE(json.find("\"traced scope\""), std::string::npos);
+    EXPECT_NE(json.find(R"("rows": "3..9")"), std::string::npos);
+    EXPECT_EQ(tracing::totals().events, 2u);
+}
+
+TEST_F(TraceTest, KernelsAndWorkerTasksAreTraced) {
+    const SharedGraph a = random_graph(300, SEEDS[0]);
+    const SharedGraph b = random_graph(200, SEEDS[1]);
+    const SharedGraph both = make_shared_graph(graph_union(*a, *b));
+
+    std::ostringstream out;
+    const std::uint64_t written = tracing::write_chrome_trace(out);
+    const std::string json = out.str();
+    EXPECT_TRUE(well_formed_json(json));
+    EXPECT_EQ(count_of(json, "\"ph\": \"X\""), written);
+    EXPECT_NE(json.find("\"graph_union\""), std::string::npos);
+    // Row ranges of parallel_for, inline or on workers, are tasks named after the enclosing scope
+    EXPECT_NE(json.find(R"("cat": "task")"), std::string::npos);
+    EXPECT_EQ(count_of(json, "\"thread_name\""), static_cast<size_t>(tracing::totals().threads));
+}
+
+TEST_F(TraceTest, ThreadLabelsAreEscaped) {
+    std::thread([] {
+        tracing::name_thread("quote \" back\\slash \t tab");
+        TraceSpan span("labelled", "test");
+    }).join();
+
+    std::ostringstream out;
+    tracing::write_chrome_trace(out);
+    EXPECT_TRUE(well_formed_json(out.str())) << out.str();
+    EXPECT_NE(out.str().find(R"(quote \" back\\slash   tab)"), std::string::npos);
+}
+
+TEST(TraceThreads, NamingWithoutTracingTakesNoBuffer) {
+    tracing::stop();
+    const size_t before = tracing::registry().buffers.size();
+    std::thread([] {
+        tracing::name_thread("untraced");
+        TraceSpan span("ignored", "test");
+    }).join();
+    EXPECT_EQ(tracing::registry().buffers.size(), before);
+}
+
+TEST_F(TraceTest, ExitedThreadsHandTheirBuffersOn) {
+    // Warms up one idle buffer, then every later thread should reuse it
+    std::thread([] { TraceSpan span("first", "test"); }).join();
+    const size_t before = tracing::registry().buffers.size();
+    for (int t = 0; t < 20; t++) {
+        std::thread([t] {
+            tracing::name_thread("short " + std::to_string(t));
+            TraceSpan span("short-lived", "test");
+        }).join();
+    }
+    EXPECT_EQ(tracing::registry().buffers.size(), before);
+
+    // Events of the exited threads stay in the session
+    std::ostringstream out;
+    tracing::write_chrome_trace(out);
+    EXPECT_TRUE(well_formed_json(out.str()));
+    EXPECT_EQ(count_of(out.str(), "\"short-lived\""), 20u);
+}
+
+TEST_F(TraceTest, NewSessionDropsOldEvents) {
+    {
+        TraceSpan span("old", "test");
+    }
+    tracing::start();
+    {
+        TraceSpan span("new", "test");
+    }
+
+    std::ostringstream out;
+    EXPECT_EQ(tracing::write_chrome_trace(out), 1u);
+    EXPECT_EQ(out.str().find("\"old\""), std::string::npos);
+    EXPECT_NE(out.str().find("\"new\""), std::string::npos);
+}
+
+TEST_F(TraceTest, FullBufferCountsDroppedEvents) {
+    std::thread([] {
+        const std::uint64_t start = tracing::now_ns();
+        for (std::size_t i = 0; i < tracing::BUFFER_EVENTS + 10; i++) {
+            tracing::record("flood", "test", start, start + 1);
+        }
+    }).join();
+
+    const auto totals = tracing::totals();
+    EXPECT_GE(totals.events, tracing::BUFFER_EVENTS);
+    EXPECT_EQ(totals.dropped, 10u);
+}
+
+TEST_F(TraceTest, StoppedTracingRecordsNothing) {
+    tracing::stop();
+    tracing::start();
+    tracing::stop();
+    {
+        TraceSpan span("ignored", "test");
+        ProfileScope scope(profile_site("test", "ignored scope"));
+    }
+    EXPECT_EQ(tracing::totals().events, 0u);
+}
+
+TEST_F(TraceTest, SaveWritesTheFileAndStops) {
+    {
+        TraceSpan span("saved", "test");
+    }
+    const std::string path = testing::TempDir() + "lab6_trace.json";
+    std::uint64_t events = 0;
+    ASSERT_TRUE(tracing::save(path, events));
+    EXPECT_FALSE(tracing::enabled.load());
+    EXPECT_EQ(events, 1u);
+
+    std::ifstream file(path);
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    EXPECT_TRUE(well_formed_json(contents.str()));
+    std::remove(path.c_str());
+
+    EXPECT_FALSE(tracing::save("/nonexistent-directory/trace.json", events));
+}
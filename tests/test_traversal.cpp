@@ -0,0 +1,131 @@
+#include "backend/graph_traversal.h"
+#include "test_graphs.h"
+
+#include <queue>
+
+using namespace test_graphs;
+
+namespace {
+    // Plain queue BFS over the matrix
+    std::vector<int> reference_distances(const Graph &graph, const int source) {
+        std::vector<int> dist(graph.n, -1);
+        std::queue<int> queue;
+        dist[source] = 0;
+        queue.push(source);
+        while (!queue.empty()) {
+            const int u = queue.front();
+            queue.pop();
+            for (int v = 0; v < graph.n; v++) {
+                if (graph.adj_matrix[u][v] && dist[v] == -1) {
+                    dist[v] = dist[u] + 1;
+                    queue.push(v);
+                }
+            }
+        }
+        return dist;
+    }
+
+    // Components numbered in order of their smallest vertex
+    std::vector<int> reference_components(const Graph &graph) {
+        std::vector<int> label(graph.n, -1);
+        int count = 0;
+        for (int v = 0; v < graph.n; v++) {
+            if (label[v] != -1) continue;
+            const auto dist = reference_distances(graph, v);
+            for (int u = 0; u < graph.n; u++) {
+                if (dist[u] != -1) label[u] = count;
+            }
+            count++;
+        }
+        return label;
+    }
+
+    void expect_valid_bfs(const Graph &graph, const BfsResult &result, const int source) {
+        EXPECT_EQ(result.source, source);
+        EXPECT_EQ(result.dist, reference_distances(graph, source));
+        for (int v = 0; v < graph.n; v++) {
+            if (v == source || result.dist[v] == -1) {
+                EXPECT_EQ(result.parent[v], -1) << "vertex " << v;
+                continue;
+            }
+            // Any shortest-path parent will do
+            const int p = result.parent[v];
+            ASSERT_GE(p, 0);
+            EXPECT_EQ(graph.adj_matrix[p][v], 1);
+            EXPECT_EQ(result.dist[p], result.dist[v] - 1);
+        }
+    }
+
+    // Sparse graphs take the list walk, dense ones the bitset frontiers
+    const std::vector<double> DENSITIES{0.01, 0.3};
+}
+
+TEST(Traversal, BfsMatchesReference) {
+    for (const unsigned int seed : SEEDS) {
+        for (const double density : DENSITIES) {
+            for (const int n : {1, 2, 63, 64, 65, 300}) {
+                const SharedGraph g = random_graph(n, seed, density);
+                for (const int source : {0, n / 2, n - 1}) {
+                    SCOPED_TRACE(testing::Message() << "seed " << seed << ", density " << density << ", n " << n);
+                    expect_valid_bfs(*g, bfs(*g, source), source);
+                }
+            }
+        }
+    }
+}
+
+TEST(Traversal, BfsRejectsInvalidSource) {
+    const SharedGraph g = random_graph(10, SEEDS[0]);
+    EXPECT_TRUE(bfs(*g, -1).dist.empty());
+    EXPECT_TRUE(bfs(*g, 10).dist.empty());
+
+    const SharedGraph empty = random_graph(0, SEEDS[0]);
+    EXPECT_TRUE(bfs(*empty, 0).dist.empty());
+    EXPECT_EQ(connected_components(*empty).count, 0);
+}
+
+TEST(Traversal, ComponentsMatchReference) {
+    for (const unsigned int seed : SEEDS) {
+        for (const double density : DENSITIES) {
+            for (const int n : {1, 17, 64, 200}) {
+                const SharedGraph g = random_graph(n, seed, density);
+                const auto expected = reference_components(*g);
+                const ComponentsResult result = connected_components(*g);
+                EXPECT_EQ(result.label, expected) << "seed " << seed << ", density " << density << ", n " << n;
+                EXPECT_EQ(result.count, expected.empty() ? 0 : *std::ranges::max_element(expected) + 1);
+            }
+        }
+    }
+}
+
+TEST(Traversal, DistanceOnPath) {
+    // 0 - 1 - 2 - 3, 4 alone with a self-loop
+    const SharedGraph g = graph_from_edges(5, {{0, 1}, {1, 2}, {2, 3}, {4, 4}});
+    EXPECT_EQ(vertex_distance(*g, 0, 3), 3);
+    EXPECT_EQ(vertex_distance(*g, 3, 0), 3);
+    EXPECT_EQ(vertex_distance(*g, 2, 2), 0);
+    EXPECT_EQ(vertex_distance(*g, 0, 4), -1);
+    EXPECT_EQ(vertex_distance(*g, 0, 5), -1);
+    EXPECT_EQ(connected_components(*g).count, 2);
+}
+
+TEST(Traversal, CachePatchedByEditsMatchesRecomputation) {
+    for (const unsigned int seed : SEEDS) {
+        Graph g = create_graph(60, 0.02, 0.1, seed);
+        ConnectivityCache cache;
+        cache.components = connected_components(g);
+        cache.components_valid = true;
+
+        identify_vertices(g, 7, 41);
+        on_vertices_merged(cache, 7, 41);
+        EXPECT_EQ(cache.components.label, connected_components(g).label) << "seed " << seed;
+        EXPECT_EQ(cache.components.count, connected_components(g).count);
+
+        split_vertex(g, 3, get_neighbors(g, 3));
+        on_vertex_split(cache, 3);
+        // The new vertex is the last one and joins vertex 3, so no label moves
+        EXPECT_EQ(cache.components.label, connected_components(g).label);
+        EXPECT_EQ(cache.components.count, connected_components(g).count);
+        delete_graph(g, g.n);
+    }
+}
@@ -0,0 +1,78 @@
+#include "backend/graph_triangles.h"
+#include "test_graphs.h"
+
+using namespace test_graphs;
+
+namespace {
+    // Triple loop over the matrix, self-loops ignored
+    TriangleResult reference_triangles(const Graph &graph) {
+        TriangleResult result;
+        const int n = graph.n;
+        result.per_vertex.assign(n, 0);
+        result.clustering.assign(n, 0.0);
+        for (int a = 0; a < n; a++) {
+            for (int b = a + 1; b < n; b++) {
+                if (!graph.adj_matrix[a][b]) continue;
+                for (int c = b + 1; c < n; c++) {
+                    if (graph.adj_matrix[a][c] && graph.adj_matrix[b][c]) {
+                        result.total++;
+                        result.per_vertex[a]++;
+                        result.per_vertex[b]++;
+                        result.per_vertex[c]++;
+                    }
+                }
+            }
+        }
+
+        long long triples = 0;
+        double clustering_sum = 0.0;
+        for (int v = 0; v < n; v++) {
+            long long degree = 0;
+            for (int u = 0; u < n; u++) {
+                if (u != v && graph.adj_matrix[v][u]) degree++;
+            }
+            const long long pairs = degree * (degree - 1) / 2;
+            triples += pairs;
+            if (pairs > 0) result.clustering[v] = static_cast<double>(result.per_vertex[v]) / static_cast<double>(pairs);
+            clustering_sum += result.clustering[v];
+        }
+        result.average_clustering = n > 0 ? clustering_sum / n : 0.0;
+        result.transitivity = triples > 0 ? 3.0 * static_cast<double>(result.total) / static_cast<double>(triples) : 0.0;
+        return result;
+    }
+}
+
+TEST(Triangles, MatchReference) {
+    for (const unsigned int seed : SEEDS) {
+        // Sparse graphs intersect lists, dense ones popcount bitset rows
+        for (const double density : {0.02, 0.1, 0.5, 0.9}) {
+            for (const int n : {3, 64, 65, 150}) {
+                SCOPED_TRACE(testing::Message() << "seed " << seed << ", density " << density << ", n " << n);
+                const SharedGraph g = random_graph(n, seed, density, 0.3);
+                const TriangleResult expected = reference_triangles(*g);
+                const TriangleResult result = count_triangles(*g);
+                EXPECT_EQ(result.total, expected.total);
+                EXPECT_EQ(result.per_vertex, expected.per_vertex);
+                for (int v = 0; v < n; v++) {
+                    EXPECT_DOUBLE_EQ(result.clustering[v], expected.clustering[v]) << "vertex " << v;
+                }
+                EXPECT_NEAR(result.average_clustering, expected.average_clustering, 1e-12);
+                EXPECT_NEAR(result.transitivity, expected.transitivity, 1e-12);
+            }
+        }
+    }
+}
+
+TEST(Triangles, SmallGraphs) {
+    // Two triangles sharing the edge 1 - 2, a self-loop on 0 that must not count
+    const SharedGraph g = graph_from_edges(4, {{0, 1}, {0, 2}, {1, 2}, {1, 3}, {2, 3}, {0, 0}});
+    const TriangleResult result = count_triangles(*g);
+    EXPECT_EQ(result.total, 2);
+    EXPECT_EQ(result.per_vertex, (std::vector<long long>{1, 2, 2, 1}));
+    EXPECT_DOUBLE_EQ(result.clustering[0], 1.0);
+    EXPECT_DOUBLE_EQ(result.clustering[1], 2.0 / 3.0);
+
+    const SharedGraph empty = random_graph(0, SEEDS[0]);
+    EXPECT_EQ(count_triangles(*empty).total, 0);
+    EXPECT_TRUE(count_triangles(*empty).per_vertex.empty());
+}
@@ -0,0 +1,88 @@
+#include "backend/workspace.h"
+#include "test_graphs.h"
+
+using namespace test_graphs;
+
+TEST(Workspace, SlotsByName) {
+    Workspace workspace;
+    EXPECT_FALSE(workspace.contains("A"));
+    EXPECT_EQ(workspace.get("A"), nullptr);
+    EXPECT_EQ(workspace.operand("A"), nullptr);
+
+    const SharedGraph a = random_graph(20, SEEDS[0]);
+    workspace.put("B", random_graph(10, SEEDS[1]));
+    workspace.put("A", a);
+    EXPECT_EQ(workspace.names(), (std::vector<std::string>{"A", "B"}));
+    EXPECT_EQ(workspace.get("A"), a.get());
+    EXPECT_EQ(workspace.bytes("A"), graph_bytes(*a));
+
+    EXPECT_TRUE(workspace.erase("B"));
+    EXPECT_FALSE(workspace.erase("B"));
+    workspace.clear();
+    EXPECT_TRUE(workspace.names().empty());
+}
+
+TEST(Workspace, WritesCopySharedGraphs) {
+    Workspace workspace;
+    const SharedGraph original = random_graph(30, SEEDS[0]);
+    const SharedGraph reference = make_shared_graph(copy_graph(*original));
+    workspace.put("A", original);
+    workspace.put("B", original);
+    EXPECT_EQ(workspace.total_bytes(), graph_bytes(*original));
+
+    // Held by both slots and this test: the writer gets a private copy
+    Graph *target = workspace.get_for_write("A");
+    ASSERT_NE(target, original.get());
+    identify_vertices(*target, 0, 1);
+    expect_same_graph(*reference, *original);
+    EXPECT_EQ(workspace.get("B"), original.get());
+    EXPECT_EQ(workspace.get("A")->n, 29);
+
+    // Sole owner now, edits stay in place
+    EXPECT_EQ(workspace.get_for_write("A"), target);
+}
+
+TEST(Workspace, ReadOnlyGraphsAreCopiedBeforeWrites) {
+    Workspace workspace;
+    SharedGraph mapped = random_graph(16, SEEDS[0]);
+    mapped->read_only = true;
+    const Graph *view = mapped.get();
+    workspace.put("A", std::move(mapped));
+    Graph *target = workspace.get_for_write("A");
+    EXPECT_NE(target, view);
+    EXPECT_FALSE(target->read_only);
+}
+
+TEST(Workspace, PendingSlotsEvaluateOnRead) {
+    Workspace workspace;
+    const SharedGraph a = random_graph(25, SEEDS[0]);
+    const SharedGraph b = random_graph(35, SEEDS[1]);
+    workspace.put("A", a);
+    workspace.put("B", b);
+    workspace.put_pending("C", expr_binary(GraphOp::Union, workspace.operand("A"), workspace.operand("B")));
+    EXPECT_TRUE(workspace.is_pending("C"));
+    EXPECT_EQ(workspace.bytes("C"), 0u);
+
+    // The expression holds snapshots: replacing an operand afterwards does not change C
+    workspace.put("A", random_graph(5, SEEDS[2]));
+    const SharedGraph expected = make_shared_graph(graph_union(*a, *b));
+    const Graph *c = workspace.get("C");
+    ASSERT_NE(c, nullptr);
+    EXPECT_FALSE(workspace.is_pending("C"));
+    expect_same_graph(*expected, *c);
+}
+
+TEST(Workspace, ReplacingAGraphResetsItsCacheAndLabels) {
+    Workspace workspace;
+    workspace.put("A", random_graph(10, SEEDS[0]));
+    ConnectivityCache *cache = workspace.cache("A");
+    cache->components = connected_components(*workspace.get("A"));
+    cache->components_valid = true;
+    workspace.labels("A")->assign({2, 0, 1});
+
+    workspace.put("A", random_graph(12, SEEDS[1]));
+    EXPECT_FALSE(workspace.cache("A")->components_valid);
+    EXPECT_TRUE(workspace.labels("A")->empty());
+    EXPECT_EQ(workspace.cache("missing"), nullptr);
+    EXPECT_EQ(workspace.labels("missing"), nullptr);
+}